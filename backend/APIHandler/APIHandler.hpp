@@ -13,14 +13,28 @@
 #include "../crow/middlewares/cors.h"
 #include "../algorithms/MLQ_Aging.hpp"
 #include "../algorithms/SJF_Aging.hpp"
+#include "../algorithms/AlgorithmRegistry.hpp"
+#include "../algorithms/Dispatch.hpp"
+#include "../trace/ColumnarTrace.hpp"
+#include "../workload/TimeType.hpp"
+#include "ContentNegotiation.hpp"
+#include "LocalTransport.hpp"
+#include "ScheduleResponder.hpp"
+#include "ScheduleStream.hpp"
+#include "Sessions.hpp"
+#include "Runs.hpp"
 #include <vector>
 #include <string>
+#include <sstream>
 
 using json = nlohmann::json;
 
 class APIHandler {
+public:
+    using App = crow::App<crow::CORSHandler>;
+
 private:
-	crow::App<crow::CORSHandler> app;
+	App app;
 
 public:
     APIHandler() {
@@ -28,7 +42,7 @@ public:
         cors
             .global()
                 .origin("*")
-                .methods("POST"_method, "GET"_method, "OPTIONS"_method)
+                .methods("POST"_method, "GET"_method, "PATCH"_method, "DELETE"_method, "OPTIONS"_method)
                 .headers("Content-Type", "Authorization")
                 .allow_credentials();
                 
@@ -38,13 +52,13 @@ public:
     // Initialize and set up all routes
     void setupRoutes() {
         // Root endpoint
-        CROW_ROUTE(app, "/")([](){
-            return APIHandler::handleRoot();
+        CROW_ROUTE(app, "/")([](const crow::request& req){
+            return APIHandler::handleRoot(req);
         });
 
         // Test endpoint
-        CROW_ROUTE(app, "/test")([](){
-            return APIHandler::handleTest();
+        CROW_ROUTE(app, "/test")([](const crow::request& req){
+            return APIHandler::handleTest(req);
         });
 
         // POST endpoint to receive scheduling data and return results
@@ -74,6 +88,63 @@ public:
         ([](const crow::request& req) {
             return APIHandler::handleSJF_AgingSchedule(req);
         });
+
+        // Same body as /api/schedule (any algorithm); answers with a columnar .ctrace file
+        CROW_ROUTE(app, "/api/trace")
+        .methods("POST"_method)
+        ([](const crow::request& req) {
+            return APIHandler::handleTraceDownload(req);
+        });
+
+        // Workloads kept on the server and edited with deltas; see Sessions.hpp
+        CROW_ROUTE(app, "/api/sessions")
+        .methods("POST"_method)
+        ([](const crow::request& req) {
+            return Sessions::create(req);
+        });
+
+        CROW_ROUTE(app, "/api/sessions/<string>")
+        .methods("GET"_method, "PATCH"_method, "DELETE"_method)
+        ([](const crow::request& req, const std::string& id) {
+            return Sessions::handle(req, id);
+        });
+
+        // Retained schedules whose Gantt chart can be read a time window at a time; see Runs.hpp
+        CROW_ROUTE(app, "/api/runs")
+        .methods("POST"_method)
+        ([](const crow::request& req) {
+            return Runs::create(req);
+        });
+
+        CROW_ROUTE(app, "/api/runs/<string>")
+        .methods("GET"_method, "DELETE"_method)
+        ([](const crow::request& req, const std::string& id) {
+            return Runs::handle(req, id);
+        });
+
+        CROW_ROUTE(app, "/api/runs/<string>/gantt")
+        .methods("GET"_method)
+        ([](const crow::request& req, const std::string& id) {
+            return Runs::gantt(req, id);
+        });
+
+        CROW_ROUTE(app, "/api/runs/<string>/lod")
+        .methods("GET"_method)
+        ([](const crow::request& req, const std::string& id) {
+            return Runs::lod(req, id);
+        });
+
+        // Streams the schedule in batches while the engine runs; protocol in ScheduleStream.hpp
+        CROW_WEBSOCKET_ROUTE(app, "/ws/schedule")
+        .onopen([](crow::websocket::connection& conn) {
+            ScheduleStream::open(conn);
+        })
+        .onmessage([](crow::websocket::connection& conn, const std::string& data, bool is_binary) {
+            ScheduleStream::message(conn, data, is_binary);
+        })
+        .onclose([](crow::websocket::connection& conn, const std::string& reason, uint16_t) {
+            ScheduleStream::close(conn);
+        });
 	}
     
     // Start the server
@@ -84,326 +155,242 @@ public:
             app.port(port).run();
         }
     }
+
+    // Start the server on port and on the Unix domain socket of local as well (LocalTransport.hpp)
+    void run(int port, const LocalTransportOptions& local) {
+        std::future<void> server = app.port(port).multithreaded().run_async();
+        app.wait_for_server_start();
+        std::unique_ptr<LocalTransport<App>> transport = startLocal(local);
+        server.wait();
+    }
+
+    // Start the server as one shard of a ShardedServer: an SO_REUSEPORT acceptor on port and a
+    // single worker thread, which inherit the CPU the calling thread is pinned to
+    void runShard(int port) {
+        app.port(port).concurrency(2).reuse_port().run();
+    }
+
+    void waitForStart() {
+        app.wait_for_server_start();
+    }
+
+    // Serve the routes on the Unix domain socket of local too, until the transport is destroyed.
+    // The server must have started.
+    std::unique_ptr<LocalTransport<App>> startLocal(const LocalTransportOptions& local) {
+        auto transport = std::make_unique<LocalTransport<App>>(app, local);
+        transport->start();
+        return transport;
+    }
+
+    // Start the server on a background thread and return once it accepts connections
+    std::future<void> runAsync(int port = 18080) {
+        std::future<void> server = app.port(port).multithreaded().run_async();
+        app.wait_for_server_start();
+        return server;
+    }
+
+    void stop() {
+        app.stop();
+    }
     
     // Route handler methods
-    static crow::response handleRoot() {
+    static crow::response handleRoot(const crow::request& req) {
         json response_json = {
             {"status", "success"},
             {"message", "CPU Scheduling Algorithm Visualiser API"}
         };
-        return crow::response(response_json.dump());
+        return ContentNegotiation::respond(req, 200, response_json);
     }
     
-    static crow::response handleTest() {
+    static crow::response handleTest(const crow::request& req) {
         json response_json = {
             {"status", "success"},
             {"message", "Test endpoint working"}
         };
-        return crow::response(response_json.dump());
+        return ContentNegotiation::respond(req, 200, response_json);
     }
     
     static crow::response handleSchedule(const crow::request& req) {
         try {
-            // Parse JSON from request body
-            auto req_body = crow::json::load(req.body);
-            if (!req_body) {
+            // Parse the request body (JSON, CBOR or MessagePack)
+            json input_json = ContentNegotiation::decode(req);
+            if (input_json.is_discarded()) {
                 json error_json = {
                     {"status", "error"},
                     {"message", "Invalid JSON data"}
                 };
-                return crow::response(400, error_json.dump());
-            }
-
-            // Convert from crow::json to nlohmann::json
-            json input_json = json::parse(req.body);
-            
-            // Extract processes
-            std::vector<Process> processes;
-            for (const auto& process : input_json["processes"]) {
-                Process p;
-                // Ensure p_id is handled as an integer
-                if (process["p_id"].is_number()) {
-                    p.p_id = process["p_id"].get<int>();
-                } else if (process["p_id"].is_string()) {
-                    // Handle string conversion to integer if necessary
-                    try {
-                        p.p_id = std::stoi(process["p_id"].get<std::string>());
-                    } catch (const std::exception& e) {
-                        json error_json = {
-                            {"status", "error"},
-                            {"message", "Invalid process ID format: must be convertible to integer"}
-                        };
-                        return crow::response(400, error_json.dump());
-                    }
-                } else {
-                    json error_json = {
-                        {"status", "error"},
-                        {"message", "Process ID must be a number or string convertible to number"}
-                    };
-                    return crow::response(400, error_json.dump());
-                }
-                
-                p.arrival_time = process["arrival_time"];
-                p.burst_time = process["burst_time"];
-                p.priority = process.value("priority", 0);  // Default priority to 0 if not provided
-                processes.push_back(p);
+                return ContentNegotiation::respond(req, 400, error_json);
             }
 
             // Get scheduling algorithm type
             std::string algorithm = input_json["scheduling_type"];
-
-            // Run appropriate algorithm
-            json result;
-            if (algorithm == "FCFS") {
-                FCFS fcfs;
-                result = fcfs.schedule(processes);
-            } else if (algorithm == "SJF") {
-                SJF sjf;
-                result = sjf.schedule(processes);
-            } else if (algorithm == "RR") {
-                int quantum = input_json.value("quantum", 1);  // Default quantum to 1 if not provided
-                RR rr;
-                result = rr.schedule(processes,quantum);
-            } else if (algorithm == "Priority") {
-                Priority priority;
-                result = priority.schedule(processes);
-            } else if (algorithm == "MLQ") {
-				int num_queues = input_json.value("num_queues", 3);  // Default to 3 queues if not provided
-				int base_quantum = input_json.value("quantum", 2);   // Default base quantum to 2 if not provided
-				MLQ mlq;
-				result = mlq.schedule(processes, num_queues, base_quantum);
-            } else {
-                json error_json = {
-                    {"status", "error"},
-                    {"message", "Unsupported scheduling algorithm"}
-                };
-                return crow::response(400, error_json.dump());
-            }
-
-            // Ensure the result has the correct status
-            result["status"] = "success";
-            
-            // Return the result as JSON
-            return crow::response(result.dump());
+            return respondAlgorithm(req, algorithm, input_json);
         } catch (const std::exception& e) {
             json error_json = {
                 {"status", "error"},
                 {"message", std::string("Server error: ") + e.what()}
             };
-            return crow::response(500, error_json.dump());
+            return ContentNegotiation::respond(req, 500, error_json);
         }
     }
 
+    // The per-algorithm routes predate /api/schedule taking every algorithm. Each ignores the
+    // body's scheduling_type and reads the queue count only under the spelling it always has.
 	static crow::response handleMLQSchedule(const crow::request& req) {
-		try {
-			auto input_json = json::parse(req.body);
-			
-			// Validate input
-			if (!input_json.contains("processes")) {
-				return crow::response(400, "{\"status\": \"error\", \"message\": \"Missing processes field\"}");
-			}
-			
-			// Parse processes
-			vector<Process> processes;
-			for (const auto& p : input_json["processes"]) {
-				Process process;
-                
-                // Ensure p_id is handled as an integer
-                if (p["p_id"].is_number()) {
-                    process.p_id = p["p_id"].get<int>();
-                } else if (p["p_id"].is_string()) {
-                    // Handle string conversion to integer if necessary
-                    try {
-                        process.p_id = std::stoi(p["p_id"].get<std::string>());
-                    } catch (const std::exception& e) {
-                        json error_json = {
-                            {"status", "error"},
-                            {"message", "Invalid process ID format in MLQ request: must be convertible to integer"}
-                        };
-                        return crow::response(400, error_json.dump());
-                    }
-                } else {
-                    json error_json = {
-                        {"status", "error"},
-                        {"message", "Process ID in MLQ request must be a number or string convertible to number"}
-                    };
-                    return crow::response(400, error_json.dump());
-                }
-				
-				process.arrival_time = p["arrival_time"];
-				process.burst_time = p["burst_time"];
-				
-				// Priority is important for MLQ
-				if (p.contains("priority")) {
-					process.priority = p["priority"];
-				} else {
-					process.priority = 0;
-				}
-				
-				processes.push_back(process);
-			}
-			
-			// Get MLQ specific parameters
-			int num_queues = input_json.value("num_of_queues", 3);  // Default to 3 queues if not provided
-			int base_quantum = input_json.value("quantum", 2);   // Default base quantum to 2 if not provided
-			
-			// Run MLQ algorithm
-			MLQ mlq;
-			json result = mlq.schedule(processes, num_queues, base_quantum);
-			
-			// Ensure the result has the correct status
-			result["status"] = "success";
-			
-			return crow::response(200, result.dump());
-		} catch (const std::exception& e) {
-			json error_json = {
-				{"status", "error"},
-				{"message", std::string("Error processing MLQ request: ") + e.what()}
-			};
-			return crow::response(500, error_json.dump());
-		}
+		return handleAlgorithmRoute(req, "MLQ", "num_queues", "MLQ");
 	}
 
     static crow::response handleMLFQSchedule(const crow::request& req) {
+        return handleAlgorithmRoute(req, "MLFQ", "num_of_queues", "MLFQ");
+    }
+
+    static crow::response handleMLQAgingSchedule(const crow::request& req) {
+        return handleAlgorithmRoute(req, "MLQ_Aging", "num_of_queues", "MLQ");
+    }
+
+    static crow::response handleSJF_AgingSchedule(const crow::request& req) {
+        return handleAlgorithmRoute(req, "SJF_Aging", "", "SJF");
+    }
+
+    static crow::response handleAlgorithmRoute(const crow::request& req, const std::string& algorithm,
+                                               const std::string& ignored_key, const std::string& label) {
         try {
-            auto input_json = json::parse(req.body);
-            
+            json input_json = ContentNegotiation::decode(req);
+            if (input_json.is_discarded()) {
+                return ContentNegotiation::respond(req, 400, {{"status", "error"}, {"message", "Invalid JSON data"}});
+            }
+
             // Validate input
             if (!input_json.contains("processes")) {
-                return crow::response(400, "{\"status\": \"error\", \"message\": \"Missing processes field\"}");
+                return ContentNegotiation::respond(req, 400, {{"status", "error"}, {"message", "Missing processes field"}});
             }
-            
-            // Parse processes
-            vector<Process> processes;
-            for (const auto& p : input_json["processes"]) {
-                Process process;
-                process.p_id = p["p_id"];
-                process.arrival_time = p["arrival_time"];
-                process.burst_time = p["burst_time"];
-                
-                // Priority is important for MLFQ
-                if (p.contains("priority")) {
-                    process.priority = p["priority"];
-                } else {
-                    process.priority = 0;
-                }
-                
-                processes.push_back(process);
+            if (!ignored_key.empty()) {
+                input_json.erase(ignored_key);
             }
-            
-            // Get MLFQ specific parameters
-            int num_queues = input_json.value("num_queues", 3);  // Default to 3 queues if not provided
-            int base_quantum = input_json.value("quantum", 2);   // Default base quantum to 2 if not provided
-            
-            // Run MLFQ algorithm
-            MLFQ mlfq(base_quantum, num_queues);
-            json result = mlfq.schedule(processes);
-            
-            // Ensure the result has the correct status
-            result["status"] = "success";
-            
-            return crow::response(200, result.dump());
+            return respondAlgorithm(req, algorithm, input_json);
         } catch (const std::exception& e) {
             json error_json = {
                 {"status", "error"},
-                {"message", std::string("Error processing MLFQ request: ") + e.what()}
+                {"message", "Error processing " + label + " request: " + e.what()}
             };
-            return crow::response(500, error_json.dump());
+            return ContentNegotiation::respond(req, 500, error_json);
         }
     }
 
-    static crow::response handleMLQAgingSchedule(const crow::request& req) {
+    // Schedules the processes of a decoded body with algorithm, whose parameters are read from the
+    // body through its AlgorithmRegistry schema. The times are simulated in the body's "time_type",
+    // or the narrowest type that holds them (workload/TimeType.hpp).
+    static crow::response respondAlgorithm(const crow::request& req, const std::string& algorithm, const json& input_json) {
+        const AlgorithmSpec* spec = AlgorithmRegistry::find(algorithm);
+        if (spec == nullptr) {
+            json error_json = {
+                {"status", "error"},
+                {"message", "Unsupported scheduling algorithm"}
+            };
+            return ContentNegotiation::respond(req, 400, error_json);
+        }
+
+        static const json no_processes = json::array();
+        const json& process_list = input_json.contains("processes") ? input_json["processes"] : no_processes;
+        TimeType time_type;
         try {
-            auto input_json = json::parse(req.body);
-            
-            // Validate input
-            if (!input_json.contains("processes")) {
-                return crow::response(400, "{\"status\": \"error\", \"message\": \"Missing processes field\"}");
-            }
-            
-            // Parse processes
-            vector<Process> processes;
-            for (const auto& p : input_json["processes"]) {
-                Process process;
-                process.p_id = p["p_id"];
-                process.arrival_time = p["arrival_time"];
-                process.burst_time = p["burst_time"];
-                
-                // Priority is important for MLQ
-                if (p.contains("priority")) {
-                    process.priority = p["priority"];
-                } else {
-                    process.priority = 0;
+            TimeRange range;
+            range.add(process_list);
+            time_type = TimeTypes::select(input_json, range);
+        } catch (const std::invalid_argument& e) {
+            return ContentNegotiation::respond(req, 400, {{"status", "error"}, {"message", e.what()}});
+        }
+        return TimeTypes::visit(time_type, [&](auto zero) {
+            return respondProcesses<decltype(zero)>(req, *spec, process_list, input_json);
+        });
+    }
+
+    template <typename Time>
+    static crow::response respondProcesses(const crow::request& req, const AlgorithmSpec& spec,
+                                           const json& process_list, const json& input_json) {
+        // Extract processes
+        std::vector<BasicProcess<Time>> processes;
+        processes.reserve(process_list.size());
+        for (const auto& process : process_list) {
+            BasicProcess<Time> p;
+            json p_id = process.value("p_id", json());
+            // Ensure p_id is handled as an integer
+            if (p_id.is_number()) {
+                p.p_id = p_id.get<int>();
+            } else if (p_id.is_string()) {
+                // Handle string conversion to integer if necessary
+                try {
+                    p.p_id = std::stoi(p_id.get<std::string>());
+                } catch (const std::exception& e) {
+                    json error_json = {
+                        {"status", "error"},
+                        {"message", "Invalid process ID format: must be convertible to integer"}
+                    };
+                    return ContentNegotiation::respond(req, 400, error_json);
                 }
-                
-                processes.push_back(process);
+            } else {
+                json error_json = {
+                    {"status", "error"},
+                    {"message", "Process ID must be a number or string convertible to number"}
+                };
+                return ContentNegotiation::respond(req, 400, error_json);
             }
-            
-            // Get MLQ specific parameters
-            int num_queues = input_json.value("num_queues", 3);  // Default to 3 queues if not provided
-            int base_quantum = input_json.value("quantum", 2);   // Default base quantum to 2 if not provided
-            
-            // Run MLQ algorithm
-            MLQAging mlq_aging;
-            json result = mlq_aging.schedule(processes, num_queues, base_quantum);
-            
-            // Ensure the result has the correct status
-            result["status"] = "success";
-            
-            return crow::response(200, result.dump());
+
+            p.arrival_time = process.at("arrival_time").get<Time>();
+            p.burst_time = process.at("burst_time").get<Time>();
+            p.priority = process.value("priority", 0);  // Default priority to 0 if not provided
+            processes.push_back(p);
+        }
+
+        json params;
+        try {
+            params = spec.values(input_json);
+        } catch (const std::invalid_argument& e) {
+            return ContentNegotiation::respond(req, 400, {{"status", "error"}, {"message", e.what()}});
+        }
+        return ScheduleResponder::respond(req, spec.name, processes,
+            ScheduleResponder::withOptions(params, input_json));
+    }
+
+    static crow::response handleTraceDownload(const crow::request& req) {
+        vector<Process> processes;
+        json config;
+        try {
+            ContentNegotiation::decodeWorkload(req.body, ContentNegotiation::requestFormat(req), processes, config);
         } catch (const std::exception& e) {
             json error_json = {
                 {"status", "error"},
-                {"message", std::string("Error processing MLQ request: ") + e.what()}
+                {"message", std::string("Invalid JSON data: ") + e.what()}
             };
-            return crow::response(500, error_json.dump());
+            return ContentNegotiation::respond(req, 400, error_json);
+        }
+
+        std::string algorithm = config.value("scheduling_type", std::string());
+        if (!Dispatch::isSupported(algorithm)) {
+            json error_json = {
+                {"status", "error"},
+                {"message", "Unsupported scheduling algorithm"}
+            };
+            return ContentNegotiation::respond(req, 400, error_json);
         }
-    }
 
-    static crow::response handleSJF_AgingSchedule(const crow::request& req) {
         try {
-            auto input_json = json::parse(req.body);
-            
-            // Validate input
-            if (!input_json.contains("processes")) {
-                return crow::response(400, "{\"status\": \"error\", \"message\": \"Missing processes field\"}");
-            }
-            
-            // Parse processes
-            vector<Process> processes;
-            for (const auto& p : input_json["processes"]) {
-                Process process;
-                process.p_id = p["p_id"];
-                process.arrival_time = p["arrival_time"];
-                process.burst_time = p["burst_time"];
-                
-                // Priority is important for MLQ
-                if (p.contains("priority")) {
-                    process.priority = p["priority"];
-                } else {
-                    process.priority = 0;
-                }
-                
-                processes.push_back(process);
-            }
-            
-            // Get SJF specific parameters
-            int aging_threshold = input_json.value("aging_threshold", 50);  // Default to 50 if not provided
-            
-            // Run SJF algorithm
-            SJF_Aging sjf_aging;
-            json result = sjf_aging.schedule(processes, aging_threshold);
-            
-            // Ensure the result has the correct status
-            result["status"] = "success";
-            
-            return crow::response(200, result.dump());
+            std::ostringstream out;
+            ColumnarTraceWriter writer(out, Dispatch::parameters(algorithm, config));
+            Dispatch::run(algorithm, processes, config, writer);
+
+            crow::response response(200, out.str());
+            response.set_header("Content-Type", "application/octet-stream");
+            response.set_header("Content-Disposition", "attachment; filename=\"schedule.ctrace\"");
+            return response;
+        } catch (const std::invalid_argument& e) {
+            return ContentNegotiation::respond(req, 400, {{"status", "error"}, {"message", e.what()}});
         } catch (const std::exception& e) {
             json error_json = {
                 {"status", "error"},
-                {"message", std::string("Error processing SJF request: ") + e.what()}
+                {"message", std::string("Error building trace: ") + e.what()}
             };
-            return crow::response(500, error_json.dump());
+            return ContentNegotiation::respond(req, 500, error_json);
         }
     }
 };
\ No newline at end of file
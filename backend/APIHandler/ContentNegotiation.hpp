@@ -0,0 +1,232 @@
+#pragma once
+
+#include "../crow.h"
+#include "../json.hpp"
+#include "../Parser.hpp"
+#include "../Type.hpp"
+#include "../workload/TimeType.hpp"
+#include "../workload/WorkloadIndex.hpp"
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <cctype>
+#include <cstdlib>
+
+using json = nlohmann::json;
+
+enum class WireFormat { JSON, CBOR, MessagePack };
+
+// Content-Type / Accept handling shared by every route. Bodies may be JSON text, CBOR
+// (application/cbor) or MessagePack (application/msgpack, application/x-msgpack,
+// application/vnd.msgpack); anything else is read as JSON as before.
+class ContentNegotiation {
+private:
+    static std::string mediaTypeOf(const std::string& value) {
+        std::string type = value.substr(0, value.find(';'));
+        size_t first = type.find_first_not_of(" \t");
+        size_t last = type.find_last_not_of(" \t");
+        if (first == std::string::npos) {
+            return "";
+        }
+        type = type.substr(first, last - first + 1);
+        for (auto& c : type) {
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        return type;
+    }
+
+    static bool formatOf(const std::string& media_type, WireFormat& format) {
+        if (media_type == "application/json" || media_type == "*/*" || media_type == "application/*") {
+            format = WireFormat::JSON;
+        } else if (media_type == "application/cbor") {
+            format = WireFormat::CBOR;
+        } else if (media_type == "application/msgpack" || media_type == "application/x-msgpack" ||
+                   media_type == "application/vnd.msgpack") {
+            format = WireFormat::MessagePack;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    static double qualityOf(const std::string& range) {
+        size_t pos = range.find(";q=");
+        if (pos == std::string::npos) {
+            pos = range.find("; q=");
+            if (pos == std::string::npos) {
+                return 1.0;
+            }
+            pos++;
+        }
+        return std::atof(range.c_str() + pos + 3);
+    }
+
+public:
+    static const char* mediaType(WireFormat format) {
+        switch (format) {
+            case WireFormat::CBOR: return "application/cbor";
+            case WireFormat::MessagePack: return "application/msgpack";
+            default: return "application/json";
+        }
+    }
+
+    static WireFormat requestFormat(const crow::request& req) {
+        WireFormat format = WireFormat::JSON;
+        formatOf(mediaTypeOf(req.get_header_value("Content-Type")), format);
+        return format;
+    }
+
+    // Highest-q supported entry of the Accept header; JSON when absent or nothing matches
+    static WireFormat responseFormat(const crow::request& req) {
+        const std::string& accept = req.get_header_value("Accept");
+        WireFormat best = WireFormat::JSON;
+        double best_quality = 0.0;
+        size_t start = 0;
+        while (start < accept.size()) {
+            size_t end = accept.find(',', start);
+            std::string range = accept.substr(start, end == std::string::npos ? std::string::npos : end - start);
+            WireFormat format;
+            double quality = qualityOf(range);
+            if (formatOf(mediaTypeOf(range), format) && quality > best_quality) {
+                best = format;
+                best_quality = quality;
+            }
+            if (end == std::string::npos) {
+                break;
+            }
+            start = end + 1;
+        }
+        return best;
+    }
+
+    // Parses the body in its declared format; returns a discarded value when it is malformed
+    static json decode(const crow::request& req) {
+        switch (requestFormat(req)) {
+            case WireFormat::CBOR:
+                return json::from_cbor(req.body, true, false);
+            case WireFormat::MessagePack:
+                return json::from_msgpack(req.body, true, false);
+            default:
+                return json::parse(req.body, nullptr, false);
+        }
+    }
+
+    // A workload ({"processes": [...], "scheduling_type": ..., ...}) split into processes and the
+    // remaining fields. JSON text goes through the streaming ProcessStream; binary bodies are small
+    // next to their JSON text and are decoded whole. Returns whether any time had a fractional part,
+    // which an integer Time truncates. Throws on malformed input.
+    template <typename Time>
+    static bool decodeWorkload(const std::string& body, WireFormat format, std::vector<BasicProcess<Time>>& processes,
+                               json& config) {
+        if (format == WireFormat::JSON) {
+            ProcessStream stream(body.data(), body.size());
+            BasicProcess<Time> p;
+            while (stream.next(p)) {
+                processes.push_back(p);
+            }
+            config = stream.config();
+            return stream.fractionalTimes();
+        }
+
+        config = format == WireFormat::CBOR ? json::from_cbor(body) : json::from_msgpack(body);
+        if (!config.is_object()) {
+            throw std::runtime_error("workload must be an object");
+        }
+        TimeRange range;
+        for (const auto& process : config.value("processes", json::array())) {
+            const json& arrival_time = process.at("arrival_time");
+            const json& burst_time = process.at("burst_time");
+            range.add(arrival_time.get<double>(), burst_time.get<double>());
+            processes.push_back({process.at("p_id").get<int>(), arrival_time.get<Time>(),
+                                 burst_time.get<Time>(), process.value("priority", 0)});
+        }
+        config.erase("processes");
+        return range.isFractional();
+    }
+
+    // Decodes a workload in the time type its "time_type" asks for, or else the narrowest that holds
+    // it (workload/TimeType.hpp), and returns f(processes, config). The body is read as int64 and
+    // read again only if it turns out to need double.
+    template <typename F>
+    static decltype(auto) withWorkload(const std::string& body, WireFormat format, F&& f) {
+        std::vector<BasicProcess<long long>> processes;
+        json config;
+        bool fractional = decodeWorkload(body, format, processes, config);
+        TimeRange range;
+        range.add(processes);
+        if (fractional) {
+            range.markFractional();
+        }
+        return TimeTypes::visit(TimeTypes::select(config, range), [&](auto zero) {
+            using Time = decltype(zero);
+            if constexpr (std::is_same_v<Time, long long>) {
+                return f(processes, config);
+            } else if constexpr (std::is_floating_point_v<Time>) {
+                if (!fractional) {
+                    return f(TimeTypes::convert<Time>(processes), config);
+                }
+                std::vector<BasicProcess<Time>> exact;
+                json exact_config;
+                decodeWorkload(body, format, exact, exact_config);
+                return f(exact, config);
+            } else {
+                return f(TimeTypes::convert<Time>(processes), config);
+            }
+        });
+    }
+
+    static std::string encode(const json& value, WireFormat format) {
+        std::vector<std::uint8_t> bytes;
+        switch (format) {
+            case WireFormat::CBOR:
+                bytes = json::to_cbor(value);
+                break;
+            case WireFormat::MessagePack:
+                bytes = json::to_msgpack(value);
+                break;
+            default:
+                return value.dump();
+        }
+        return std::string(bytes.begin(), bytes.end());
+    }
+
+    static crow::response respond(const crow::request& req, int code, const json& body) {
+        WireFormat format = responseFormat(req);
+        crow::response response(code, encode(body, format));
+        response.set_header("Content-Type", mediaType(format));
+        response.set_header("Vary", "Accept");
+        return response;
+    }
+
+    // Integer query parameter name, or fallback when absent; false when it is not an integer
+    static bool intParam(const crow::request& req, const char* name, int fallback, int& value) {
+        const char* text = req.url_params.get(name);
+        if (text == nullptr) {
+            value = fallback;
+            return true;
+        }
+        try {
+            size_t used = 0;
+            value = std::stoi(text, &used);
+            return used == std::string(text).size();
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+
+    // Numeric query parameter name, or fallback when absent; false when it is not a number
+    static bool numberParam(const crow::request& req, const char* name, double fallback, double& value) {
+        const char* text = req.url_params.get(name);
+        if (text == nullptr) {
+            value = fallback;
+            return true;
+        }
+        try {
+            size_t used = 0;
+            value = std::stod(text, &used);
+            return used == std::string(text).size();
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+};
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <cerrno>
+#include <sys/random.h>
+
+// Objects the server keeps between requests under random ids (workload sessions, retained runs).
+// An entry expires ttl after it was last found; past capacity the least recently used one is dropped.
+template <typename T>
+class ExpiringStore {
+private:
+    struct Entry {
+        std::shared_ptr<T> value;
+        std::chrono::steady_clock::time_point last_used;
+    };
+
+    std::mutex mutex;
+    std::map<std::string, Entry> entries;
+    std::chrono::steady_clock::duration ttl;
+    size_t capacity;
+    // 128 bits from the kernel's CSPRNG, in hex. An id is all that guards its entry, so it must not
+    // be predictable from the ids a client has already seen.
+    static std::string randomId() {
+        unsigned char bytes[16];
+        size_t filled = 0;
+        while (filled < sizeof(bytes)) {
+            ssize_t got = getrandom(bytes + filled, sizeof(bytes) - filled, 0);
+            if (got < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error("getrandom failed");
+            }
+            filled += static_cast<size_t>(got);
+        }
+        char id[33];
+        for (size_t i = 0; i < sizeof(bytes); i++) {
+            std::snprintf(id + 2 * i, 3, "%02x", bytes[i]);
+        }
+        return id;
+    }
+
+    std::string newId() {
+        std::string id;
+        do {
+            id = randomId();
+        } while (entries.count(id) > 0);
+        return id;
+    }
+
+    // Drops expired entries, then the least recently used ones until there is room; lock held
+    void evict(std::chrono::steady_clock::time_point now) {
+        for (auto it = entries.begin(); it != entries.end();) {
+            if (now - it->second.last_used > ttl) {
+                it = entries.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        while (!entries.empty() && entries.size() >= capacity) {
+            auto oldest = entries.begin();
+            for (auto it = entries.begin(); it != entries.end(); ++it) {
+                if (it->second.last_used < oldest->second.last_used) {
+                    oldest = it;
+                }
+            }
+            entries.erase(oldest);
+        }
+    }
+
+public:
+    ExpiringStore(std::chrono::steady_clock::duration time_to_live, size_t max_entries)
+        : ttl(time_to_live), capacity(max_entries > 0 ? max_entries : 1) {}
+
+    std::string add(std::shared_ptr<T> value) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto now = std::chrono::steady_clock::now();
+        evict(now);
+        std::string id = newId();
+        entries[id] = {std::move(value), now};
+        return id;
+    }
+
+    // The entry for id, which counts as a use; nullptr when unknown or expired
+    std::shared_ptr<T> find(const std::string& id) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(id);
+        if (it == entries.end()) {
+            return nullptr;
+        }
+        auto now = std::chrono::steady_clock::now();
+        if (now - it->second.last_used > ttl) {
+            entries.erase(it);
+            return nullptr;
+        }
+        it->second.last_used = now;
+        return it->second.value;
+    }
+
+    void erase(const std::string& id) {
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.erase(id);
+    }
+};
@@ -0,0 +1,340 @@
+#pragma once
+
+#include "../crow.h"
+#include "SharedMemoryRing.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+// Where and how the server also listens for clients on the same host
+struct LocalTransportOptions {
+    std::string socket_path;
+    // Data area of each connection's shared-memory ring
+    size_t ring_bytes = 64u << 20;
+    // Smaller bodies are sent over the socket even when the client asked for shared memory
+    size_t shm_threshold = 64u << 10;
+    // Connections served at once; more wait in the listen backlog until one closes
+    size_t max_connections = 16;
+};
+
+// The HTTP routes of an App, served over a Unix domain socket besides Crow's TCP port. Requests
+// are parsed by Crow's parser and routed by the App itself, so every route answers exactly as over
+// TCP; WebSocket upgrades are the exception and stay TCP only. A fixed pool of max_connections
+// threads serves the connections, one each: the clients are co-located tools holding a few
+// long-lived connections, and further ones are not accepted until a thread is free.
+//
+// A request with "X-Result-Transport: shm" asks for its body through shared memory. The
+// connection then creates a SharedMemoryRing ("/cpusched-<pid>-<n>", removed when the connection
+// closes), and a response body of at least shm_threshold bytes is copied into it once, after being
+// rendered, instead of being written to the socket. A response that closes the connection
+// (Connection: close, HTTP/1.0) always carries its body itself, since the segment would be gone
+// before the client could open it. The response keeps its status and Content-Type, has an empty body and
+// says where the body is:
+//
+//   X-Shm-Name      the segment, for shm_open()
+//   X-Shm-Size      bytes to map
+//   X-Shm-Offset    where the body starts in the mapping
+//   X-Shm-Length    its length
+//   X-Shm-Release   the value to store into RingHeader::read_position once the body is consumed
+//
+// A body that does not fit in what the client has released goes over the socket as usual.
+template <typename App>
+class LocalTransport {
+private:
+    using Protocol = asio::local::stream_protocol;
+
+    class Connection {
+    private:
+        LocalTransport& transport;
+        std::shared_ptr<Protocol::socket> socket;
+        std::string ring_name;
+        std::unique_ptr<SharedMemoryRing> ring;
+        bool ready = false;
+
+        static const char* reason(int code) {
+            switch (code) {
+            case 200: return "OK";
+            case 201: return "Created";
+            case 204: return "No Content";
+            case 400: return "Bad Request";
+            case 404: return "Not Found";
+            case 405: return "Method Not Allowed";
+            case 406: return "Not Acceptable";
+            case 410: return "Gone";
+            case 413: return "Payload Too Large";
+            case 415: return "Unsupported Media Type";
+            case 500: return "Internal Server Error";
+            default: return "";
+            }
+        }
+
+        bool write(const std::string& data) {
+            asio::error_code ec;
+            asio::write(*socket, asio::buffer(data), ec);
+            return !ec;
+        }
+
+        std::string head(const crow::response& res, size_t content_length, bool close) {
+            std::string out = "HTTP/1.1 " + std::to_string(res.code) + " " + reason(res.code) + "\r\n";
+            for (const auto& header : res.headers) {
+                out += header.first + ": " + header.second + "\r\n";
+            }
+            if (content_length != std::string::npos) {
+                out += "Content-Length: " + std::to_string(content_length) + "\r\n";
+            }
+            if (close) {
+                out += "Connection: close\r\n";
+            }
+            return out + "\r\n";
+        }
+
+        // Moves the body into the ring if the client asked for it and there is room
+        bool divert(crow::response& res) {
+            if (res.body.size() < transport.options.shm_threshold) {
+                return false;
+            }
+            if (!ring) {
+                try {
+                    ring = std::make_unique<SharedMemoryRing>(ring_name, transport.options.ring_bytes);
+                } catch (const std::exception& e) {
+                    CROW_LOG_WARNING << "Local transport: " << e.what();
+                    return false;
+                }
+            }
+            SharedMemoryRing::Placement placement;
+            if (!ring->write(res.body, placement)) {
+                return false;
+            }
+            res.set_header("X-Shm-Name", ring->segmentName());
+            res.set_header("X-Shm-Size", std::to_string(ring->size()));
+            res.set_header("X-Shm-Offset", std::to_string(placement.offset));
+            res.set_header("X-Shm-Length", std::to_string(placement.length));
+            res.set_header("X-Shm-Release", std::to_string(placement.release));
+            res.body.clear();
+            return true;
+        }
+
+        // Answers req; false once the connection should close
+        bool respond(crow::request& req) {
+            bool close = req.close_connection || !req.keep_alive;
+            crow::response res;
+            if (req.upgrade && req.get_header_value("upgrade").find("h2") != 0) {
+                res = crow::response(400, "Upgrades are served over TCP only");
+                close = true;
+            } else {
+                typename App::context_t context;
+                req.middleware_context = &context;
+                req.remote_ip_address = "127.0.0.1";
+                transport.app.handle_full(req, res);
+            }
+
+            bool shm = req.get_header_value("x-result-transport") == "shm";
+            if (res.is_chunked_type()) {
+                if (!shm) {
+                    return writeChunked(res, close) && !close;
+                }
+                // Gathered whole to go through the ring
+                std::string body;
+                res.body_writer([&body](const std::string& chunk) {
+                    body += chunk;
+                    return true;
+                });
+                res.body_writer = nullptr;
+                res.headers.erase("Transfer-Encoding");
+                res.body = std::move(body);
+            }
+            if (shm && !close) {
+                divert(res);
+            }
+            std::string out = head(res, res.body.size(), close);
+            if (!res.skip_body) {
+                out += res.body;
+            }
+            return write(out) && !close;
+        }
+
+        bool writeChunked(crow::response& res, bool close) {
+            bool alive = write(head(res, std::string::npos, close));
+            try {
+                res.body_writer([this, &alive](const std::string& chunk) {
+                    if (alive && !chunk.empty()) {
+                        char size_line[20];
+                        int size_length = std::snprintf(size_line, sizeof(size_line), "%zx\r\n", chunk.size());
+                        alive = write(std::string(size_line, size_length) + chunk + "\r\n");
+                    }
+                    return alive;
+                });
+            } catch (const std::exception& e) {
+                // Closing without the last chunk tells the client the body is incomplete
+                CROW_LOG_ERROR << "Local transport: chunked body failed: " << e.what();
+                return false;
+            }
+            return alive && write("0\r\n\r\n");
+        }
+
+    public:
+        Connection(LocalTransport& owner, std::shared_ptr<Protocol::socket> client, uint64_t serial)
+            : transport(owner), socket(std::move(client)),
+              ring_name("/cpusched-" + std::to_string(getpid()) + "-" + std::to_string(serial)) {}
+
+        // Called by crow::HTTPParser
+        void handle_url() {}
+
+        void handle_header() {}
+
+        void handle() {
+            ready = true;
+        }
+
+        void serve() {
+            crow::HTTPParser<Connection> parser(this);
+            std::vector<char> buffer(64 * 1024);
+            asio::error_code ec;
+            while (true) {
+                size_t length = socket->read_some(asio::buffer(buffer), ec);
+                if (ec) {
+                    break;
+                }
+                if (!parser.feed(buffer.data(), static_cast<int>(length))) {
+                    write("HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+                    break;
+                }
+                if (parser.req.get_header_value("expect") == "100-continue" && !ready && parser.req.body.empty()) {
+                    write("HTTP/1.1 100 Continue\r\n\r\n");
+                    parser.req.headers.erase("expect");
+                }
+                if (!ready) {
+                    continue;
+                }
+                bool keep_open = respond(parser.req);
+                ready = false;
+                parser.clear();
+                if (!keep_open) {
+                    break;
+                }
+            }
+            socket->shutdown(Protocol::socket::shutdown_both, ec);
+            socket->close(ec);
+        }
+    };
+
+    App& app;
+    LocalTransportOptions options;
+    asio::io_context io;
+    Protocol::acceptor acceptor;
+    std::thread accept_thread;
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable changed;
+    // Accepted connections no worker has taken yet
+    std::deque<std::shared_ptr<Protocol::socket>> pending;
+    // Open connections, shut down by stop()
+    std::set<std::shared_ptr<Protocol::socket>> sockets;
+    size_t idle = 0;
+    uint64_t connections = 0;
+    bool stopped = false;
+
+    // Accepts only while a worker is free to take the connection
+    void accept() {
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [this] { return stopped || idle > pending.size(); });
+                if (stopped) {
+                    return;
+                }
+            }
+            auto socket = std::make_shared<Protocol::socket>(io);
+            asio::error_code ec;
+            acceptor.accept(*socket, ec);
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopped) {
+                return;
+            }
+            if (ec) {
+                continue;
+            }
+            sockets.insert(socket);
+            pending.push_back(socket);
+            changed.notify_all();
+        }
+    }
+
+    void work() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            changed.wait(lock, [this] { return stopped || !pending.empty(); });
+            if (stopped) {
+                return;
+            }
+            auto socket = std::move(pending.front());
+            pending.pop_front();
+            idle--;
+            uint64_t serial = connections++;
+            lock.unlock();
+            Connection(*this, socket, serial).serve();
+            lock.lock();
+            sockets.erase(socket);
+            idle++;
+            changed.notify_all();
+        }
+    }
+
+public:
+    LocalTransport(App& application, LocalTransportOptions local) : app(application), options(std::move(local)), acceptor(io) {}
+
+    ~LocalTransport() {
+        stop();
+    }
+
+    // Binds the socket, replacing a stale one left at the path, and starts accepting
+    void start() {
+        ::unlink(options.socket_path.c_str());
+        Protocol::endpoint endpoint(options.socket_path);
+        acceptor.open(endpoint.protocol());
+        acceptor.bind(endpoint);
+        acceptor.listen();
+        idle = std::max<size_t>(1, options.max_connections);
+        for (size_t i = 0; i < idle; i++) {
+            workers.emplace_back([this] { work(); });
+        }
+        accept_thread = std::thread([this] { accept(); });
+        CROW_LOG_INFO << "Local transport listening on " << options.socket_path;
+    }
+
+    // Stops accepting, closes the open connections and removes the socket file
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopped || !accept_thread.joinable()) {
+                return;
+            }
+            stopped = true;
+            asio::error_code ec;
+            acceptor.cancel(ec);
+            for (const auto& socket : sockets) {
+                socket->shutdown(Protocol::socket::shutdown_both, ec);
+            }
+            changed.notify_all();
+        }
+        // A blocking accept is not woken by cancel(); a connection of our own is
+        asio::error_code ec;
+        Protocol::socket wake(io);
+        wake.connect(Protocol::endpoint(options.socket_path), ec);
+        accept_thread.join();
+        acceptor.close(ec);
+        ::unlink(options.socket_path.c_str());
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+};
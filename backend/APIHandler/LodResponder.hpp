@@ -0,0 +1,65 @@
+#pragma once
+
+#include "../crow.h"
+#include "../json.hpp"
+#include "../Type.hpp"
+#include "../algorithms/Dispatch.hpp"
+#include "../trace/GanttLod.hpp"
+#include "ContentNegotiation.hpp"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+// Level-of-detail views (trace/GanttLod.hpp) of a schedule endpoint's Gantt chart, and the query
+// parameters and document they share with /api/runs/<id>/lod
+class LodResponder {
+public:
+    static constexpr int MAX_BUCKETS = 1 << 16;
+    static constexpr int TOP_PROCESSES = 8;
+
+    // ?buckets=N, or ?width=N for one bucket per pixel, asks for a level-of-detail view of the Gantt
+    // chart; ?top=K sets how many processes each bucket lists. buckets is 0 when no view was asked for.
+    static bool params(const crow::request& req, int& buckets, int& top) {
+        int width = 0;
+        if (!ContentNegotiation::intParam(req, "buckets", 0, buckets) ||
+            !ContentNegotiation::intParam(req, "width", 0, width) ||
+            !ContentNegotiation::intParam(req, "top", TOP_PROCESSES, top) || buckets < 0 || width < 0 || top < 1) {
+            return false;
+        }
+        buckets = std::min(buckets > 0 ? buckets : width, MAX_BUCKETS);
+        top = std::min(top, 64);
+        return true;
+    }
+
+    static json document(int from, int to, double bucket_width, const std::vector<LodBucket>& buckets) {
+        json rows = json::array();
+        for (const auto& bucket : buckets) {
+            rows.push_back(bucket.toJson());
+        }
+        return {
+            {"status", "success"},
+            {"from", from},
+            {"to", to},
+            {"bucket_width", bucket_width},
+            {"buckets", std::move(rows)}
+        };
+    }
+
+    // The Gantt chart over [from, to) (by default the whole run) reduced to buckets in one pass over
+    // the engine's output, without building its rows
+    static crow::response respond(const crow::request& req, const std::string& algorithm,
+                                  const std::vector<Process>& processes, const json& params, int buckets, int top) {
+        int from = 0;
+        int to = 0;
+        if (!ContentNegotiation::intParam(req, "from", 0, from) ||
+            !ContentNegotiation::intParam(req, "to", LodTraceSink::scheduleEnd(processes), to)) {
+            return ContentNegotiation::respond(req, 400, {{"status", "error"}, {"message", "from and to must be integers"}});
+        }
+        to = std::max(to, from + 1);
+        LodTraceSink sink(from, to, buckets, top);
+        Dispatch::run(algorithm, processes, params, sink);
+        return ContentNegotiation::respond(req, 200, document(from, to, sink.bucketWidth(), sink.buckets()));
+    }
+};
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "../crow.h"
+#include "../json.hpp"
+#include "../Type.hpp"
+#include "../algorithms/Dispatch.hpp"
+#include "../trace/GanttIndex.hpp"
+#include "../trace/GanttLod.hpp"
+#include "ContentNegotiation.hpp"
+#include "ExpiringStore.hpp"
+#include "LodResponder.hpp"
+#include <chrono>
+#include <climits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+// /api/runs: schedules kept on the server so that a client can fetch the Gantt chart a window at a time.
+//
+//   POST   /api/runs                          body as for /api/schedule; answers {"run_id", "segments",
+//                                             "start_time", "end_time", "expires_in"}
+//   GET    /api/runs/<id>                     the parameters and process_stats of the run
+//   GET    /api/runs/<id>/gantt?from=&to=     the Gantt rows overlapping [from, to), in /api/schedule's form;
+//                                             the first row is the one running at from
+//   GET    /api/runs/<id>/lod?buckets=&from=&to=  [from, to) reduced to level-of-detail buckets (GanttLod.hpp)
+//   DELETE /api/runs/<id>
+//
+// The chart is held in a GanttIndex, so a window costs a binary search plus the rows it returns, and
+// level-of-detail views come from a LodPyramid built over it the first time one is asked for.
+// A run expires RUN_TTL after it was last used.
+class Runs {
+public:
+    static constexpr std::chrono::minutes RUN_TTL{30};
+    static constexpr size_t MAX_RUNS = 64;
+
+private:
+    struct Run {
+        json parameters;
+        GanttIndex index;
+        // Built on the first level-of-detail request
+        std::once_flag pyramid_built;
+        std::unique_ptr<LodPyramid> pyramid;
+    };
+
+    static ExpiringStore<Run>& store() {
+        static ExpiringStore<Run> runs(RUN_TTL, MAX_RUNS);
+        return runs;
+    }
+
+    static crow::response error(const crow::request& req, int code, const std::string& message) {
+        return ContentNegotiation::respond(req, code, {{"status", "error"}, {"message", message}});
+    }
+
+public:
+    static crow::response create(const crow::request& req) {
+        std::vector<Process> processes;
+        json config;
+        try {
+            ContentNegotiation::decodeWorkload(req.body, ContentNegotiation::requestFormat(req), processes, config);
+        } catch (const std::exception& e) {
+            return error(req, 400, std::string("Invalid JSON data: ") + e.what());
+        }
+
+        std::string algorithm = config.value("scheduling_type", std::string());
+        if (!Dispatch::isSupported(algorithm)) {
+            return error(req, 400, "Unsupported scheduling algorithm");
+        }
+
+        auto run = std::make_shared<Run>();
+        try {
+            run->parameters = Dispatch::parameters(algorithm, config);
+            Dispatch::run(algorithm, processes, config, run->index);
+        } catch (const std::invalid_argument& e) {
+            return error(req, 400, e.what());
+        } catch (const std::exception& e) {
+            return error(req, 500, std::string("Error processing run: ") + e.what());
+        }
+        std::string id = store().add(run);
+
+        crow::response response = ContentNegotiation::respond(req, 201, {
+            {"status", "success"},
+            {"run_id", id},
+            {"segments", run->index.size()},
+            {"start_time", run->index.startTime()},
+            {"end_time", run->index.endTime()},
+            {"expires_in", std::chrono::seconds(RUN_TTL).count()}
+        });
+        response.set_header("Location", "/api/runs/" + id);
+        return response;
+    }
+
+    // GET and DELETE on /api/runs/<id>
+    static crow::response handle(const crow::request& req, const std::string& id) {
+        std::shared_ptr<Run> run = store().find(id);
+        if (!run) {
+            return error(req, 404, "Unknown or expired run");
+        }
+        if (req.method == crow::HTTPMethod::Delete) {
+            store().erase(id);
+            return ContentNegotiation::respond(req, 200, {{"status", "success"}, {"run_id", id}});
+        }
+
+        json stats = json::array();
+        for (const auto& row : run->index.statsRows()) {
+            stats.push_back(json::parse(row));
+        }
+        json result = run->parameters;
+        result["status"] = "success";
+        result["run_id"] = id;
+        result["segments"] = run->index.size();
+        result["start_time"] = run->index.startTime();
+        result["end_time"] = run->index.endTime();
+        result["process_stats"] = std::move(stats);
+        return ContentNegotiation::respond(req, 200, result);
+    }
+
+    static crow::response gantt(const crow::request& req, const std::string& id) {
+        std::shared_ptr<Run> run = store().find(id);
+        if (!run) {
+            return error(req, 404, "Unknown or expired run");
+        }
+        int from = 0;
+        int to = 0;
+        if (!ContentNegotiation::intParam(req, "from", INT_MIN, from) || !ContentNegotiation::intParam(req, "to", INT_MAX, to)) {
+            return error(req, 400, "from and to must be integers");
+        }
+
+        json result = {
+            {"status", "success"},
+            {"run_id", id},
+            {"from", from},
+            {"to", to},
+            {"gantt_chart", run->index.window(from, to)}
+        };
+        return ContentNegotiation::respond(req, 200, result);
+    }
+
+    static crow::response lod(const crow::request& req, const std::string& id) {
+        std::shared_ptr<Run> run = store().find(id);
+        if (!run) {
+            return error(req, 404, "Unknown or expired run");
+        }
+        int buckets = 0;
+        int top = 0;
+        int from = 0;
+        int to = 0;
+        if (!LodResponder::params(req, buckets, top) ||
+            !ContentNegotiation::intParam(req, "from", run->index.startTime(), from) ||
+            !ContentNegotiation::intParam(req, "to", run->index.endTime(), to)) {
+            return error(req, 400, "buckets, width, top, from and to must be integers");
+        }
+        to = std::max(to, from + 1);
+        if (buckets == 0) {
+            buckets = 1000;
+        }
+
+        std::call_once(run->pyramid_built, [&]() {
+            run->pyramid.reset(new LodPyramid(run->index));
+        });
+        std::vector<LodBucket> view = run->pyramid->query(from, to, buckets, top);
+        json result = LodResponder::document(from, to, double(to - from) / buckets, view);
+        result["run_id"] = id;
+        return ContentNegotiation::respond(req, 200, result);
+    }
+};
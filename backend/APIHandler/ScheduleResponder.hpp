@@ -0,0 +1,171 @@
+#pragma once
+
+#include "../crow.h"
+#include "../json.hpp"
+#include "../Type.hpp"
+#include "../algorithms/Dispatch.hpp"
+#include "../algorithms/Rescheduler.hpp"
+#include "../metrics/ScheduleSummary.hpp"
+#include "../trace/BinaryTraceSink.hpp"
+#include "../trace/JsonStreamSink.hpp"
+#include "../trace/JsonTraceSink.hpp"
+#include "../trace/TeeTraceSink.hpp"
+#include "../workload/WorkloadIndex.hpp"
+#include "ContentNegotiation.hpp"
+#include "LodResponder.hpp"
+#include "SummaryResponder.hpp"
+#include "WindowResponder.hpp"
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+using json = nlohmann::json;
+
+// The answer of every schedule endpoint: the schedule in the negotiated format, or, by the query,
+// a level-of-detail view (LodResponder), a time window (WindowResponder) or a summary (SummaryResponder)
+class ScheduleResponder {
+public:
+    static constexpr size_t STREAM_CHUNK_BYTES = 64 * 1024;
+
+private:
+    static crow::response error(const crow::request& req, int code, const std::string& message) {
+        return ContentNegotiation::respond(req, code, {{"status", "error"}, {"message", message}});
+    }
+
+    // ?stream=1 asks for a JSON schedule sent with chunked transfer encoding as the engine produces it
+    static bool wantsChunked(const crow::request& req) {
+        const char* stream = req.url_params.get("stream");
+        return stream != nullptr && std::string(stream) != "0" && std::string(stream) != "false" &&
+               req.http_ver_major == 1 && req.http_ver_minor >= 1;
+    }
+
+    // The JSON schedule without a summary. Over int32 times it goes through Rescheduler, which resumes
+    // from a recent run of a similar workload when it can, the one in retained if given; wider time
+    // types are run afresh.
+    template <typename Time>
+    static std::string scheduleDocument(const std::string& algorithm,
+                                        const std::shared_ptr<const BasicWorkloadIndex<Time>>& workload,
+                                        const json& params, Rescheduler::Slot* retained) {
+        if constexpr (std::is_same_v<Time, int>) {
+            return Rescheduler::document(algorithm, workload, params, {{"status", "success"}}, retained);
+        } else {
+            JsonTraceSink sink;
+            Dispatch::run(algorithm, *workload, params, sink);
+            json result = sink.result();
+            result["status"] = "success";
+            return result.dump();
+        }
+    }
+
+public:
+    // The algorithm parameters a handler read, plus the request options respond() reads from
+    // the body ("mode")
+    static json withOptions(json params, const json& body) {
+        if (body.contains("mode")) {
+            params["mode"] = body["mode"];
+        }
+        return params;
+    }
+
+    // The schedule of algorithm over processes in the negotiated format; params are read as by
+    // Dispatch and Time is the processes' time type (workload/TimeType.hpp). JSON goes through
+    // scheduleDocument; CBOR and MessagePack are encoded row by row from the engine through BinaryTraceSink.
+    //
+    // With ?stream=1 a JSON schedule is instead written by JsonStreamSink in STREAM_CHUNK_BYTES chunks
+    // while the engine runs, after the handler has returned.
+    // An engine error before the first chunk becomes an error document; a later one cuts the body short.
+    // A summary (SummaryResponder) is accumulated alongside whichever sink writes the document.
+    template <typename Time>
+    static crow::response respond(const crow::request& req, const std::string& algorithm,
+                                  const std::vector<BasicProcess<Time>>& processes, const json& params,
+                                  Rescheduler::Slot* retained = nullptr) {
+        using Summary = ScheduleSummaryOf<Time>;
+        try {
+            Dispatch::checkSpan(AlgorithmRegistry::at(algorithm), processes);
+        } catch (const std::invalid_argument& e) {
+            return error(req, 400, e.what());
+        }
+        int buckets = 0;
+        int top = 0;
+        if (!LodResponder::params(req, buckets, top)) {
+            return error(req, 400, "buckets, width and top must be positive integers");
+        }
+        if (buckets > 0) {
+            if constexpr (std::is_same_v<Time, int>) {
+                return LodResponder::respond(req, algorithm, processes, params, buckets, top);
+            } else {
+                return error(req, 400, "buckets and width need int32 times");
+            }
+        }
+        if (req.url_params.get("from") != nullptr || req.url_params.get("to") != nullptr) {
+            return WindowResponder::respond(req, algorithm, processes, params);
+        }
+        SummaryMode summary_mode = SummaryMode::None;
+        if (!SummaryResponder::mode(req, params, summary_mode)) {
+            return error(req, 400, "summary must be 0, 1 or only, and mode trace or metrics");
+        }
+        if (summary_mode == SummaryMode::Only) {
+            return SummaryResponder::respond(req, algorithm, processes, params);
+        }
+        bool with_summary = summary_mode == SummaryMode::Included;
+        // Sorted once for whichever sinks run, and shared with the chunked body instead of a copy
+        std::shared_ptr<const BasicWorkloadIndex<Time>> workload = BasicWorkloadIndex<Time>::build(processes);
+
+        WireFormat format = ContentNegotiation::responseFormat(req);
+        if (format == WireFormat::JSON && wantsChunked(req)) {
+            crow::response response(200);
+            response.set_header("Content-Type", ContentNegotiation::mediaType(format));
+            response.set_header("Vary", "Accept");
+            response.set_chunked_body([algorithm, workload, params, with_summary](const crow::response::chunk_writer& write) {
+                JsonStreamSink sink(write, STREAM_CHUNK_BYTES, {{"status", "success"}});
+                try {
+                    if (with_summary) {
+                        Summary summary([&](const json& totals) { sink.setField("summary", totals); });
+                        TeeTraceSink<JsonStreamSink, Summary> tee(sink, summary);
+                        Dispatch::run(algorithm, *workload, params, tee);
+                    } else {
+                        Dispatch::run(algorithm, *workload, params, sink);
+                    }
+                } catch (const std::exception& e) {
+                    if (sink.started()) {
+                        throw;
+                    }
+                    write(json({{"status", "error"}, {"message", e.what()}}).dump());
+                }
+            });
+            return response;
+        }
+
+        std::string body;
+        if (format == WireFormat::JSON && !with_summary) {
+            body = scheduleDocument(algorithm, workload, params, retained);
+        } else if (format == WireFormat::JSON) {
+            JsonTraceSink sink;
+            Summary summary;
+            TeeTraceSink<JsonTraceSink, Summary> tee(sink, summary);
+            Dispatch::run(algorithm, *workload, params, tee);
+            json result = sink.result();
+            result["status"] = "success";
+            result["summary"] = summary.summary();
+            body = result.dump();
+        } else {
+            BinaryTraceSink sink(format == WireFormat::CBOR ? BinaryFormat::CBOR : BinaryFormat::MessagePack);
+            json fields = {{"status", "success"}};
+            if (with_summary) {
+                Summary summary;
+                TeeTraceSink<BinaryTraceSink, Summary> tee(sink, summary);
+                Dispatch::run(algorithm, *workload, params, tee);
+                fields["summary"] = summary.summary();
+            } else {
+                Dispatch::run(algorithm, *workload, params, sink);
+            }
+            body = sink.document(fields);
+        }
+        crow::response response(200, std::move(body));
+        response.set_header("Content-Type", ContentNegotiation::mediaType(format));
+        response.set_header("Vary", "Accept");
+        return response;
+    }
+};
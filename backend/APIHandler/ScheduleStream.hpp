@@ -0,0 +1,277 @@
+#pragma once
+
+#include "../crow.h"
+#include "../json.hpp"
+#include "../Type.hpp"
+#include "../algorithms/Dispatch.hpp"
+#include "../metrics/ScheduleSummary.hpp"
+#include "../trace/BatchingTraceSink.hpp"
+#include "../trace/TeeTraceSink.hpp"
+#include "ContentNegotiation.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using json = nlohmann::json;
+
+// /ws/schedule: streams a schedule over a WebSocket while the engine runs.
+//
+// The client's first message is the workload, shaped like an /api/schedule body (time_type
+// included), plus optional:
+//   "batch_size"   rows per batch (default 256)
+//   "max_delay_ms" longest a started batch waits before it is sent anyway (default 20)
+//   "window"       batches the server may send before the client grants more (default 8)
+//   "encoding"     "json" (text frames, default), "cbor" or "msgpack" (binary frames)
+//   "mode"         "metrics" to skip the batches and send only the done frame
+// The server answers with {"type": "batch", "seq", "gantt_chart": [...], "process_stats": [...]} frames
+// and finally {"type": "done", "summary", ...} or {"type": "error", "message"}, where summary is the
+// run's ScheduleSummary. Every batch uses one credit; {"type": "credit", "batches": N} grants N more
+// and {"type": "cancel"} stops the run. When the credits run out the engine blocks, so a slow client
+// holds the server to `window` batches in flight plus the one being filled. A client that grants no
+// credit for CREDIT_TIMEOUT is disconnected, and at most MAX_STREAMS runs are simulated at once;
+// a workload sent past that is refused by closing with status TRY_AGAIN_LATER.
+class ScheduleStream {
+public:
+    static constexpr size_t MAX_STREAMS = 64;
+    static constexpr std::chrono::seconds CREDIT_TIMEOUT{60};
+    // RFC 6455 close code 1013
+    static constexpr uint16_t TRY_AGAIN_LATER = 1013;
+
+private:
+    struct StreamClosed {};
+
+    struct State {
+        std::mutex mutex;
+        std::condition_variable credit_available;
+        crow::websocket::connection* conn;
+        bool started = false;
+        bool closed = false;
+        long long credits = 8;
+        WireFormat encoding = WireFormat::JSON;
+
+        explicit State(crow::websocket::connection* connection) : conn(connection) {}
+
+        // Sends one frame while the connection is known to be alive; closed is only set under the
+        // same lock, so the connection cannot be destroyed in the middle of a send
+        void send(const json& frame, bool needs_credit) {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (needs_credit &&
+                !credit_available.wait_for(lock, CREDIT_TIMEOUT, [&]() { return credits > 0 || closed; })) {
+                closed = true;
+                conn->close("credit timeout");
+            }
+            if (closed) {
+                throw StreamClosed();
+            }
+            if (needs_credit) {
+                credits--;
+            }
+            if (encoding == WireFormat::JSON) {
+                conn->send_text(frame.dump());
+            } else {
+                conn->send_binary(ContentNegotiation::encode(frame, encoding));
+            }
+        }
+
+        void finish(const std::string& reason, uint16_t status_code = crow::websocket::NormalClosure) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!closed) {
+                closed = true;
+                conn->close(reason, status_code);
+            }
+        }
+    };
+
+    static std::mutex& registryMutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    static std::map<crow::websocket::connection*, std::shared_ptr<State>>& registry() {
+        static std::map<crow::websocket::connection*, std::shared_ptr<State>> streams;
+        return streams;
+    }
+
+    // Streams whose simulate() has not returned; guarded by registryMutex()
+    static size_t& running() {
+        static size_t count = 0;
+        return count;
+    }
+
+    static std::shared_ptr<State> find(crow::websocket::connection& conn) {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        auto it = registry().find(&conn);
+        return it == registry().end() ? nullptr : it->second;
+    }
+
+    static void sendError(const std::shared_ptr<State>& state, const std::string& message) {
+        try {
+            state->send({{"type", "error"}, {"status", "error"}, {"message", message}}, false);
+        } catch (const StreamClosed&) {
+            return;
+        }
+        state->finish("error");
+    }
+
+    // Runs on the stream's own thread so that parsing and scheduling never block the I/O threads
+    static void simulate(std::shared_ptr<State> state, std::string workload, bool is_binary) {
+        struct Slot {
+            ~Slot() {
+                std::lock_guard<std::mutex> lock(registryMutex());
+                running()--;
+            }
+        } slot;
+        try {
+            WireFormat body_format = WireFormat::JSON;
+            if (is_binary) {
+                // Binary workloads are CBOR unless they only parse as MessagePack
+                body_format = json::from_cbor(workload, true, false).is_discarded() ? WireFormat::MessagePack
+                                                                                    : WireFormat::CBOR;
+            }
+            ContentNegotiation::withWorkload(workload, body_format, [&](const auto& processes, const json& config) {
+                workload.clear();
+                workload.shrink_to_fit();
+                run(state, processes, config);
+            });
+        } catch (const StreamClosed&) {
+            // The client went away or cancelled; nothing left to tell it
+        } catch (const std::exception& e) {
+            sendError(state, std::string("Error processing stream: ") + e.what());
+        }
+    }
+
+    // Streams the schedule of a decoded workload, in the time type it was decoded in
+    template <typename Time>
+    static void run(const std::shared_ptr<State>& state, const std::vector<BasicProcess<Time>>& processes,
+                    const json& config) {
+        using Summary = ScheduleSummaryOf<Time>;
+        std::string algorithm = config.value("scheduling_type", std::string());
+        if (!Dispatch::isSupported(algorithm)) {
+            sendError(state, "Unsupported scheduling algorithm");
+            return;
+        }
+
+        std::string encoding = config.value("encoding", std::string("json"));
+        size_t batch_size = static_cast<size_t>(std::clamp<long long>(config.value("batch_size", 256LL), 1, 1 << 16));
+        long long delay_ms = std::clamp<long long>(config.value("max_delay_ms", 20LL), 0, 60000);
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->credits += std::max<long long>(config.value("window", 8LL), 1) - 8;
+            state->encoding = encoding == "cbor" ? WireFormat::CBOR
+                            : encoding == "msgpack" ? WireFormat::MessagePack : WireFormat::JSON;
+        }
+
+        if (Dispatch::metricsOnly(config)) {
+            Summary summary;
+            Dispatch::run(algorithm, processes, config, summary);
+            json totals = summary.summary();
+            state->send({
+                {"type", "done"},
+                {"status", "success"},
+                {"scheduling_algorithm", algorithm},
+                {"batches", 0},
+                {"segments", totals["gantt_segments"]},
+                {"processes", totals["processes"]},
+                {"summary", totals}
+            }, false);
+            state->finish("done");
+            return;
+        }
+
+        long long seq = 0;
+        BatchingTraceSink sink(
+            [&](std::vector<json>& gantt_rows, std::vector<json>& stats_rows) {
+                json frame = {{"type", "batch"}, {"seq", seq++}};
+                frame["gantt_chart"] = std::move(gantt_rows);
+                frame["process_stats"] = std::move(stats_rows);
+                state->send(frame, true);
+            },
+            batch_size, std::chrono::milliseconds(delay_ms));
+        Summary summary;
+        TeeTraceSink<BatchingTraceSink, Summary> tee(sink, summary);
+        Dispatch::run(algorithm, processes, config, tee);
+
+        state->send({
+            {"type", "done"},
+            {"status", "success"},
+            {"scheduling_algorithm", algorithm},
+            {"batches", seq},
+            {"segments", sink.segments()},
+            {"processes", sink.processes()},
+            {"summary", summary.summary()}
+        }, false);
+        state->finish("done");
+    }
+
+public:
+    static void open(crow::websocket::connection& conn) {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        registry()[&conn] = std::make_shared<State>(&conn);
+    }
+
+    static void message(crow::websocket::connection& conn, const std::string& data, bool is_binary) {
+        std::shared_ptr<State> state = find(conn);
+        if (!state) {
+            return;
+        }
+
+        bool start = false;
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            start = !state->started;
+            state->started = true;
+        }
+        if (start) {
+            {
+                std::lock_guard<std::mutex> lock(registryMutex());
+                start = running() < MAX_STREAMS;
+                if (start) {
+                    running()++;
+                }
+            }
+            if (start) {
+                std::thread(simulate, state, data, is_binary).detach();
+            } else {
+                state->finish("too many streams", TRY_AGAIN_LATER);
+            }
+            return;
+        }
+
+        json control = is_binary ? json::from_cbor(data, true, false) : json::parse(data, nullptr, false);
+        if (!control.is_object()) {
+            return;
+        }
+        std::string type = control.value("type", std::string());
+        if (type == "credit") {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->credits += std::max<long long>(control.value("batches", 1LL), 0);
+            state->credit_available.notify_all();
+        } else if (type == "cancel") {
+            state->finish("cancelled");
+            state->credit_available.notify_all();
+        }
+    }
+
+    // Crow calls this before it destroys the connection; a stream blocked on credit wakes and stops
+    static void close(crow::websocket::connection& conn) {
+        std::shared_ptr<State> state;
+        {
+            std::lock_guard<std::mutex> lock(registryMutex());
+            auto it = registry().find(&conn);
+            if (it == registry().end()) {
+                return;
+            }
+            state = it->second;
+            registry().erase(it);
+        }
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->closed = true;
+        state->credit_available.notify_all();
+    }
+};
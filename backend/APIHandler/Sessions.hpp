@@ -0,0 +1,240 @@
+#pragma once
+
+#include "../crow.h"
+#include "../json.hpp"
+#include "../Type.hpp"
+#include "../algorithms/Dispatch.hpp"
+#include "../algorithms/Rescheduler.hpp"
+#include "ContentNegotiation.hpp"
+#include "ScheduleResponder.hpp"
+#include "ExpiringStore.hpp"
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+// /api/sessions: a workload held on the server so that each edit uploads only what changed.
+//
+//   POST   /api/sessions       body as for /api/schedule; answers {"session_id", "expires_in", "processes"}
+//   GET    /api/sessions/<id>  the schedule of the session's workload, as /api/schedule would return it
+//   PATCH  /api/sessions/<id>  {"add": [process, ...], "remove": [p_id, ...], "modify": [{"p_id", field: value, ...}]}
+//                              plus any scheduling_type or parameter to change; answers the new schedule
+//   DELETE /api/sessions/<id>
+//
+// The processes are kept decoded and sorted by arrival (ties in the order they were added), and the
+// session keeps the Rescheduler run of its latest schedule, so an edit only simulates from the
+// earliest arrival it touches however many other workloads the server has run since. The algorithm
+// and parameters are checked on create and on every edit. A session expires SESSION_TTL after it
+// was last used.
+class Sessions {
+public:
+    static constexpr std::chrono::minutes SESSION_TTL{30};
+    static constexpr size_t MAX_SESSIONS = 1024;
+
+private:
+    struct Session {
+        std::mutex mutex;
+        std::string algorithm;
+        json config;
+        std::vector<Process> processes;
+        Rescheduler::Slot retained;
+    };
+
+    static ExpiringStore<Session>& store() {
+        static ExpiringStore<Session> sessions(SESSION_TTL, MAX_SESSIONS);
+        return sessions;
+    }
+
+    static int intOf(const json& value, const char* field) {
+        if (value.is_number()) {
+            return value.get<int>();
+        }
+        if (value.is_string()) {
+            try {
+                return std::stoi(value.get<std::string>());
+            } catch (const std::exception&) {
+            }
+        }
+        throw std::invalid_argument(std::string(field) + " must be a number or string convertible to number");
+    }
+
+    static Process processOf(const json& entry) {
+        if (!entry.is_object() || !entry.contains("p_id") || !entry.contains("arrival_time") ||
+            !entry.contains("burst_time")) {
+            throw std::invalid_argument("process requires p_id, arrival_time and burst_time");
+        }
+        Process p;
+        p.p_id = intOf(entry["p_id"], "p_id");
+        p.arrival_time = intOf(entry["arrival_time"], "arrival_time");
+        p.burst_time = intOf(entry["burst_time"], "burst_time");
+        p.priority = entry.contains("priority") ? intOf(entry["priority"], "priority") : 0;
+        return p;
+    }
+
+    // Rejects what /api/schedule leaves to the engines, whose error documents a session would
+    // otherwise answer every GET with
+    static void checkConfig(const std::string& algorithm, const json& config, const std::vector<Process>& processes) {
+        const AlgorithmSpec* spec = AlgorithmRegistry::find(algorithm);
+        if (spec == nullptr) {
+            throw std::invalid_argument("Unsupported scheduling algorithm");
+        }
+        spec->values(config);
+        Dispatch::metricsOnly(config);
+        Dispatch::checkSpan(*spec, processes);
+    }
+
+    static void insertSorted(std::vector<Process>& processes, const Process& p) {
+        auto at = std::upper_bound(processes.begin(), processes.end(), p.arrival_time,
+                                   [](int arrival, const Process& q) { return arrival < q.arrival_time; });
+        processes.insert(at, p);
+    }
+
+    static std::vector<Process>::iterator findProcess(std::vector<Process>& processes, int p_id) {
+        auto it = std::find_if(processes.begin(), processes.end(), [&](const Process& p) { return p.p_id == p_id; });
+        if (it == processes.end()) {
+            throw std::invalid_argument("Unknown process ID " + std::to_string(p_id));
+        }
+        return it;
+    }
+
+    // Applies a delta to a copy of the session's workload, so a rejected delta changes nothing
+    static void applyDelta(Session& session, const json& delta) {
+        std::vector<Process> processes = session.processes;
+        std::set<int> ids;
+        for (const auto& p : processes) {
+            ids.insert(p.p_id);
+        }
+
+        for (const auto& id : delta.value("remove", json::array())) {
+            auto it = findProcess(processes, intOf(id, "p_id"));
+            ids.erase(it->p_id);
+            processes.erase(it);
+        }
+        for (const auto& entry : delta.value("modify", json::array())) {
+            if (!entry.is_object() || !entry.contains("p_id")) {
+                throw std::invalid_argument("modify entries require p_id");
+            }
+            auto it = findProcess(processes, intOf(entry["p_id"], "p_id"));
+            Process p = *it;
+            if (entry.contains("burst_time")) {
+                p.burst_time = intOf(entry["burst_time"], "burst_time");
+            }
+            if (entry.contains("priority")) {
+                p.priority = intOf(entry["priority"], "priority");
+            }
+            if (entry.contains("arrival_time") && intOf(entry["arrival_time"], "arrival_time") != p.arrival_time) {
+                p.arrival_time = intOf(entry["arrival_time"], "arrival_time");
+                processes.erase(it);
+                insertSorted(processes, p);
+            } else {
+                *it = p;
+            }
+        }
+        for (const auto& entry : delta.value("add", json::array())) {
+            Process p = processOf(entry);
+            if (!ids.insert(p.p_id).second) {
+                throw std::invalid_argument("Duplicate process ID " + std::to_string(p.p_id));
+            }
+            insertSorted(processes, p);
+        }
+
+        json config = session.config;
+        for (auto it = delta.begin(); it != delta.end(); ++it) {
+            if (it.key() != "add" && it.key() != "remove" && it.key() != "modify" && it.key() != "processes") {
+                config[it.key()] = it.value();
+            }
+        }
+        std::string algorithm = config.value("scheduling_type", std::string());
+        checkConfig(algorithm, config, processes);
+
+        session.processes = std::move(processes);
+        session.config = std::move(config);
+        session.algorithm = std::move(algorithm);
+    }
+
+    static crow::response error(const crow::request& req, int code, const std::string& message) {
+        return ContentNegotiation::respond(req, code, {{"status", "error"}, {"message", message}});
+    }
+
+    static crow::response respondSchedule(const crow::request& req, Session& session) {
+        return ScheduleResponder::respond(req, session.algorithm, session.processes, session.config,
+                                          &session.retained);
+    }
+
+public:
+    static crow::response create(const crow::request& req) {
+        auto session = std::make_shared<Session>();
+        std::vector<Process> processes;
+        try {
+            ContentNegotiation::decodeWorkload(req.body, ContentNegotiation::requestFormat(req), processes,
+                                               session->config);
+        } catch (const std::exception& e) {
+            return error(req, 400, std::string("Invalid JSON data: ") + e.what());
+        }
+
+        session->algorithm = session->config.value("scheduling_type", std::string());
+        try {
+            checkConfig(session->algorithm, session->config, processes);
+        } catch (const std::exception& e) {
+            return error(req, 400, e.what());
+        }
+        std::set<int> ids;
+        for (const auto& p : processes) {
+            if (!ids.insert(p.p_id).second) {
+                return error(req, 400, "Duplicate process ID " + std::to_string(p.p_id));
+            }
+        }
+        std::stable_sort(processes.begin(), processes.end(), [](const Process& a, const Process& b) {
+            return a.arrival_time < b.arrival_time;
+        });
+        session->processes = std::move(processes);
+        std::string id = store().add(session);
+
+        crow::response response = ContentNegotiation::respond(req, 201, {
+            {"status", "success"},
+            {"session_id", id},
+            {"expires_in", std::chrono::seconds(SESSION_TTL).count()},
+            {"processes", session->processes.size()}
+        });
+        response.set_header("Location", "/api/sessions/" + id);
+        return response;
+    }
+
+    // GET, PATCH and DELETE on /api/sessions/<id>
+    static crow::response handle(const crow::request& req, const std::string& id) {
+        std::shared_ptr<Session> session = store().find(id);
+        if (!session) {
+            return error(req, 404, "Unknown or expired session");
+        }
+
+        if (req.method == crow::HTTPMethod::Delete) {
+            store().erase(id);
+            return ContentNegotiation::respond(req, 200, {{"status", "success"}, {"session_id", id}});
+        }
+
+        std::lock_guard<std::mutex> lock(session->mutex);
+        if (req.method == crow::HTTPMethod::Patch) {
+            json delta = ContentNegotiation::decode(req);
+            if (!delta.is_object()) {
+                return error(req, 400, "Invalid JSON data");
+            }
+            try {
+                applyDelta(*session, delta);
+            } catch (const std::exception& e) {
+                return error(req, 400, std::string("Invalid edit: ") + e.what());
+            }
+        }
+
+        try {
+            return respondSchedule(req, *session);
+        } catch (const std::exception& e) {
+            return error(req, 500, std::string("Error processing session: ") + e.what());
+        }
+    }
+};
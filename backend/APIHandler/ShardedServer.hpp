@@ -0,0 +1,124 @@
+#pragma once
+
+#include "APIHandler.hpp"
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <pthread.h>
+#include <sched.h>
+
+// The server as one shard per CPU instead of one Crow App whose acceptor hands connections to a
+// shared pool of threads. Every shard is an APIHandler of its own with an SO_REUSEPORT acceptor on
+// the same port, so the kernel spreads new connections over the shards, and a single worker thread
+// that decodes, simulates and serializes every request of its connections. A shard's threads are
+// started from a thread pinned to its CPU and inherit the pinning, so a request never leaves that
+// CPU and the memory it allocates comes from its own thread's malloc arena.
+//
+// Before the shards start, the port is bound once without SO_REUSEPORT, so a port another process
+// already listens on is refused rather than shared with it.
+//
+// Sessions and retained runs stay process-wide (Sessions.hpp, Runs.hpp): a client's next
+// connection may land on any shard.
+class ShardedServer {
+private:
+    std::vector<std::unique_ptr<APIHandler>> shards;
+
+    static void pin(int cpu) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        int error = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (error != 0) {
+            CROW_LOG_WARNING << "Cannot pin shard to CPU " << cpu << ": " << std::strerror(error);
+        }
+    }
+
+    // Throws when port is taken; the shards' reuse_port acceptors would join another process's group
+    static void checkPortFree(int port) {
+        asio::io_context io;
+        asio::ip::tcp::acceptor probe(io);
+        asio::ip::tcp::endpoint endpoint(asio::ip::make_address("0.0.0.0"), static_cast<unsigned short>(port));
+        asio::error_code ec;
+        probe.open(endpoint.protocol(), ec);
+        if (!ec) {
+            probe.set_option(asio::ip::tcp::acceptor::reuse_address(true), ec);
+        }
+        if (!ec) {
+            probe.bind(endpoint, ec);
+        }
+        if (ec) {
+            throw std::runtime_error("cannot bind port " + std::to_string(port) + ": " + ec.message());
+        }
+    }
+
+public:
+    // The CPUs this process may run on, in order
+    static std::vector<int> allowedCpus() {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        std::vector<int> cpus;
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+                if (CPU_ISSET(cpu, &set)) {
+                    cpus.push_back(cpu);
+                }
+            }
+        }
+        if (cpus.empty()) {
+            for (unsigned cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); cpu++) {
+                cpus.push_back(static_cast<int>(cpu));
+            }
+        }
+        return cpus;
+    }
+
+    // count shards, 0 for one per allowed CPU
+    explicit ShardedServer(size_t count) {
+        if (count == 0) {
+            count = allowedCpus().size();
+        }
+        for (size_t i = 0; i < count; i++) {
+            shards.push_back(std::make_unique<APIHandler>());
+        }
+    }
+
+    size_t size() const {
+        return shards.size();
+    }
+
+    // Runs every shard on port until the server is stopped (SIGINT or SIGTERM reaches them all).
+    // Shards outnumbering the CPUs share them round robin. With local, the Unix domain socket is
+    // served too, through the first shard's routes.
+    void run(int port, const LocalTransportOptions* local = nullptr) {
+        checkPortFree(port);
+        std::vector<int> cpus = allowedCpus();
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < shards.size(); i++) {
+            int cpu = cpus[i % cpus.size()];
+            APIHandler* shard = shards[i].get();
+            threads.emplace_back([shard, cpu, port] {
+                pin(cpu);
+                try {
+                    shard->runShard(port);
+                } catch (const std::exception& e) {
+                    CROW_LOG_ERROR << "Shard on CPU " << cpu << " failed: " << e.what();
+                }
+            });
+        }
+        for (const auto& shard : shards) {
+            shard->waitForStart();
+        }
+        CROW_LOG_INFO << shards.size() << " shards on port " << port << " over " << std::min(shards.size(), cpus.size()) << " CPUs";
+        std::unique_ptr<LocalTransport<APIHandler::App>> transport;
+        if (local != nullptr) {
+            transport = shards.front()->startLocal(*local);
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+};
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// A POSIX shared-memory ring the local transport (LocalTransport.hpp) hands response bodies to a
+// client on the same host through. The server is the only writer and the client the only reader:
+// the server copies a body in and sends its place in the X-Shm-* headers, the client reads it in
+// place and gives the space back by storing X-Shm-Release into read_position.
+//
+// The segment starts with a 64-byte RingHeader; the data area follows. Positions count bytes ever
+// written or released, so write_position - read_position is the space in use. A body is never
+// split: one that would cross the end of the data area starts at its beginning instead, the
+// skipped tail counting as written.
+class SharedMemoryRing {
+public:
+    struct RingHeader {
+        char magic[8];                        // "SCHEDSHM"
+        uint32_t version;                     // 1
+        uint32_t header_size;                 // Offset of the data area
+        uint64_t capacity;                    // Size of the data area
+        std::atomic<uint64_t> write_position; // Advanced by the server after a body is in place
+        std::atomic<uint64_t> read_position;  // Advanced by the client when it is done with one
+        char reserved[24];
+    };
+    static_assert(sizeof(RingHeader) == 64, "RingHeader is 64 bytes");
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "Positions are shared between processes");
+
+    // Where write() put a body: offset and length within the mapping, and the read_position that
+    // releases it
+    struct Placement {
+        uint64_t offset;
+        uint64_t length;
+        uint64_t release;
+    };
+
+private:
+    std::string name;
+    size_t mapped_size = 0;
+    RingHeader* header = nullptr;
+    char* data = nullptr;
+
+public:
+    // Creates the segment called name ("/cpusched-..."), with capacity bytes of data
+    SharedMemoryRing(std::string segment_name, size_t capacity) : name(std::move(segment_name)) {
+        int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot create shared memory " + name + ": " + std::strerror(errno));
+        }
+        mapped_size = sizeof(RingHeader) + capacity;
+        void* mapping = MAP_FAILED;
+        if (ftruncate(fd, static_cast<off_t>(mapped_size)) == 0) {
+            mapping = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        int error = errno;
+        close(fd);
+        if (mapping == MAP_FAILED) {
+            shm_unlink(name.c_str());
+            throw std::runtime_error("Cannot map shared memory " + name + ": " + std::strerror(error));
+        }
+        header = new (mapping) RingHeader();
+        std::memcpy(header->magic, "SCHEDSHM", 8);
+        header->version = 1;
+        header->header_size = sizeof(RingHeader);
+        header->capacity = capacity;
+        header->write_position.store(0);
+        header->read_position.store(0);
+        data = static_cast<char*>(mapping) + sizeof(RingHeader);
+    }
+
+    SharedMemoryRing(const SharedMemoryRing&) = delete;
+    SharedMemoryRing& operator=(const SharedMemoryRing&) = delete;
+
+    // The name goes with the server's mapping; a client that mapped the segment keeps its view
+    ~SharedMemoryRing() {
+        munmap(header, mapped_size);
+        shm_unlink(name.c_str());
+    }
+
+    const std::string& segmentName() const {
+        return name;
+    }
+
+    size_t size() const {
+        return mapped_size;
+    }
+
+    // Copies body in if the client has released enough space; false leaves the ring as it was
+    bool write(const std::string& body, Placement& placement) {
+        uint64_t capacity = header->capacity;
+        uint64_t length = body.size();
+        if (length == 0 || length > capacity) {
+            return false;
+        }
+        uint64_t position = header->write_position.load(std::memory_order_relaxed);
+        uint64_t offset = position % capacity;
+        if (offset + length > capacity) {
+            position += capacity - offset;
+            offset = 0;
+        }
+        if (position + length - header->read_position.load(std::memory_order_acquire) > capacity) {
+            return false;
+        }
+        std::memcpy(data + offset, body.data(), length);
+        header->write_position.store(position + length, std::memory_order_release);
+        placement = {sizeof(RingHeader) + offset, length, position + length};
+        return true;
+    }
+};
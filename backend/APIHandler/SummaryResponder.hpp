@@ -0,0 +1,53 @@
+#pragma once
+
+#include "../crow.h"
+#include "../json.hpp"
+#include "../Type.hpp"
+#include "../algorithms/Dispatch.hpp"
+#include "../metrics/ScheduleSummary.hpp"
+#include "ContentNegotiation.hpp"
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+enum class SummaryMode { None, Included, Only };
+
+// Aggregate metrics (metrics/ScheduleSummary.hpp) in place of, or next to, a schedule
+class SummaryResponder {
+public:
+    // ?summary=1 adds a "summary" of aggregate metrics (ScheduleSummary) to the schedule;
+    // ?summary=only, or "mode": "metrics" in the body, answers with the summary alone, without
+    // building the schedule
+    static bool mode(const crow::request& req, const json& params, SummaryMode& mode) {
+        try {
+            if (Dispatch::metricsOnly(params)) {
+                mode = SummaryMode::Only;
+                return true;
+            }
+        } catch (const std::exception&) {
+            return false;
+        }
+        const char* summary = req.url_params.get("summary");
+        std::string value = summary == nullptr ? "0" : summary;
+        if (value == "0" || value == "false") {
+            mode = SummaryMode::None;
+        } else if (value == "1" || value == "true") {
+            mode = SummaryMode::Included;
+        } else if (value == "only") {
+            mode = SummaryMode::Only;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    // The summary alone; the engine runs with it as its only sink, so no schedule is built
+    template <typename Time>
+    static crow::response respond(const crow::request& req, const std::string& algorithm,
+                                  const std::vector<BasicProcess<Time>>& processes, const json& params) {
+        ScheduleSummaryOf<Time> summary;
+        Dispatch::run(algorithm, processes, params, summary);
+        return ContentNegotiation::respond(req, 200, {{"status", "success"}, {"summary", summary.summary()}});
+    }
+};
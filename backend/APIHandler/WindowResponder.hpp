@@ -0,0 +1,75 @@
+#pragma once
+
+#include "../crow.h"
+#include "../json.hpp"
+#include "../Type.hpp"
+#include "../algorithms/ScheduleGenerator.hpp"
+#include "../workload/WorkloadIndex.hpp"
+#include "ContentNegotiation.hpp"
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+// ?from=&to= on a schedule endpoint: one time window of the schedule
+class WindowResponder {
+public:
+    // The rows overlapping [from, to) and the processes completing in [from, to], simulated only as
+    // far as to: the engine runs as a ScheduleGenerator and is cancelled once it is past the window.
+    // Engines may report a completion at to after the row starting there, so events are drained
+    // until one lies beyond to. "complete" tells whether the schedule ended inside the window.
+    template <typename Time>
+    static crow::response respond(const crow::request& req, const std::string& algorithm,
+                                  const std::vector<BasicProcess<Time>>& processes, const json& params) {
+        double from = 0;
+        double to = 0;
+        if (!ContentNegotiation::numberParam(req, "from", -std::numeric_limits<double>::infinity(), from) ||
+            !ContentNegotiation::numberParam(req, "to", std::numeric_limits<double>::infinity(), to)) {
+            return ContentNegotiation::respond(req, 400, {{"status", "error"}, {"message", "from and to must be numbers"}});
+        }
+        using Schedule = BasicScheduleGenerator<Time>;
+        std::optional<Schedule> opened;
+        try {
+            opened.emplace(Schedule::open(algorithm, BasicWorkloadIndex<Time>::build(processes), params, true));
+        } catch (const std::invalid_argument& e) {
+            return ContentNegotiation::respond(req, 400, {{"status", "error"}, {"message", e.what()}});
+        }
+        Schedule& generator = *opened;
+        json gantt_chart = json::array();
+        json process_stats = json::array();
+        bool complete = true;
+        while (std::optional<typename Schedule::Event> event = generator.next()) {
+            if (event->kind == Schedule::Event::Kind::Completion) {
+                double completion = static_cast<double>(event->completion_time);
+                if (completion > to) {
+                    break;
+                }
+                if (completion >= from) {
+                    process_stats.push_back(event->row());
+                }
+                continue;
+            }
+            double start = static_cast<double>(event->start_time);
+            if (start >= to) {
+                complete = false;
+                if (start > to) {
+                    break;
+                }
+                continue;
+            }
+            if (static_cast<double>(event->end_time) > from) {
+                gantt_chart.push_back(event->row());
+            }
+        }
+        generator.cancel();
+        return ContentNegotiation::respond(req, 200, {
+            {"status", "success"},
+            {"gantt_chart", std::move(gantt_chart)},
+            {"process_stats", std::move(process_stats)},
+            {"complete", complete}
+        });
+    }
+};
@@ -0,0 +1,83 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+#pragma once
+#include <string>
+#include <string_view>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+// Read-only memory mapping of a whole file. The kernel pages data in on demand, so a multi-gigabyte
+// file costs address space rather than heap, and sequential scans get read-ahead.
+class MappedFile {
+private:
+    const char* bytes = nullptr;
+    size_t length = 0;
+
+    void release() {
+        if (bytes != nullptr) {
+            munmap(const_cast<char*>(bytes), length);
+        }
+        bytes = nullptr;
+        length = 0;
+    }
+
+public:
+    explicit MappedFile(const string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw runtime_error("Could not open file: " + path);
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw runtime_error("Could not stat file: " + path);
+        }
+
+        length = static_cast<size_t>(info.st_size);
+        if (length > 0) {
+            void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                ::close(fd);
+                throw runtime_error("Could not map file: " + path);
+            }
+            madvise(mapping, length, MADV_SEQUENTIAL);
+            bytes = static_cast<const char*>(mapping);
+        }
+        ::close(fd);
+    }
+
+    ~MappedFile() {
+        release();
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept : bytes(other.bytes), length(other.length) {
+        other.bytes = nullptr;
+        other.length = 0;
+    }
+
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            release();
+            bytes = other.bytes;
+            length = other.length;
+            other.bytes = nullptr;
+            other.length = 0;
+        }
+        return *this;
+    }
+
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+    string_view view() const { return string_view(bytes, length); }
+};
+
+#endif
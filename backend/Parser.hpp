@@ -4,54 +4,383 @@
 #include <string>
 #include <vector>
 #include <fstream>
+#include <memory>
+#include <charconv>
+#include <cstring>
+#include <cctype>
+#include <climits>
+#include <cmath>
+#include <limits>
+#include <type_traits>
 #include "json.hpp"
 #include "Type.hpp"
+#include "MappedFile.hpp"
 using namespace std;
 
+// Single-pass pull scanner over a workload document ({"processes": [...], ...}).
+// Processes are decoded straight from the bytes without building a DOM; every other top-level
+// field is collected into config() as it is passed, so one scan yields the whole workload.
+class ProcessStream {
+private:
+    shared_ptr<MappedFile> file;
+    const char* begin;
+    const char* cursor;
+    const char* end;
+    nlohmann::json fields = nlohmann::json::object();
+    bool started = false;
+    bool in_processes = false;
+    bool first_field = true;
+    bool first_process = true;
+    bool finished = false;
+    bool fractional_times = false;
+
+    [[noreturn]] void fail(const string& message) const {
+        throw runtime_error("Invalid workload JSON at byte " + to_string(cursor - begin) + ": " + message);
+    }
+
+    void skipWhitespace() {
+        while (cursor < end && (*cursor == ' ' || *cursor == '\n' || *cursor == '\r' || *cursor == '\t')) {
+            cursor++;
+        }
+    }
+
+    void expect(char c) {
+        skipWhitespace();
+        if (cursor >= end || *cursor != c) {
+            fail(string("expected '") + c + "'");
+        }
+        cursor++;
+    }
+
+    // Returns the raw (still escaped) contents of a string token
+    string_view readString() {
+        skipWhitespace();
+        if (cursor >= end || *cursor != '"') {
+            fail("expected string");
+        }
+        const char* start = ++cursor;
+        while (cursor < end && *cursor != '"') {
+            cursor += (*cursor == '\\') ? 2 : 1;
+        }
+        if (cursor >= end) {
+            fail("unterminated string");
+        }
+        return string_view(start, static_cast<size_t>(cursor++ - start));
+    }
+
+    // Advances past one value of any type and returns its extent
+    string_view skipValue() {
+        skipWhitespace();
+        const char* start = cursor;
+        int depth = 0;
+        while (cursor < end) {
+            char c = *cursor;
+            if (c == '"') {
+                readString();
+                if (depth == 0) {
+                    break;
+                }
+                continue;
+            }
+            if (c == '{' || c == '[') {
+                depth++;
+            } else if (c == '}' || c == ']') {
+                if (depth == 0) {
+                    break;
+                }
+                if (--depth == 0) {
+                    cursor++;
+                    break;
+                }
+            } else if (depth == 0 && (c == ',' || c == ' ' || c == '\n' || c == '\r' || c == '\t')) {
+                break;
+            }
+            cursor++;
+        }
+        if (cursor == start) {
+            fail("expected value");
+        }
+        return string_view(start, static_cast<size_t>(cursor - start));
+    }
+
+    // A number, possibly quoted as in "p_id": "3". Returns true with real set when it has a fraction
+    // or an exponent, false with integer set otherwise.
+    bool readNumber(long long& integer, double& real) {
+        skipWhitespace();
+        bool quoted = cursor < end && *cursor == '"';
+        if (quoted) {
+            cursor++;
+        }
+
+        const char* start = cursor;
+        bool fractional = false;
+        while (cursor < end && (isdigit(static_cast<unsigned char>(*cursor)) || *cursor == '-' || *cursor == '+' ||
+                                *cursor == '.' || *cursor == 'e' || *cursor == 'E')) {
+            fractional = fractional || *cursor == '.' || *cursor == 'e' || *cursor == 'E';
+            cursor++;
+        }
+
+        if (fractional) {
+            string token(start, cursor);
+            char* parsed_end = nullptr;
+            real = strtod(token.c_str(), &parsed_end);
+            if (parsed_end != token.c_str() + token.size()) {
+                fail("expected number");
+            }
+        } else {
+            auto res = from_chars(start, cursor, integer);
+            if (res.ec != errc() || res.ptr != cursor) {
+                fail("expected integer");
+            }
+        }
+
+        if (quoted) {
+            expect('"');
+        }
+        return fractional;
+    }
+
+    // Integer field; accepts fractional numbers (truncated) and quoted integers such as "p_id": "3"
+    int readInt() {
+        long long value = 0;
+        double real = 0;
+        if (readNumber(value, real)) {
+            value = static_cast<long long>(real);
+        }
+        if (value < INT_MIN || value > INT_MAX) {
+            fail("integer out of range");
+        }
+        return static_cast<int>(value);
+    }
+
+    // Time field of type Time (Type.hpp). Integer types truncate fractional times as readInt does,
+    // and fractionalTimes() reports that one was seen.
+    template <typename Time>
+    Time readTime() {
+        long long integer = 0;
+        double real = 0;
+        if (!readNumber(integer, real)) {
+            if constexpr (!is_floating_point_v<Time>) {
+                if (integer < numeric_limits<Time>::min() || integer > numeric_limits<Time>::max()) {
+                    fail("integer out of range");
+                }
+            }
+            return static_cast<Time>(integer);
+        }
+        fractional_times = fractional_times || real != trunc(real);
+        if constexpr (!is_floating_point_v<Time>) {
+            if (!(real > static_cast<double>(numeric_limits<Time>::min()) - 1 &&
+                  real < static_cast<double>(numeric_limits<Time>::max()) + 1)) {
+                fail("integer out of range");
+            }
+        }
+        return static_cast<Time>(real);
+    }
+
+    template <typename Time>
+    void readProcess(BasicProcess<Time>& p) {
+        expect('{');
+        bool has_id = false, has_arrival = false, has_burst = false;
+        p.priority = 0;
+
+        skipWhitespace();
+        if (cursor < end && *cursor == '}') {
+            cursor++;
+        } else {
+            while (true) {
+                string_view key = readString();
+                expect(':');
+                if (key == "p_id") {
+                    p.p_id = readInt();
+                    has_id = true;
+                } else if (key == "arrival_time") {
+                    p.arrival_time = readTime<Time>();
+                    has_arrival = true;
+                } else if (key == "burst_time") {
+                    p.burst_time = readTime<Time>();
+                    has_burst = true;
+                } else if (key == "priority") {
+                    p.priority = readInt();
+                } else {
+                    skipValue();
+                }
+
+                skipWhitespace();
+                if (cursor < end && *cursor == ',') {
+                    cursor++;
+                    continue;
+                }
+                expect('}');
+                break;
+            }
+        }
+
+        if (!has_id || !has_arrival || !has_burst) {
+            fail("process requires p_id, arrival_time and burst_time");
+        }
+    }
+
+public:
+    // Scans an in-memory document; the bytes must outlive the stream
+    ProcessStream(const char* data, size_t size) : begin(data), cursor(data), end(data + size) {}
+
+    explicit ProcessStream(const string& path) : file(make_shared<MappedFile>(path)) {
+        begin = cursor = file->data();
+        end = begin + file->size();
+    }
+
+    // Produces the next process; returns false at the end of the document
+    template <typename Time>
+    bool next(BasicProcess<Time>& p) {
+        if (!started) {
+            expect('{');
+            started = true;
+            skipWhitespace();
+            if (cursor < end && *cursor == '}') {
+                cursor++;
+                finished = true;
+            }
+        }
+
+        while (!finished) {
+            if (in_processes) {
+                skipWhitespace();
+                if (cursor < end && *cursor == ']') {
+                    cursor++;
+                    in_processes = false;
+                    continue;
+                }
+                if (!first_process) {
+                    expect(',');
+                }
+                first_process = false;
+                readProcess(p);
+                return true;
+            }
+
+            skipWhitespace();
+            if (cursor < end && *cursor == '}') {
+                cursor++;
+                finished = true;
+                break;
+            }
+            if (!first_field) {
+                expect(',');
+            }
+            first_field = false;
+
+            string_view key = readString();
+            expect(':');
+            if (key == "processes") {
+                expect('[');
+                in_processes = true;
+                first_process = true;
+            } else {
+                string_view value = skipValue();
+                fields[string(key)] = nlohmann::json::parse(value.begin(), value.end());
+            }
+        }
+        return false;
+    }
+
+    // Top-level fields other than "processes" seen so far (all of them once next() returned false)
+    const nlohmann::json& config() const {
+        return fields;
+    }
+
+    // Whether an arrival or burst time read so far had a fractional part
+    bool fractionalTimes() const {
+        return fractional_times;
+    }
+
+    // Rough number of bytes left, useful for reserving output capacity
+    size_t remainingBytes() const {
+        return static_cast<size_t>(end - cursor);
+    }
+};
+
 class Parser {
+private:
+    vector<Process> processes;
+    nlohmann::json config;
+
 public:
-    static vector<Process> getProcesses(const string& json_file_path) {
-        nlohmann::json json_data = parseJsonFile(json_file_path);
-        vector<Process> processes;
-
-        for (const auto& process : json_data["processes"]) {
-            Process p;
-            p.p_id = process["p_id"];
-            p.arrival_time = process["arrival_time"];
-            p.burst_time = process["burst_time"];
-            p.priority = process["priority"];
+    // Maps the file once and decodes the processes and every configuration field in a single pass
+    explicit Parser(const string& json_file_path) {
+        ProcessStream stream(json_file_path);
+        Process p;
+        while (stream.next(p)) {
             processes.push_back(p);
         }
+        config = stream.config();
+    }
 
+    const vector<Process>& getProcesses() const {
         return processes;
     }
 
+    vector<Process> takeProcesses() {
+        return std::move(processes);
+    }
+
+    const nlohmann::json& getConfig() const {
+        return config;
+    }
+
+    int getTimeSlice() const {
+        return timeSliceOf(config);
+    }
+
+    int getNumOfQueues() const {
+        return config.value("num_of_queues", 1);
+    }
+
+    string getSchedulingAlgorithm() const {
+        if (!config.contains("scheduling_type")) {
+            throw runtime_error("Missing scheduling_type field");
+        }
+        return config["scheduling_type"];
+    }
+
+    static vector<Process> getProcesses(const string& json_file_path) {
+        return Parser(json_file_path).takeProcesses();
+    }
+
     static int getTimeSlice(const string& json_file_path) {
-        nlohmann::json json_data = parseJsonFile(json_file_path);
-        return json_data["time_slice"];
+        return timeSliceOf(readConfig(json_file_path));
     }
 
     static int getNumOfQueues(const string& json_file_path) {
-        nlohmann::json json_data = parseJsonFile(json_file_path);
-        return json_data.value("num_of_queues", 1);
+        return readConfig(json_file_path).value("num_of_queues", 1);
     }
 
     static string getSchedulingAlgorithm(const string& json_file_path) {
-        nlohmann::json json_data = parseJsonFile(json_file_path);
+        nlohmann::json json_data = readConfig(json_file_path);
+        if (!json_data.contains("scheduling_type")) {
+            throw runtime_error("Missing scheduling_type field in " + json_file_path);
+        }
         return json_data["scheduling_type"];
     }
 
 private:
-    static nlohmann::json parseJsonFile(const string& json_file_path) {
-        ifstream file(json_file_path);
-        if (!file.is_open()) {
-            throw runtime_error("Could not open JSON file: " + json_file_path);
+    static int timeSliceOf(const nlohmann::json& json_data) {
+        if (json_data.contains("time_slice")) {
+            return json_data["time_slice"];
+        }
+        if (json_data.contains("quantum")) {
+            return json_data["quantum"];
         }
+        throw runtime_error("Missing time_slice field");
+    }
 
-        nlohmann::json json_data;
-        file >> json_data;
-        return json_data;
+    // Configuration only: processes are scanned over but never stored
+    static nlohmann::json readConfig(const string& json_file_path) {
+        ProcessStream stream(json_file_path);
+        Process p;
+        while (stream.next(p)) {
+        }
+        return stream.config();
     }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -3,11 +3,17 @@
 
 using namespace std;
 
-struct Process {
+// A process whose times are of type Time: int by default, long long for workloads whose times
+// pass INT_MAX and double for fractional times (see workload/TimeType.hpp). priority is a rank
+// rather than a time and stays an int.
+template <typename Time>
+struct BasicProcess {
     int p_id;
-    int arrival_time;
-    int burst_time;
+    Time arrival_time;
+    Time burst_time;
     int priority;
 };
 
-#endif
\ No newline at end of file
+using Process = BasicProcess<int>;
+
+#endif
@@ -0,0 +1,187 @@
+#ifndef ALGORITHM_REGISTRY_HPP
+#define ALGORITHM_REGISTRY_HPP
+#pragma once
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include "../json.hpp"
+
+using namespace std;
+using json = nlohmann::json;
+
+enum class Algorithm { FCFS, SJF, RR, Priority, MLQ, MLFQ, MLQ_Aging, SJF_Aging };
+
+enum class Parameter { Quantum, NumQueues, AgingThreshold };
+
+// An integer parameter: its key in requests and in Dispatch::parameters, the other spelling some
+// routes and io/*.json files use (read only when the key is absent), its default and the values an
+// engine accepts. A zero quantum or queue count would never advance, and MLQ and MLFQ give queue i a
+// quantum of quantum << i, so there are at most 31 queues.
+struct ParameterSpec {
+    Parameter id;
+    const char* name;
+    const char* alias;
+    int fallback;
+    int minimum;
+    int maximum;
+
+    // Throws unless value is one this parameter takes
+    void check(long long value) const {
+        if (value < minimum || value > maximum) {
+            throw invalid_argument(string(name) + " must be between " + to_string(minimum) + " and " +
+                                   to_string(maximum));
+        }
+    }
+};
+
+struct AlgorithmSpec {
+    const char* name;
+    Algorithm id;
+    ParameterSpec parameters[2];
+    size_t parameter_count;
+
+    // The value of a parameter this algorithm takes, from a request or config object
+    int read(const json& config, Parameter parameter) const {
+        for (size_t i = 0; i < parameter_count; i++) {
+            if (parameters[i].id == parameter) {
+                return read(config, parameters[i]);
+            }
+        }
+        throw invalid_argument(string(name) + " takes no such parameter");
+    }
+
+    static int read(const json& config, const ParameterSpec& spec) {
+        const char* key = config.contains(spec.name) ? spec.name
+                        : spec.alias != nullptr && config.contains(spec.alias) ? spec.alias : nullptr;
+        if (key == nullptr) {
+            return spec.fallback;
+        }
+        const json& value = config[key];
+        if (!value.is_number_integer()) {
+            throw invalid_argument(string(key) + " must be an integer");
+        }
+        spec.check(value.is_number_unsigned() && value.get<unsigned long long>() > LLONG_MAX ? LLONG_MAX
+                                                                                            : value.get<long long>());
+        return value.get<int>();
+    }
+
+    // Every parameter with its value, defaults filled in
+    json values(const json& config) const {
+        json values = json::object();
+        for (size_t i = 0; i < parameter_count; i++) {
+            values[parameters[i].name] = read(config, parameters[i]);
+        }
+        return values;
+    }
+};
+
+// The algorithms and how their names are hashed. Kept apart from AlgorithmRegistry, whose table is
+// computed from them at compile time.
+struct AlgorithmTable {
+    static constexpr ParameterSpec QUANTUM_1 = {Parameter::Quantum, "quantum", "time_slice", 1, 1, INT_MAX};
+    static constexpr ParameterSpec QUANTUM_2 = {Parameter::Quantum, "quantum", "time_slice", 2, 1, INT_MAX};
+    static constexpr ParameterSpec NUM_QUEUES = {Parameter::NumQueues, "num_queues", "num_of_queues", 3, 1, 31};
+    static constexpr ParameterSpec AGING_THRESHOLD = {Parameter::AgingThreshold, "aging_threshold", nullptr, 50,
+                                                      INT_MIN, INT_MAX};
+
+    static constexpr size_t COUNT = 8;
+    static constexpr size_t SLOTS = 16;
+
+    static constexpr AlgorithmSpec SPECS[COUNT] = {
+        {"FCFS", Algorithm::FCFS, {}, 0},
+        {"SJF", Algorithm::SJF, {}, 0},
+        {"RR", Algorithm::RR, {QUANTUM_1}, 1},
+        {"Priority", Algorithm::Priority, {}, 0},
+        {"MLQ", Algorithm::MLQ, {NUM_QUEUES, QUANTUM_2}, 2},
+        {"MLFQ", Algorithm::MLFQ, {NUM_QUEUES, QUANTUM_2}, 2},
+        {"MLQ_Aging", Algorithm::MLQ_Aging, {NUM_QUEUES, QUANTUM_2}, 2},
+        {"SJF_Aging", Algorithm::SJF_Aging, {AGING_THRESHOLD}, 1}
+    };
+
+    // FNV-1a from a seed. Multiplying only carries upwards, so the high half is folded into the low
+    // bits the slot is taken from.
+    static constexpr size_t slot(string_view name, uint32_t seed) {
+        uint32_t hash = 2166136261u ^ seed;
+        for (char c : name) {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+        }
+        return (hash ^ (hash >> 16)) % SLOTS;
+    }
+
+    static constexpr bool collisionFree(uint32_t seed) {
+        bool used[SLOTS] = {};
+        for (const AlgorithmSpec& spec : SPECS) {
+            size_t s = slot(spec.name, seed);
+            if (used[s]) {
+                return false;
+            }
+            used[s] = true;
+        }
+        return true;
+    }
+
+    // The first seed that gives every name its own slot
+    static constexpr uint32_t findSeed() {
+        uint32_t seed = 0;
+        while (!collisionFree(seed)) {
+            seed++;
+        }
+        return seed;
+    }
+
+    struct Slots {
+        // Index into SPECS, or -1
+        int8_t entries[SLOTS];
+    };
+
+    static constexpr Slots slots(uint32_t seed) {
+        Slots slots = {};
+        for (size_t s = 0; s < SLOTS; s++) {
+            slots.entries[s] = -1;
+        }
+        for (size_t i = 0; i < COUNT; i++) {
+            slots.entries[slot(SPECS[i].name, seed)] = static_cast<int8_t>(i);
+        }
+        return slots;
+    }
+};
+
+// The algorithms by name. Names are placed by a hash whose seed is searched for at compile time,
+// so each lands in its own slot: a lookup hashes the name once and checks the one entry there.
+class AlgorithmRegistry {
+private:
+    static constexpr uint32_t SEED = AlgorithmTable::findSeed();
+    static constexpr AlgorithmTable::Slots SLOTS = AlgorithmTable::slots(SEED);
+
+public:
+    // The algorithm called name, or nullptr. Only the entry in name's slot is compared, to turn
+    // away names that are not in the table.
+    static const AlgorithmSpec* find(string_view name) {
+        int entry = SLOTS.entries[AlgorithmTable::slot(name, SEED)];
+        if (entry < 0 || name != AlgorithmTable::SPECS[entry].name) {
+            return nullptr;
+        }
+        return &AlgorithmTable::SPECS[entry];
+    }
+
+    static const AlgorithmSpec& at(string_view name) {
+        const AlgorithmSpec* spec = find(name);
+        if (spec == nullptr) {
+            throw invalid_argument("Unsupported scheduling algorithm: " + string(name));
+        }
+        return *spec;
+    }
+
+    static const AlgorithmSpec* begin() {
+        return AlgorithmTable::SPECS;
+    }
+
+    static const AlgorithmSpec* end() {
+        return AlgorithmTable::SPECS + AlgorithmTable::COUNT;
+    }
+};
+
+#endif
@@ -0,0 +1,149 @@
+#ifndef DISPATCH_HPP
+#define DISPATCH_HPP
+#pragma once
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include "../json.hpp"
+#include "../Type.hpp"
+#include "../workload/WorkloadIndex.hpp"
+#include "AlgorithmRegistry.hpp"
+#include "FCFS.hpp"
+#include "SJF.hpp"
+#include "RR.hpp"
+#include "Priority.hpp"
+#include "MLQ.hpp"
+#include "MLFQ.hpp"
+#include "MLQ_Aging.hpp"
+#include "SJF_Aging.hpp"
+
+using namespace std;
+using json = nlohmann::json;
+
+// Runs the algorithm named by scheduling_type. The name is looked up in AlgorithmRegistry, whose
+// schema reads the parameters from the same object as in the HTTP requests and io/*.json files,
+// accepting the alternative spellings used across the routes.
+class Dispatch {
+public:
+    // SJF_Aging and MLQ_Aging advance at most one time unit per step and visit the waiting processes
+    // in each, so their running time grows with the total burst time (times the processes) rather
+    // than with the number of events. Workloads past these limits are refused before they run.
+    static constexpr double MAX_UNIT_STEPS = 1e8;
+    static constexpr double MAX_UNIT_WORK = 1e10;
+
+    static bool isSupported(const string& algorithm) {
+        return AlgorithmRegistry::find(algorithm) != nullptr;
+    }
+
+    // Throws invalid_argument if spec's engine would take too long over processes (see MAX_UNIT_STEPS)
+    template <typename Time>
+    static void checkSpan(const AlgorithmSpec& spec, const vector<BasicProcess<Time>>& processes) {
+        double steps = 0;
+        for (const auto& p : processes) {
+            steps += max(0.0, static_cast<double>(p.burst_time));
+        }
+        checkSpan(spec, steps, processes.size());
+    }
+
+    // The same check given the workload's total burst time and process count
+    static void checkSpan(const AlgorithmSpec& spec, double steps, size_t count) {
+        if (spec.id != Algorithm::SJF_Aging && spec.id != Algorithm::MLQ_Aging) {
+            return;
+        }
+        if (steps > MAX_UNIT_STEPS || steps * count > MAX_UNIT_WORK) {
+            throw invalid_argument(string(spec.name) + " simulates one time unit per step: a total burst time of " +
+                                   to_string(static_cast<long long>(steps)) + " over " + to_string(count) +
+                                   " processes is too long to run (at most " +
+                                   to_string(static_cast<long long>(MAX_UNIT_STEPS)) + " units, and " +
+                                   to_string(static_cast<long long>(MAX_UNIT_WORK)) + " units times processes)");
+        }
+    }
+
+    static json schedule(const string& algorithm, const vector<Process>& processes, const json& config) {
+        const AlgorithmSpec& spec = AlgorithmRegistry::at(algorithm);
+        checkSpan(spec, processes);
+        switch (spec.id) {
+        case Algorithm::FCFS:
+            return FCFS().schedule(processes);
+        case Algorithm::SJF:
+            return SJF().schedule(processes);
+        case Algorithm::RR:
+            return RR().schedule(processes, spec.read(config, Parameter::Quantum));
+        case Algorithm::Priority:
+            return Priority().schedule(processes);
+        case Algorithm::MLQ:
+            return MLQ().schedule(processes, spec.read(config, Parameter::NumQueues), spec.read(config, Parameter::Quantum));
+        case Algorithm::MLFQ:
+            return MLFQ(spec.read(config, Parameter::Quantum), spec.read(config, Parameter::NumQueues)).schedule(processes);
+        case Algorithm::MLQ_Aging:
+            return MLQAging().schedule(processes, spec.read(config, Parameter::NumQueues),
+                                       spec.read(config, Parameter::Quantum));
+        case Algorithm::SJF_Aging:
+            return SJF_Aging(spec.read(config, Parameter::AgingThreshold)).schedule(processes);
+        }
+        throw invalid_argument("Unsupported scheduling algorithm: " + algorithm);
+    }
+
+    // Same algorithms and defaults as schedule(), reporting to any trace sink (trace/JsonTraceSink.hpp).
+    // Time is the workload's time type (Type.hpp).
+    template <typename Time, typename Sink>
+    static void run(const string& algorithm, const vector<BasicProcess<Time>>& processes, const json& config, Sink& sink) {
+        run(algorithm, BasicWorkloadIndex<Time>(processes), config, sink);
+    }
+
+    // The same over a workload already indexed, which several runs may share
+    template <typename Time, typename Sink>
+    static void run(const string& algorithm, const BasicWorkloadIndex<Time>& workload, const json& config, Sink& sink) {
+        const AlgorithmSpec& spec = AlgorithmRegistry::at(algorithm);
+        checkSpan(spec, workload.sorted());
+        switch (spec.id) {
+        case Algorithm::FCFS:
+            BasicFCFS<Time>().run(workload, sink);
+            break;
+        case Algorithm::SJF:
+            BasicSJF<Time>().run(workload, sink);
+            break;
+        case Algorithm::RR:
+            BasicRR<Time>().run(workload, spec.read(config, Parameter::Quantum), sink);
+            break;
+        case Algorithm::Priority:
+            BasicPriority<Time>().run(workload, sink);
+            break;
+        case Algorithm::MLQ:
+            BasicMLQ<Time>().run(workload, spec.read(config, Parameter::NumQueues), spec.read(config, Parameter::Quantum), sink);
+            break;
+        case Algorithm::MLFQ:
+            BasicMLFQ<Time>(spec.read(config, Parameter::Quantum), spec.read(config, Parameter::NumQueues)).run(workload, sink);
+            break;
+        case Algorithm::MLQ_Aging:
+            BasicMLQAging<Time>().run(workload, spec.read(config, Parameter::NumQueues), spec.read(config, Parameter::Quantum), sink);
+            break;
+        case Algorithm::SJF_Aging:
+            BasicSJF_Aging<Time>(spec.read(config, Parameter::AgingThreshold)).run(workload, sink);
+            break;
+        }
+        sink.finish();
+    }
+
+    // "mode": "metrics" asks for the aggregate metrics alone. Such a run goes to a ScheduleSummary,
+    // whose instantiation of the engine never calls the row callbacks, so no Gantt rows or
+    // ready-queue snapshots are built. "trace", the default, asks for the whole schedule.
+    static bool metricsOnly(const json& config) {
+        string mode = config.value("mode", string("trace"));
+        if (mode != "trace" && mode != "metrics") {
+            throw invalid_argument("Unknown mode: " + mode + " (expected trace or metrics)");
+        }
+        return mode == "metrics";
+    }
+
+    // The parameters an algorithm actually ran with, defaults filled in. Unknown algorithms have
+    // none; a parameter of the wrong type throws invalid_argument.
+    static json parameters(const string& algorithm, const json& config) {
+        const AlgorithmSpec* spec = AlgorithmRegistry::find(algorithm);
+        json params = spec != nullptr ? spec->values(config) : json::object();
+        params["scheduling_algorithm"] = algorithm;
+        return params;
+    }
+};
+
+#endif
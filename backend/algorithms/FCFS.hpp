@@ -6,96 +6,126 @@
 #include <string>
 #include "../json.hpp"
 #include "../Type.hpp"
+#include "../trace/JsonTraceSink.hpp"
+#include "../workload/WorkloadIndex.hpp"
+#include "Stepping.hpp"
 
 using namespace std;
 
-class FCFS {
+template <typename Time>
+class BasicFCFS {
 public:
+    using Process = BasicProcess<Time>;
+    using WorkloadIndex = BasicWorkloadIndex<Time>;
+
+private:
+    static void idle(nlohmann::json& row) {
+        row["ready_queue"] = nlohmann::json::array();
+    }
+
+public:
+    // Everything the main loop carries from one step to the next; a copy is a checkpoint that
+    // simulate() can resume from (see Rescheduler.hpp)
+    struct State {
+        Time current_time = 0;
+        size_t next = 0;
+        vector<Time> completion_time;
+
+        Time time() const {
+            return current_time;
+        }
+
+        // Keeps the first `kept` processes and starts the rest of `sorted` afresh
+        void rebase(const vector<Process>& sorted, size_t kept) {
+            completion_time.resize(sorted.size(), 0);
+            fill(completion_time.begin() + kept, completion_time.end(), 0);
+        }
+    };
+
     nlohmann::json schedule(const vector<Process>& processes) {
-        vector<Process> sorted = processes;
-        sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b) {
-            return a.arrival_time < b.arrival_time;
-        });
+        if (processes.empty()) {
+            return nlohmann::json();
+        }
+        JsonTraceSink sink;
+        run(processes, sink);
+        return sink.result();
+    }
 
-        nlohmann::json result;
-        nlohmann::json gantt_chart = nlohmann::json::array();
-        nlohmann::json process_stats = nlohmann::json::array();
+    template <typename Sink>
+    void run(const vector<Process>& processes, Sink& sink) {
+        run(WorkloadIndex(processes), sink);
+    }
 
-        int current_time = 0;
-        vector<int> completion_time(sorted.size(), 0);
-        
-        
-        if (sorted.empty()) {
-            return result;
+    template <typename Sink>
+    void run(const WorkloadIndex& workload, Sink& sink) {
+        if (workload.empty()) {
+            return;
         }
-    
+
+        State state = start(workload, sink);
+        simulate(workload, state, sink, [](const State&) {});
+    }
+
+    // Sets up the state for the workload, writing the leading idle segment if any
+    template <typename Sink>
+    State start(const WorkloadIndex& workload, Sink& sink) {
+        const vector<Process>& sorted = workload.sorted();
+        State state;
+        state.rebase(sorted, 0);
         if (sorted[0].arrival_time > 0) {
-            nlohmann::json idle_row;
-            idle_row["process_id"] = -1; 
-            idle_row["start_time"] = 0;
-            idle_row["end_time"] = sorted[0].arrival_time;
-            idle_row["ready_queue"] = nlohmann::json::array();
-            gantt_chart.push_back(idle_row);
-            current_time = sorted[0].arrival_time;
+            sink.beginSegment(-1, Time(0), -1, idle);
+            sink.endSegment(sorted[0].arrival_time);
+            state.current_time = sorted[0].arrival_time;
         }
+        return state;
+    }
+
+    // The main loop; on_step(state) runs before every step and may pause it (Stepping.hpp)
+    template <typename Sink, typename OnStep>
+    void simulate(const WorkloadIndex& workload, State& state, Sink& sink, OnStep&& on_step) {
+        const vector<Process>& sorted = workload.sorted();
+        Time& current_time = state.current_time;
+        vector<Time>& completion_time = state.completion_time;
+        auto arrived_by = [&](Time time) {
+            return workload.arrivedBy(time);
+        };
         
-        for (size_t i = 0; i < sorted.size(); i++) {
+        for (size_t& i = state.next; i < sorted.size(); i++) {
+            if (!Stepping::proceed(on_step, state)) {
+                return;
+            }
             if (current_time < sorted[i].arrival_time) {
-                nlohmann::json idle_row;
-                idle_row["process_id"] = -1;  
-                idle_row["start_time"] = current_time;
-                idle_row["end_time"] = sorted[i].arrival_time;
-                idle_row["ready_queue"] = nlohmann::json::array();
-                gantt_chart.push_back(idle_row);
+                sink.beginSegment(-1, current_time, -1, idle);
+                sink.endSegment(sorted[i].arrival_time);
                 current_time = sorted[i].arrival_time;
             }
             
-            int process_start_time = current_time;
-            int process_end_time = process_start_time + sorted[i].burst_time;
-            
-            vector<int> arrival_points;
-            vector<vector<int>> ready_queues;
+            Time process_start_time = current_time;
+            Time process_end_time = process_start_time + sorted[i].burst_time;
             
-            vector<int> current_ready_queue;
-            for (size_t j = i + 1; j < sorted.size(); j++) {
-                if (sorted[j].arrival_time <= current_time) {
-                    current_ready_queue.push_back(sorted[j].p_id);
-                }
-            }
+            // Sorted by arrival, so the arrivals inside (start, end) are one contiguous run
+            vector<Time> arrival_points;
             arrival_points.push_back(process_start_time);
-            ready_queues.push_back(current_ready_queue);
-            
-            for (size_t j = 0; j < sorted.size(); j++) {
-                int arrival = sorted[j].arrival_time;
-                if (arrival > process_start_time && arrival < process_end_time) {
-                    arrival_points.push_back(arrival);
+            for (size_t j = arrived_by(process_start_time); j < sorted.size(); j++) {
+                Time arrival = sorted[j].arrival_time;
+                if (arrival >= process_end_time) {
+                    break;
                 }
-            }
-            
-            sort(arrival_points.begin(), arrival_points.end());
-            
-            arrival_points.erase(unique(arrival_points.begin(), arrival_points.end()), 
-                              arrival_points.end());
-            
-            for (size_t j = 1; j < arrival_points.size(); j++) {
-                vector<int> ready_queue;
-                for (size_t k = i + 1; k < sorted.size(); k++) {
-                    if (sorted[k].arrival_time <= arrival_points[j]) {
-                        ready_queue.push_back(sorted[k].p_id);
-                    }
+                if (arrival != arrival_points.back()) {
+                    arrival_points.push_back(arrival);
                 }
-                ready_queues.push_back(ready_queue);
             }
-            
             arrival_points.push_back(process_end_time);
             
             for (size_t j = 0; j < arrival_points.size() - 1; j++) {
-                nlohmann::json gantt_row;
-                gantt_row["process_id"] = sorted[i].p_id;
-                gantt_row["start_time"] = arrival_points[j];
-                gantt_row["end_time"] = arrival_points[j + 1];
-                gantt_row["ready_queue"] = ready_queues[j];
-                gantt_chart.push_back(gantt_row);
+                sink.beginSegment(sorted[i].p_id, arrival_points[j], 0, [&](nlohmann::json& row) {
+                    vector<int> ready_queue;
+                    for (size_t k = i + 1, last = arrived_by(arrival_points[j]); k < last; k++) {
+                        ready_queue.push_back(sorted[k].p_id);
+                    }
+                    row["ready_queue"] = ready_queue;
+                });
+                sink.endSegment(arrival_points[j + 1]);
             }
             
             current_time = process_end_time;
@@ -103,26 +133,11 @@ public:
         }
 
         for (size_t i = 0; i < sorted.size(); i++) {
-            int comp_time = completion_time[i];
-            int turn_around = comp_time - sorted[i].arrival_time;
-            int waiting = turn_around - sorted[i].burst_time;
-
-            nlohmann::json stats_row;
-            stats_row["process_id"] = sorted[i].p_id;
-            stats_row["arrival_time"] = sorted[i].arrival_time;
-            stats_row["burst_time"] = sorted[i].burst_time;
-            stats_row["priority"] = sorted[i].priority;
-            stats_row["completion_time"] = comp_time;
-            stats_row["turnaround_time"] = turn_around;
-            stats_row["waiting_time"] = waiting;
-
-            process_stats.push_back(stats_row);
+            sink.completeProcess(sorted[i], completion_time[i]);
         }
-
-        result["gantt_chart"] = gantt_chart;
-        result["process_stats"] = process_stats;
-        return result;
     }
 };
 
+using FCFS = BasicFCFS<int>;
+
 #endif
\ No newline at end of file
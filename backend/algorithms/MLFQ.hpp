@@ -5,57 +5,118 @@
 #include <vector>
 #include <algorithm>
 #include <queue>
-#include <climits>
+#include <limits>
+#include <type_traits>
 #include "../Type.hpp"
 #include "../json.hpp"
+#include "../trace/JsonTraceSink.hpp"
+#include "../workload/WorkloadIndex.hpp"
+#include "Stepping.hpp"
 
 using namespace std;
 using json = nlohmann::json;
 
-class MLFQ {
+template <typename Time>
+class BasicMLFQ {
+public:
+    using Process = BasicProcess<Time>;
+    using WorkloadIndex = BasicWorkloadIndex<Time>;
+
 private:
     int num_queues;
     int base_time_slice;
     
-    int getTimeSliceForQueue(int queue_level) {
+    Time getTimeSliceForQueue(int queue_level) {
         if (queue_level == num_queues - 1) {
-            return INT_MAX;
+            return numeric_limits<Time>::max();
         }
-        return base_time_slice * (1 << queue_level);
+        // Past what Time holds, a slice is as good as unbounded
+        long double slice = static_cast<long double>(base_time_slice) * (1LL << queue_level);
+        return static_cast<Time>(min<long double>(slice, numeric_limits<Time>::max()));
     }
     
 public:
-    MLFQ(int time_slice = 2, int num_of_queues = 3) : base_time_slice(time_slice), num_queues(num_of_queues) {}
+    // Everything the main loop carries from one step to the next; a copy is a checkpoint that
+    // simulate() can resume from (see Rescheduler.hpp)
+    struct State {
+        vector<Time> remaining_burst_time;
+        vector<bool> is_completed;
+        vector<int> queue_level;
+        vector<Time> time_in_current_slice;
+        Time current_time = 0;
+        int completed = 0;
+        int last_process_id = -1;
+
+        Time time() const {
+            return current_time;
+        }
+
+        // Keeps the first `kept` processes and starts the rest of `sorted` afresh
+        void rebase(const vector<Process>& sorted, size_t kept) {
+            remaining_burst_time.resize(kept);
+            is_completed.resize(kept);
+            queue_level.resize(kept);
+            time_in_current_slice.resize(kept);
+            for (size_t i = kept; i < sorted.size(); i++) {
+                remaining_burst_time.push_back(sorted[i].burst_time);
+                is_completed.push_back(false);
+                queue_level.push_back(0);
+                time_in_current_slice.push_back(0);
+            }
+        }
+    };
+
+    BasicMLFQ(int time_slice = 2, int num_of_queues = 3) : base_time_slice(time_slice), num_queues(num_of_queues) {}
     
     json schedule(const vector<Process>& processes) {
-        vector<json> gantt_chart;
-        vector<json> process_stats;
-        
-        vector<Process> sorted_processes = processes;
-        sort(sorted_processes.begin(), sorted_processes.end(), [](const Process& a, const Process& b) {
-            return a.arrival_time < b.arrival_time;
-        });
+        JsonTraceSink sink;
+        run(processes, sink);
+        return sink.result();
+    }
+
+    template <typename Sink>
+    void run(const vector<Process>& processes, Sink& sink) {
+        run(WorkloadIndex(processes), sink);
+    }
+
+    template <typename Sink>
+    void run(const WorkloadIndex& workload, Sink& sink) {
         
+        State state = start(workload, sink);
+        simulate(workload, state, sink, [](const State&) {});
+    }
+
+    // Sets up the state for the workload
+    template <typename Sink>
+    State start(const WorkloadIndex& workload, Sink& sink) {
+        const vector<Process>& sorted_processes = workload.sorted();
+        State state;
+        state.rebase(sorted_processes, 0);
+        return state;
+    }
+
+    // The main loop; on_step(state) runs before every step and may pause it (Stepping.hpp)
+    template <typename Sink, typename OnStep>
+    void simulate(const WorkloadIndex& workload, State& state, Sink& sink, OnStep&& on_step) {
+        const vector<Process>& sorted_processes = workload.sorted();
         int n = sorted_processes.size();
-        vector<int> remaining_burst_time(n);
-        vector<bool> is_completed(n, false);
-        vector<int> queue_level(n, 0); 
-        vector<int> time_in_current_slice(n, 0);
-        
-        for (int i = 0; i < n; i++) {
-            remaining_burst_time[i] = sorted_processes[i].burst_time;
-        }
-        
-        int current_time = 0;
-        int completed = 0;
-        int last_process_id = -1;
-        
+        vector<Time>& remaining_burst_time = state.remaining_burst_time;
+        vector<bool>& is_completed = state.is_completed;
+        vector<int>& queue_level = state.queue_level;
+        vector<Time>& time_in_current_slice = state.time_in_current_slice;
+        Time& current_time = state.current_time;
+        int& completed = state.completed;
+        int& last_process_id = state.last_process_id;
+
         while (completed < n) {
+            if (!Stepping::proceed(on_step, state)) {
+                return;
+            }
             int selected_index = -1;
             int highest_priority_queue = num_queues; 
             
-            for (int i = 0; i < n; i++) {
-                if (!is_completed[i] && sorted_processes[i].arrival_time <= current_time) {
+            for (int i = 0, arrived = workload.arrivedBy(current_time); i < arrived; i++) {
+                if (!is_completed[i]) {
                     if (queue_level[i] < highest_priority_queue) {
                         highest_priority_queue = queue_level[i];
                         selected_index = i;
@@ -65,62 +126,64 @@ public:
             
             if (selected_index == -1) {
                 if (last_process_id != -1) {
-                    gantt_chart.back()["end_time"] = current_time;
+                    sink.endSegment(current_time);
                 }
                 
-                json queue_status;
-                for (int q = 0; q < num_queues; q++) {
-                    queue_status[to_string(q)] = json::array();
-                }
-                
-                gantt_chart.push_back({
-                    {"process_id", -1},
-                    {"start_time", current_time},
-                    {"queue_level", -1},
-                    {"ready_queues", queue_status}
+                sink.beginSegment(-1, current_time, -1, [&](json& row) {
+                    json queue_status;
+                    for (int q = 0; q < num_queues; q++) {
+                        queue_status[to_string(q)] = json::array();
+                    }
+                    row["queue_level"] = -1;
+                    row["ready_queues"] = queue_status;
                 });
                 
                 last_process_id = -1;
-                current_time++;
+                // A row per idle unit over int32, as MLFQ has always reported; wider time types are for
+                // long traces, so there the row lasts until the next arrival
+                current_time += workload.stepFrom(current_time, is_same_v<Time, int> ? Time(1)
+                                                                                    : numeric_limits<Time>::max());
                 continue;
             }
             
             if (last_process_id != sorted_processes[selected_index].p_id) {
                 if (last_process_id != -1) {
-                    gantt_chart.back()["end_time"] = current_time;
+                    sink.endSegment(current_time);
                 }
                 
-                json queue_status;
-                for (int q = 0; q < num_queues; q++) {
-                    queue_status[to_string(q)] = json::array();
-                }
-                
-                for (int i = 0; i < n; i++) {
-                    if (!is_completed[i] && sorted_processes[i].arrival_time <= current_time && i != selected_index) {
-                        queue_status[to_string(queue_level[i])].push_back(sorted_processes[i].p_id);
+                int level = queue_level[selected_index];
+                sink.beginSegment(sorted_processes[selected_index].p_id, current_time, level, [&](json& row) {
+                    json queue_status;
+                    for (int q = 0; q < num_queues; q++) {
+                        queue_status[to_string(q)] = json::array();
                     }
-                }
-                
-                gantt_chart.push_back({
-                    {"process_id", sorted_processes[selected_index].p_id},
-                    {"start_time", current_time},
-                    {"queue_level", queue_level[selected_index]},
-                    {"ready_queues", queue_status}
+                    
+                    for (int i = 0; i < n; i++) {
+                        if (!is_completed[i] && sorted_processes[i].arrival_time <= current_time && i != selected_index) {
+                            queue_status[to_string(queue_level[i])].push_back(sorted_processes[i].p_id);
+                        }
+                    }
+                    row["queue_level"] = level;
+                    row["ready_queues"] = queue_status;
                 });
                 
                 last_process_id = sorted_processes[selected_index].p_id;
             }
             
-            remaining_burst_time[selected_index]--;
-            time_in_current_slice[selected_index]++;
-            current_time++;
+            Time current_time_slice = getTimeSliceForQueue(queue_level[selected_index]);
+            // Levels only change when a slice runs out, so the same process runs until then, its
+            // completion or the next arrival
+            Time step = workload.stepFrom(current_time, min(remaining_burst_time[selected_index],
+                                                            current_time_slice - time_in_current_slice[selected_index]));
+            remaining_burst_time[selected_index] -= step;
+            time_in_current_slice[selected_index] += step;
+            current_time += step;
             
-            int current_time_slice = getTimeSliceForQueue(queue_level[selected_index]);
             if (time_in_current_slice[selected_index] >= current_time_slice && queue_level[selected_index] < num_queues - 1) {
                 queue_level[selected_index]++;
                 time_in_current_slice[selected_index] = 0;
                 
-                gantt_chart.back()["end_time"] = current_time;
+                sink.endSegment(current_time);
                 last_process_id = -1;
             }
             
@@ -130,73 +193,44 @@ public:
                 
                 time_in_current_slice[selected_index] = 0;
                 
-                int completion_time = current_time;
-                int turnaround_time = completion_time - sorted_processes[selected_index].arrival_time;
-                int waiting_time = turnaround_time - sorted_processes[selected_index].burst_time;
+                sink.completeProcess(sorted_processes[selected_index], current_time, "final_queue_level",
+                                     queue_level[selected_index]);
                 
-                process_stats.push_back({
-                    {"process_id", sorted_processes[selected_index].p_id},
-                    {"arrival_time", sorted_processes[selected_index].arrival_time},
-                    {"burst_time", sorted_processes[selected_index].burst_time},
-                    {"priority", sorted_processes[selected_index].priority},
-                    {"completion_time", completion_time},
-                    {"turnaround_time", turnaround_time},
-                    {"waiting_time", waiting_time},
-                    {"final_queue_level", queue_level[selected_index]}
-                });
-                
-                gantt_chart.back()["end_time"] = current_time;
+                sink.endSegment(current_time);
                 last_process_id = -1;
             }
             
-            for (int i = 0; i < n; i++) {
-                if (sorted_processes[i].arrival_time == current_time) {
-                    if (last_process_id != -1) {
-                        gantt_chart.back()["end_time"] = current_time;
-                        
-                        int running_index = -1;
-                        for (int j = 0; j < n; j++) {
-                            if (sorted_processes[j].p_id == last_process_id) {
-                                running_index = j;
-                                break;
-                            }
+            // An arrival splits the running process's segment
+            pair<size_t, size_t> arriving = workload.arrivingAt(current_time);
+            if (arriving.first != arriving.second && last_process_id != -1) {
+                sink.endSegment(current_time);
+                
+                long running_index = workload.find(last_process_id);
+                if (running_index != -1) {
+                    int level = queue_level[running_index];
+                    sink.beginSegment(last_process_id, current_time, level, [&](json& row) {
+                        json queue_status;
+                        for (int q = 0; q < num_queues; q++) {
+                            queue_status[to_string(q)] = json::array();
                         }
                         
-                        if (running_index != -1) {
-                            json queue_status;
-                            for (int q = 0; q < num_queues; q++) {
-                                queue_status[to_string(q)] = json::array();
-                            }
-                            
-                            for (int j = 0; j < n; j++) {
-                                if (!is_completed[j] && sorted_processes[j].arrival_time <= current_time && 
-                                    sorted_processes[j].p_id != last_process_id) {
-                                    queue_status[to_string(queue_level[j])].push_back(sorted_processes[j].p_id);
-                                }
+                        for (int j = 0; j < n; j++) {
+                            if (!is_completed[j] && sorted_processes[j].arrival_time <= current_time && 
+                                sorted_processes[j].p_id != last_process_id) {
+                                queue_status[to_string(queue_level[j])].push_back(sorted_processes[j].p_id);
                             }
-                            
-                            gantt_chart.push_back({
-                                {"process_id", last_process_id},
-                                {"start_time", current_time},
-                                {"queue_level", queue_level[running_index]},
-                                {"ready_queues", queue_status}
-                            });
                         }
-                    }
-                    break;
+                        row["queue_level"] = level;
+                        row["ready_queues"] = queue_status;
+                    });
                 }
             }
         }
         
-        if (!gantt_chart.empty()) {
-            gantt_chart.back()["end_time"] = current_time;
-        }
-        
-        json result;
-        result["gantt_chart"] = gantt_chart;
-        result["process_stats"] = process_stats;
-        return result;
+        sink.endSegment(current_time);
     }
 };
 
+using MLFQ = BasicMLFQ<int>;
+
 #endif
\ No newline at end of file
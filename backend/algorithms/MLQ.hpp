@@ -6,14 +6,70 @@
 #include <queue>
 #include <deque>
 #include <climits>
+#include <limits>
+#include <stdexcept>
 #include "../Type.hpp"
 #include "../json.hpp"
+#include "../trace/JsonTraceSink.hpp"
+#include "../workload/WorkloadIndex.hpp"
+#include "Stepping.hpp"
 
 using namespace std;
 using json = nlohmann::json;
 
-class MLQ {
+template <typename Time>
+class BasicMLQ {
 public:
+    using Process = BasicProcess<Time>;
+    using WorkloadIndex = BasicWorkloadIndex<Time>;
+
+private:
+    static void idle(json& row) {
+        row["queues"] = json::array();
+        row["queue_level"] = -1;  // Indicate no queue is running
+    }
+
+public:
+    // Everything the main loop carries from one step to the next; a copy is a checkpoint that
+    // simulate() can resume from (see Rescheduler.hpp)
+    struct State {
+        int num_queues = 3;
+        vector<Time> time_quanta;
+        vector<deque<int>> queues;
+        vector<Time> remaining_burst_time;
+        vector<bool> is_completed;
+        vector<Time> completion_time;
+        vector<int> queue_assignment; // Which queue each process is assigned to
+        Time current_time = 0;
+        int completed = 0;
+        int current_process_id = -1;
+        int last_process_id = -1;
+        Time time_in_current_process = 0;
+        // Processes [0, admitted) have been put in their queues; arrivals are admitted in order
+        size_t admitted = 0;
+
+        Time time() const {
+            return current_time;
+        }
+
+        // Keeps the first `kept` processes and starts the rest of `sorted` afresh
+        void rebase(const vector<Process>& sorted, size_t kept) {
+            admitted = min(admitted, kept);
+            remaining_burst_time.resize(kept);
+            is_completed.resize(kept);
+            completion_time.resize(kept);
+            queue_assignment.resize(kept);
+            for (size_t i = kept; i < sorted.size(); i++) {
+                remaining_burst_time.push_back(sorted[i].burst_time);
+                is_completed.push_back(false);
+                completion_time.push_back(0);
+                // Assign processes to queues based on priority, mod the number of queues as
+                // Levels::level does, so negative priorities land in a queue too
+                queue_assignment.push_back((sorted[i].priority % num_queues + num_queues) % num_queues);
+            }
+        }
+    };
+
     json schedule(const vector<Process>& processes, int num_queues, int base_quantum) {
         // Validate input
         if (num_queues <= 0 || base_quantum <= 0) {
@@ -23,72 +79,87 @@ public:
             });
         }
 
-        // Create the result JSON
-        json result;
-        vector<json> gantt_chart;
-        vector<json> process_stats;
+        JsonTraceSink sink;
+        run(processes, num_queues, base_quantum, sink);
+        return sink.result();
+    }
 
-        // Sort processes by arrival time
-        vector<Process> sorted_processes = processes;
-        sort(sorted_processes.begin(), sorted_processes.end(), [](const Process& a, const Process& b) {
-            return a.arrival_time < b.arrival_time;
-        });
+    template <typename Sink>
+    void run(const vector<Process>& processes, int num_queues, int base_quantum, Sink& sink) {
+        run(WorkloadIndex(processes), num_queues, base_quantum, sink);
+    }
 
-        int n = sorted_processes.size();
-        if (n == 0) {
-            result["gantt_chart"] = gantt_chart;
-            result["process_stats"] = process_stats;
-            return result;
+    template <typename Sink>
+    void run(const WorkloadIndex& workload, int num_queues, int base_quantum, Sink& sink) {
+        if (num_queues <= 0 || base_quantum <= 0) {
+            throw invalid_argument("Invalid number of queues or base quantum");
         }
 
+        if (workload.empty()) {
+            return;
+        }
+
+        State state = start(workload, num_queues, base_quantum, sink);
+        simulate(workload, state, sink, [](const State&) {});
+    }
+
+    // Sets up the state for the workload, writing the leading idle segment if any
+    template <typename Sink>
+    State start(const WorkloadIndex& workload, int num_queues, int base_quantum, Sink& sink) {
+        const vector<Process>& sorted_processes = workload.sorted();
+        State state;
+        state.num_queues = num_queues;
+
         // Create queues for the MLQ
-        vector<deque<int>> queues(num_queues);
-        vector<int> time_quanta(num_queues);
+        state.queues.resize(num_queues);
+        state.time_quanta.resize(num_queues);
         
         // Set the time quantum for each queue
         for (int i = 0; i < num_queues; i++) {
-            time_quanta[i] = base_quantum * (1 << i); // Double the quantum for each subsequent queue
+            // Double the quantum for each subsequent queue, up to the largest Time
+            long double quantum = static_cast<long double>(base_quantum) * (1LL << i);
+            state.time_quanta[i] = static_cast<Time>(min<long double>(quantum, numeric_limits<Time>::max()));
         }
 
         // Initialize process tracking variables
-        vector<int> remaining_burst_time(n);
-        vector<bool> is_completed(n, false);
-        vector<int> completion_time(n, 0);
-        vector<int> queue_assignment(n, 0); // Which queue each process is assigned to
-        
-        for (int i = 0; i < n; i++) {
-            remaining_burst_time[i] = sorted_processes[i].burst_time;
-            // Assign processes to queues based on priority (if available)
-            queue_assignment[i] = min(sorted_processes[i].priority % num_queues, num_queues - 1);
-        }
-
-        int current_time = 0;
-        int completed = 0;
-        int current_process_id = -1;
-        int last_process_id = -1;
-        int time_in_current_process = 0;
+        state.rebase(sorted_processes, 0);
 
         // Start with an idle slot if no process arrives at time 0
         if (sorted_processes[0].arrival_time > 0) {
-            json idle_slot = {
-                {"process_id", -1},
-                {"start_time", 0},
-                {"end_time", sorted_processes[0].arrival_time},
-                {"queues", json::array()},
-                {"queue_level", -1}  // Indicate no queue is running
-            };
-            gantt_chart.push_back(idle_slot);
-            current_time = sorted_processes[0].arrival_time;
+            sink.beginSegment(-1, Time(0), -1, idle);
+            sink.endSegment(sorted_processes[0].arrival_time);
+            state.current_time = sorted_processes[0].arrival_time;
         }
+        return state;
+    }
+
+    // The main loop; on_step(state) runs before every step and may pause it (Stepping.hpp)
+    template <typename Sink, typename OnStep>
+    void simulate(const WorkloadIndex& workload, State& state, Sink& sink, OnStep&& on_step) {
+        const vector<Process>& sorted_processes = workload.sorted();
+        int n = sorted_processes.size();
+        int num_queues = state.num_queues;
+        const vector<Time>& time_quanta = state.time_quanta;
+        vector<deque<int>>& queues = state.queues;
+        vector<Time>& remaining_burst_time = state.remaining_burst_time;
+        vector<bool>& is_completed = state.is_completed;
+        vector<Time>& completion_time = state.completion_time;
+        const vector<int>& queue_assignment = state.queue_assignment;
+        Time& current_time = state.current_time;
+        int& completed = state.completed;
+        int& current_process_id = state.current_process_id;
+        int& last_process_id = state.last_process_id;
+        Time& time_in_current_process = state.time_in_current_process;
+        size_t& admitted = state.admitted;
 
         // Main scheduling loop
         while (completed < n) {
+            if (!Stepping::proceed(on_step, state)) {
+                return;
+            }
             // Check for new arrivals and add them to appropriate queues
-            for (int i = 0; i < n; i++) {
-                if (!is_completed[i] && sorted_processes[i].arrival_time <= current_time && 
-                    find(queues[queue_assignment[i]].begin(), queues[queue_assignment[i]].end(), i) == queues[queue_assignment[i]].end()) {
-                    queues[queue_assignment[i]].push_back(i);
-                }
+            for (size_t arrived = workload.arrivedBy(current_time); admitted < arrived; admitted++) {
+                queues[queue_assignment[admitted]].push_back(admitted);
             }
 
             // Find the highest priority non-empty queue
@@ -103,32 +174,19 @@ public:
             // If all queues are empty but not all processes have arrived
             if (active_queue == -1) {
                 // Find the next arriving process
-                int next_arrival_time = INT_MAX;
-                for (int i = 0; i < n; i++) {
-                    if (!is_completed[i] && sorted_processes[i].arrival_time > current_time &&
-                        sorted_processes[i].arrival_time < next_arrival_time) {
-                        next_arrival_time = sorted_processes[i].arrival_time;
-                    }
-                }
-
-                if (next_arrival_time == INT_MAX) {
+                if (admitted == sorted_processes.size()) {
                     // All processes have completed
                     break;
                 }
+                Time next_arrival_time = sorted_processes[admitted].arrival_time;
 
                 // Add idle slot to gantt chart
                 if (last_process_id != -1) {
-                    gantt_chart.back()["end_time"] = current_time;
+                    sink.endSegment(current_time);
                 }
 
-                json idle_slot = {
-                    {"process_id", -1},
-                    {"start_time", current_time},
-                    {"end_time", next_arrival_time},
-                    {"queues", json::array()},
-                    {"queue_level", -1}  // Indicate no queue is running
-                };
-                gantt_chart.push_back(idle_slot);
+                sink.beginSegment(-1, current_time, -1, idle);
+                sink.endSegment(next_arrival_time);
                 current_time = next_arrival_time;
                 last_process_id = -1;
                 continue;
@@ -142,34 +200,30 @@ public:
             // If this is a different process from the previous one, start a new gantt chart entry
             if (current_process_id != last_process_id) {
                 if (last_process_id != -1) {
-                    gantt_chart.back()["end_time"] = current_time;
+                    sink.endSegment(current_time);
                 }
 
-                // Create a snapshot of all queues for the gantt chart
-                json queues_snapshot = json::array();
-                for (int i = 0; i < num_queues; i++) {
-                    json queue_snapshot = json::array();
-                    for (int process_idx : queues[i]) {
-                        queue_snapshot.push_back(sorted_processes[process_idx].p_id);
+                sink.beginSegment(current_process_id, current_time, active_queue, [&](json& row) {
+                    // Create a snapshot of all queues for the gantt chart
+                    json queues_snapshot = json::array();
+                    for (int i = 0; i < num_queues; i++) {
+                        json queue_snapshot = json::array();
+                        for (int process_idx : queues[i]) {
+                            queue_snapshot.push_back(sorted_processes[process_idx].p_id);
+                        }
+                        queues_snapshot.push_back(queue_snapshot);
                     }
-                    queues_snapshot.push_back(queue_snapshot);
-                }
-
-                json new_segment = {
-                    {"process_id", current_process_id},
-                    {"start_time", current_time},
-                    {"queues", queues_snapshot},
-                    {"queue_level", active_queue}  // Add the current queue level
-                };
-                gantt_chart.push_back(new_segment);
+                    row["queues"] = queues_snapshot;
+                    row["queue_level"] = active_queue;  // Add the current queue level
+                });
                 time_in_current_process = 0;
             }
 
             last_process_id = current_process_id;
 
             // Execute the process for the quantum or until completion
-            int quantum = time_quanta[active_queue];
-            int execution_time = min(quantum, remaining_burst_time[process_index]);
+            Time quantum = time_quanta[active_queue];
+            Time execution_time = min(quantum, remaining_burst_time[process_index]);
             current_time += execution_time;
             remaining_burst_time[process_index] -= execution_time;
             time_in_current_process += execution_time;
@@ -179,22 +233,7 @@ public:
                 is_completed[process_index] = true;
                 completed++;
                 completion_time[process_index] = current_time;
-
-                // Calculate process stats
-                int turnaround_time = completion_time[process_index] - sorted_processes[process_index].arrival_time;
-                int waiting_time = turnaround_time - sorted_processes[process_index].burst_time;
-
-                json stats = {
-                    {"process_id", sorted_processes[process_index].p_id},
-                    {"arrival_time", sorted_processes[process_index].arrival_time},
-                    {"burst_time", sorted_processes[process_index].burst_time},
-                    {"priority", sorted_processes[process_index].priority},
-                    {"completion_time", completion_time[process_index]},
-                    {"turnaround_time", turnaround_time},
-                    {"waiting_time", waiting_time},
-                    {"queue", active_queue}
-                };
-                process_stats.push_back(stats);
+                sink.completeProcess(sorted_processes[process_index], current_time, "queue", active_queue);
             }
             // If the process still has remaining time, put it back in its queue
             else if (remaining_burst_time[process_index] > 0) {
@@ -202,15 +241,10 @@ public:
             }
 
             // Check for any process that might have arrived during this execution
-            bool new_arrival = false;
-            for (int i = 0; i < n; i++) {
-                if (!is_completed[i] && sorted_processes[i].arrival_time > current_time - execution_time &&
-                    sorted_processes[i].arrival_time <= current_time) {
-                    new_arrival = true;
-                    if (find(queues[queue_assignment[i]].begin(), queues[queue_assignment[i]].end(), i) == queues[queue_assignment[i]].end()) {
-                        queues[queue_assignment[i]].push_back(i);
-                    }
-                }
+            size_t arrived = workload.arrivedBy(current_time);
+            bool new_arrival = admitted < arrived;
+            for (; admitted < arrived; admitted++) {
+                queues[queue_assignment[admitted]].push_back(admitted);
             }
 
             // If there's a new arrival and its queue has higher priority, preempt current process
@@ -226,21 +260,17 @@ public:
                 
                 if (higher_priority_arrival) {
                     // End the current segment and start a new one
-                    gantt_chart.back()["end_time"] = current_time;
+                    sink.endSegment(current_time);
                     last_process_id = -1;  // Force creation of a new segment
                 }
             }
         }
 
         // Complete the last gantt chart entry
-        if (!gantt_chart.empty() && !gantt_chart.back().contains("end_time")) {
-            gantt_chart.back()["end_time"] = current_time;
-        }
-
-        result["gantt_chart"] = gantt_chart;
-        result["process_stats"] = process_stats;
-        return result;
+        sink.closeSegment(current_time);
     }
 };
 
+using MLQ = BasicMLQ<int>;
+
 #endif
\ No newline at end of file
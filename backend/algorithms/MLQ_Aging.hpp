@@ -5,18 +5,83 @@
 #include <algorithm>
 #include <queue>
 #include <deque>
-#include <climits>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
 #include "../Type.hpp"
 #include "../json.hpp"
+#include "../trace/JsonTraceSink.hpp"
+#include "../workload/WorkloadIndex.hpp"
+#include "Stepping.hpp"
 
 using namespace std;
 using json = nlohmann::json;
 
-class MLQAging {
+template <typename Time>
+class BasicMLQAging {
+public:
+    using Process = BasicProcess<Time>;
+    using WorkloadIndex = BasicWorkloadIndex<Time>;
+
 private:
     const int AGING_THRESHOLD = 50;
 
+    // How far runtime is into its current quantum
+    static Time intoSlice(Time runtime, Time time_slice) {
+        if constexpr (is_floating_point_v<Time>) {
+            return fmod(runtime, time_slice);
+        } else {
+            return runtime % time_slice;
+        }
+    }
+
 public:
+    // Everything the main loop carries from one step to the next; a copy is a checkpoint that
+    // simulate() can resume from (see Rescheduler.hpp)
+    struct State {
+        int num_queues = 3;
+        vector<Time> time_quanta;
+        vector<deque<int>> queues;
+        vector<Time> remaining_burst_time;
+        vector<bool> is_completed;
+        vector<Time> completion_time;
+        vector<int> queue_assignment;
+        vector<Time> waiting_since;
+        vector<Time> total_wait_time;
+        Time current_time = 0;
+        int completed = 0;
+        int current_process_index = -1;
+        bool need_new_gantt_entry = true;
+
+        // The newest Gantt row, which the segment decisions below look back at
+        bool has_segment = false;
+        int segment_process_id = -1;
+        int segment_level = -1;
+
+        Time time() const {
+            return current_time;
+        }
+
+        // Keeps the first `kept` processes and starts the rest of `sorted` afresh
+        void rebase(const vector<Process>& sorted, size_t kept) {
+            remaining_burst_time.resize(kept);
+            is_completed.resize(kept);
+            completion_time.resize(kept);
+            queue_assignment.resize(kept);
+            waiting_since.resize(kept);
+            total_wait_time.resize(kept);
+            for (size_t i = kept; i < sorted.size(); i++) {
+                remaining_burst_time.push_back(sorted[i].burst_time);
+                is_completed.push_back(false);
+                completion_time.push_back(0);
+                // Negative priorities go to the top queue, those past the last to the last
+                queue_assignment.push_back(max(0, min(sorted[i].priority, num_queues - 1)));
+                waiting_since.push_back(sorted[i].arrival_time);
+                total_wait_time.push_back(0);
+            }
+        }
+    };
+
     json schedule(const vector<Process>& processes, int num_queues, int base_quantum) {
         if (num_queues <= 0 || base_quantum <= 0) {
             return json({
@@ -24,48 +89,95 @@ public:
                 {"message", "Invalid number of queues or base quantum"}
             });
         }
-        json result;
-        vector<json> gantt_chart;
-        vector<json> process_stats;
+        JsonTraceSink sink;
+        run(processes, num_queues, base_quantum, sink);
+        return sink.result();
+    }
 
-        vector<Process> sorted_processes = processes;
-        sort(sorted_processes.begin(), sorted_processes.end(), [](const Process& a, const Process& b) {
-            return a.arrival_time < b.arrival_time;
-        });
+    template <typename Sink>
+    void run(const vector<Process>& processes, int num_queues, int base_quantum, Sink& sink) {
+        run(WorkloadIndex(processes), num_queues, base_quantum, sink);
+    }
 
-        int n = sorted_processes.size();
-        if (n == 0) {
-            result["gantt_chart"] = gantt_chart;
-            result["process_stats"] = process_stats;
-            return result;
+    template <typename Sink>
+    void run(const WorkloadIndex& workload, int num_queues, int base_quantum, Sink& sink) {
+        if (num_queues <= 0 || base_quantum <= 0) {
+            throw invalid_argument("Invalid number of queues or base quantum");
         }
 
-        vector<deque<int>> queues(num_queues);
-        vector<int> time_quanta(num_queues);
-        
-        for (int i = 0; i < num_queues; i++) {
-            time_quanta[i] = base_quantum * (1 << i);
+        if (workload.empty()) {
+            return;
         }
 
-        vector<int> remaining_burst_time(n);
-        vector<bool> is_completed(n, false);
-        vector<int> completion_time(n, 0);
-        vector<int> queue_assignment(n);
-        vector<int> waiting_since(n, 0);
-        vector<int> total_wait_time(n, 0);
+        State state = start(workload, num_queues, base_quantum, sink);
+        simulate(workload, state, sink, [](const State&) {});
+    }
+
+    // Sets up the state for the workload
+    template <typename Sink>
+    State start(const WorkloadIndex& workload, int num_queues, int base_quantum, Sink& sink) {
+        const vector<Process>& sorted_processes = workload.sorted();
+        State state;
+        state.num_queues = num_queues;
+        state.queues.resize(num_queues);
+        state.time_quanta.resize(num_queues);
         
-        for (int i = 0; i < n; i++) {
-            remaining_burst_time[i] = sorted_processes[i].burst_time;
-            queue_assignment[i] = min(sorted_processes[i].priority, num_queues - 1);
-            waiting_since[i] = sorted_processes[i].arrival_time;
+        for (int i = 0; i < num_queues; i++) {
+            long double quantum = static_cast<long double>(base_quantum) * (1LL << i);
+            state.time_quanta[i] = static_cast<Time>(min<long double>(quantum, numeric_limits<Time>::max()));
         }
 
-        int current_time = 0;
-        int completed = 0;
-        int current_process_index = -1;
-        bool need_new_gantt_entry = true;
+        state.rebase(sorted_processes, 0);
+        return state;
+    }
+
+    // The main loop; on_step(state) runs before every step and may pause it (Stepping.hpp)
+    template <typename Sink, typename OnStep>
+    void simulate(const WorkloadIndex& workload, State& state, Sink& sink, OnStep&& on_step) {
+        const vector<Process>& sorted_processes = workload.sorted();
+        int n = sorted_processes.size();
+        int num_queues = state.num_queues;
+        const vector<Time>& time_quanta = state.time_quanta;
+        vector<deque<int>>& queues = state.queues;
+        vector<Time>& remaining_burst_time = state.remaining_burst_time;
+        vector<bool>& is_completed = state.is_completed;
+        vector<Time>& completion_time = state.completion_time;
+        vector<int>& queue_assignment = state.queue_assignment;
+        vector<Time>& waiting_since = state.waiting_since;
+        vector<Time>& total_wait_time = state.total_wait_time;
+        Time& current_time = state.current_time;
+        int& completed = state.completed;
+        int& current_process_index = state.current_process_index;
+        bool& need_new_gantt_entry = state.need_new_gantt_entry;
+        bool& has_segment = state.has_segment;
+        int& segment_process_id = state.segment_process_id;
+        int& segment_level = state.segment_level;
+
+        auto snapshot = [&](int level) {
+            return [&, level](json& row) {
+                json queues_snapshot = json::array();
+                for (int i = 0; i < num_queues; i++) {
+                    json queue_snapshot = json::array();
+                    for (int idx : queues[i]) {
+                        queue_snapshot.push_back(sorted_processes[idx].p_id);
+                    }
+                    queues_snapshot.push_back(queue_snapshot);
+                }
+                row["queues"] = queues_snapshot;
+                row["queue_level"] = level;
+            };
+        };
+        auto begin = [&](int process_id, int level) {
+            sink.beginSegment(process_id, current_time, level, snapshot(level));
+            has_segment = true;
+            segment_process_id = process_id;
+            segment_level = level;
+        };
 
         while (completed < n) {
+            if (!Stepping::proceed(on_step, state)) {
+                return;
+            }
             bool queue_changed = false;
             
             for (int i = 0; i < n; i++) {
@@ -79,7 +191,7 @@ public:
                 vector<int> to_promote;
                 for (auto it = queues[q].begin(); it != queues[q].end(); ++it) {
                     int i = *it;
-                    int wait_time = current_time - waiting_since[i];
+                    Time wait_time = current_time - waiting_since[i];
                     if (wait_time >= AGING_THRESHOLD) {
                         to_promote.push_back(i);
                         queue_changed = true;
@@ -94,8 +206,8 @@ public:
                 }
             }
 
-            if (queue_changed && !gantt_chart.empty()) {
-                gantt_chart.back()["end_time"] = current_time;
+            if (queue_changed && has_segment) {
+                sink.endSegment(current_time);
                 need_new_gantt_entry = true;
             }
 
@@ -108,38 +220,20 @@ public:
             }
 
             if (active_queue == -1) {
-                if (need_new_gantt_entry || gantt_chart.empty() || gantt_chart.back()["process_id"] != -1) {
-                    if (!gantt_chart.empty()) {
-                        gantt_chart.back()["end_time"] = current_time;
-                    }
-
-                    json queues_snapshot = json::array();
-                    for (int i = 0; i < num_queues; i++) {
-                        json queue_snapshot = json::array();
-                        for (int idx : queues[i]) {
-                            queue_snapshot.push_back(sorted_processes[idx].p_id);
-                        }
-                        queues_snapshot.push_back(queue_snapshot);
-                    }
-
-                    json idle_segment = {
-                        {"process_id", -1},
-                        {"start_time", current_time},
-                        {"queues", queues_snapshot},
-                        {"queue_level", -1}
-                    };
-                    gantt_chart.push_back(idle_segment);
+                if (need_new_gantt_entry || !has_segment || segment_process_id != -1) {
+                    sink.endSegment(current_time);
+                    begin(-1, -1);
                     need_new_gantt_entry = false;
                 }
 
-                int next_arrival = INT_MAX;
+                Time next_arrival = numeric_limits<Time>::max();
                 for (int i = 0; i < n; i++) {
                     if (!is_completed[i] && sorted_processes[i].arrival_time > current_time) {
                         next_arrival = min(next_arrival, sorted_processes[i].arrival_time);
                     }
                 }
 
-                if (next_arrival == INT_MAX) {
+                if (next_arrival == numeric_limits<Time>::max()) {
                     break;
                 }
 
@@ -150,41 +244,28 @@ public:
             int process_index = queues[active_queue].front();
             queues[active_queue].pop_front();
             
-            if (need_new_gantt_entry || current_process_index != process_index || gantt_chart.empty() || 
-                gantt_chart.back()["process_id"] != sorted_processes[process_index].p_id || 
-                gantt_chart.back()["queue_level"] != active_queue) {
+            if (need_new_gantt_entry || current_process_index != process_index || !has_segment || 
+                segment_process_id != sorted_processes[process_index].p_id || 
+                segment_level != active_queue) {
                 
-                if (!gantt_chart.empty()) {
-                    gantt_chart.back()["end_time"] = current_time;
-                }
-
-                json queues_snapshot = json::array();
-                for (int i = 0; i < num_queues; i++) {
-                    json queue_snapshot = json::array();
-                    for (int idx : queues[i]) {
-                        queue_snapshot.push_back(sorted_processes[idx].p_id);
-                    }
-                    queues_snapshot.push_back(queue_snapshot);
-                }
-
-                json new_segment = {
-                    {"process_id", sorted_processes[process_index].p_id},
-                    {"start_time", current_time},
-                    {"queues", queues_snapshot},
-                    {"queue_level", active_queue}
-                };
-                gantt_chart.push_back(new_segment);
+                sink.endSegment(current_time);
+                begin(sorted_processes[process_index].p_id, active_queue);
                 need_new_gantt_entry = false;
             }
 
             current_process_index = process_index;
 
-            current_time++;
-            remaining_burst_time[process_index]--;
+            // A unit, or up to the next arrival or the end of the quantum if either comes sooner
+            Time time_slice = time_quanta[active_queue];
+            Time runtime = sorted_processes[process_index].burst_time - remaining_burst_time[process_index];
+            Time step = workload.stepFrom(current_time, min({Time(1), remaining_burst_time[process_index],
+                                                             time_slice - intoSlice(runtime, time_slice)}));
+            current_time += step;
+            remaining_burst_time[process_index] -= step;
 
             for (int i = 0; i < n; i++) {
                 if (!is_completed[i] && i != process_index && sorted_processes[i].arrival_time < current_time) {
-                    total_wait_time[i]++;
+                    total_wait_time[i] += step;
                 }
             }
 
@@ -192,27 +273,13 @@ public:
                 is_completed[process_index] = true;
                 completed++;
                 completion_time[process_index] = current_time;
-
-                int turnaround_time = completion_time[process_index] - sorted_processes[process_index].arrival_time;
-                int waiting_time = turnaround_time - sorted_processes[process_index].burst_time;
-
-                json stats = {
-                    {"process_id", sorted_processes[process_index].p_id},
-                    {"arrival_time", sorted_processes[process_index].arrival_time},
-                    {"burst_time", sorted_processes[process_index].burst_time},
-                    {"priority", sorted_processes[process_index].priority},
-                    {"completion_time", completion_time[process_index]},
-                    {"turnaround_time", turnaround_time},
-                    {"waiting_time", waiting_time},
-                    {"final_queue", queue_assignment[process_index]}
-                };
-                process_stats.push_back(stats);
+                sink.completeProcess(sorted_processes[process_index], current_time, "final_queue",
+                                     queue_assignment[process_index]);
                 need_new_gantt_entry = true;
             } else {
-                int time_slice = time_quanta[active_queue];
-                int process_runtime = sorted_processes[process_index].burst_time - remaining_burst_time[process_index];
+                Time process_runtime = sorted_processes[process_index].burst_time - remaining_burst_time[process_index];
                 
-                if (process_runtime % time_slice == 0) {
+                if (intoSlice(process_runtime, time_slice) == 0) {
                     queues[active_queue].push_back(process_index);
                     waiting_since[process_index] = current_time;
                     need_new_gantt_entry = true;
@@ -242,14 +309,10 @@ public:
             }
         }
 
-        if (!gantt_chart.empty() && !gantt_chart.back().contains("end_time")) {
-            gantt_chart.back()["end_time"] = current_time;
-        }
-
-        result["gantt_chart"] = gantt_chart;
-        result["process_stats"] = process_stats;
-        return result;
+        sink.closeSegment(current_time);
     }
 };
 
+using MLQAging = BasicMLQAging<int>;
+
 #endif
\ No newline at end of file
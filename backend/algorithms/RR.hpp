@@ -4,62 +4,123 @@
 #include <algorithm>
 #include <vector>
 #include <queue>
+#include <climits>
+#include <limits>
 #include <string>
 #include "../json.hpp"
 #include "../Type.hpp"
+#include "../trace/JsonTraceSink.hpp"
+#include "../workload/WorkloadIndex.hpp"
+#include "Stepping.hpp"
 
 using namespace std;
 
-class RR {
+template <typename Time>
+class BasicRR {
 public:
-    nlohmann::json schedule(const vector<Process>& processes, int time_slice) {
-        vector<Process> sorted = processes;
-        sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b) {
-            return a.arrival_time < b.arrival_time;
-        });
+    using Process = BasicProcess<Time>;
+    using WorkloadIndex = BasicWorkloadIndex<Time>;
 
-        nlohmann::json result;
-        nlohmann::json gantt_chart = nlohmann::json::array();
-        nlohmann::json process_stats = nlohmann::json::array();
-        
-        if (sorted.empty()) {
-            return result;
-        }
+private:
+    static void idle(nlohmann::json& row) {
+        row["ready_queue"] = nlohmann::json::array();
+    }
 
-        int n = sorted.size();
-        int current_time = 0;
-        
-        vector<int> remaining_time(n);
-        for (int i = 0; i < n; i++) {
-            remaining_time[i] = sorted[i].burst_time;
-        }
-        
-        vector<bool> completed(n, false);
-        vector<int> completion_time(n, 0);
+public:
+    // Everything the main loop carries from one step to the next; a copy is a checkpoint that
+    // simulate() can resume from (see Rescheduler.hpp)
+    struct State {
+        Time time_slice = 1;
+        Time current_time = 0;
+        vector<Time> remaining_time;
+        vector<bool> completed;
+        vector<Time> completion_time;
         int completed_count = 0;
-        
         queue<int> ready_queue;
-        int current_process_index = -1;
-        
+
+        Time time() const {
+            return current_time;
+        }
+
+        // Keeps the first `kept` processes and starts the rest of `sorted` afresh
+        void rebase(const vector<Process>& sorted, size_t kept) {
+            remaining_time.resize(kept);
+            completed.resize(kept);
+            completion_time.resize(kept);
+            for (size_t i = kept; i < sorted.size(); i++) {
+                remaining_time.push_back(sorted[i].burst_time);
+                completed.push_back(false);
+                completion_time.push_back(0);
+            }
+        }
+    };
+
+    nlohmann::json schedule(const vector<Process>& processes, Time time_slice) {
+        if (processes.empty()) {
+            return nlohmann::json();
+        }
+        JsonTraceSink sink;
+        run(processes, time_slice, sink);
+        return sink.result();
+    }
+
+    template <typename Sink>
+    void run(const vector<Process>& processes, Time time_slice, Sink& sink) {
+        run(WorkloadIndex(processes), time_slice, sink);
+    }
+
+    template <typename Sink>
+    void run(const WorkloadIndex& workload, Time time_slice, Sink& sink) {
+        if (workload.empty()) {
+            return;
+        }
+
+        State state = start(workload, time_slice, sink);
+        simulate(workload, state, sink, [](const State&) {});
+    }
+
+    // Sets up the state for the workload, writing the leading idle segment if any
+    template <typename Sink>
+    State start(const WorkloadIndex& workload, Time time_slice, Sink& sink) {
+        const vector<Process>& sorted = workload.sorted();
+        State state;
+        state.time_slice = time_slice;
+        state.rebase(sorted, 0);
+
         if (sorted[0].arrival_time > 0) {
-            nlohmann::json idle_row;
-            idle_row["process_id"] = -1; 
-            idle_row["start_time"] = 0;
-            idle_row["end_time"] = sorted[0].arrival_time;
-            idle_row["ready_queue"] = nlohmann::json::array();
-            gantt_chart.push_back(idle_row);
-            current_time = sorted[0].arrival_time;
+            sink.beginSegment(-1, Time(0), -1, idle);
+            sink.endSegment(sorted[0].arrival_time);
+            state.current_time = sorted[0].arrival_time;
         }
         
-        for (int i = 0; i < n; i++) {
-            if (sorted[i].arrival_time <= current_time) {
-                ready_queue.push(i);
+        for (size_t i = 0; i < sorted.size(); i++) {
+            if (sorted[i].arrival_time <= state.current_time) {
+                state.ready_queue.push(i);
             }
         }
+        return state;
+    }
+
+    // The main loop; on_step(state) runs before every step and may pause it (Stepping.hpp)
+    template <typename Sink, typename OnStep>
+    void simulate(const WorkloadIndex& workload, State& state, Sink& sink, OnStep&& on_step) {
+        const vector<Process>& sorted = workload.sorted();
+        int n = sorted.size();
+        Time time_slice = state.time_slice;
+        Time& current_time = state.current_time;
+        vector<Time>& remaining_time = state.remaining_time;
+        vector<bool>& completed = state.completed;
+        vector<Time>& completion_time = state.completion_time;
+        int& completed_count = state.completed_count;
+        queue<int>& ready_queue = state.ready_queue;
+        int current_process_index = -1;
         
         while (completed_count < n) {
+            if (!Stepping::proceed(on_step, state)) {
+                return;
+            }
             if (ready_queue.empty()) {
-                int next_arrival_time = INT_MAX;
+                Time next_arrival_time = numeric_limits<Time>::max();
                 for (int i = 0; i < n; i++) {
                     if (!completed[i] && sorted[i].arrival_time > current_time && 
                         sorted[i].arrival_time < next_arrival_time) {
@@ -67,13 +128,9 @@ public:
                     }
                 }
                 
-                if (next_arrival_time != INT_MAX) {
-                    nlohmann::json idle_row;
-                    idle_row["process_id"] = -1;
-                    idle_row["start_time"] = current_time;
-                    idle_row["end_time"] = next_arrival_time;
-                    idle_row["ready_queue"] = nlohmann::json::array();
-                    gantt_chart.push_back(idle_row);
+                if (next_arrival_time != numeric_limits<Time>::max()) {
+                    sink.beginSegment(-1, current_time, -1, idle);
+                    sink.endSegment(next_arrival_time);
                     
                     current_time = next_arrival_time;
                     
@@ -89,11 +146,11 @@ public:
                 current_process_index = ready_queue.front();
                 ready_queue.pop();
                 
-                int execute_time = min(time_slice, remaining_time[current_process_index]);
-                int start_time = current_time;
-                int end_time = current_time + execute_time;
+                Time execute_time = min(time_slice, remaining_time[current_process_index]);
+                Time start_time = current_time;
+                Time end_time = current_time + execute_time;
                 
-                vector<int> arrival_points;
+                vector<Time> arrival_points;
                 arrival_points.push_back(start_time);
                 
                 for (int i = 0; i < n; i++) {
@@ -111,24 +168,21 @@ public:
                                    arrival_points.end());
                 
                 for (size_t i = 0; i < arrival_points.size() - 1; i++) {
-                    int segment_start = arrival_points[i];
-                    int segment_end = arrival_points[i + 1];
-                    
-                    vector<int> current_ready_queue;
+                    Time segment_start = arrival_points[i];
+                    Time segment_end = arrival_points[i + 1];
                     
-                    queue<int> temp_queue = ready_queue;
-                    while (!temp_queue.empty()) {
-                        int proc_idx = temp_queue.front();
-                        temp_queue.pop();
-                        current_ready_queue.push_back(sorted[proc_idx].p_id);
-                    }
-                    
-                    nlohmann::json gantt_row;
-                    gantt_row["process_id"] = sorted[current_process_index].p_id;
-                    gantt_row["start_time"] = segment_start;
-                    gantt_row["end_time"] = segment_end;
-                    gantt_row["ready_queue"] = current_ready_queue;
-                    gantt_chart.push_back(gantt_row);
+                    sink.beginSegment(sorted[current_process_index].p_id, segment_start, 0, [&](nlohmann::json& row) {
+                        vector<int> current_ready_queue;
+                        
+                        queue<int> temp_queue = ready_queue;
+                        while (!temp_queue.empty()) {
+                            int proc_idx = temp_queue.front();
+                            temp_queue.pop();
+                            current_ready_queue.push_back(sorted[proc_idx].p_id);
+                        }
+                        row["ready_queue"] = current_ready_queue;
+                    });
+                    sink.endSegment(segment_end);
                     
                     for (int j = 0; j < n; j++) {
                         if (!completed[j] && sorted[j].arrival_time == segment_end) {
@@ -147,38 +201,15 @@ public:
                 } else {
                     ready_queue.push(current_process_index);
                 }
-                
-                for (int i = 0; i < n; i++) {
-                    if (!completed[i] && 
-                        sorted[i].arrival_time > start_time && 
-                        sorted[i].arrival_time <= current_time &&
-                        i != current_process_index) {
-                    }
-                }
             }
         }
         
         for (int i = 0; i < n; i++) {
-            int comp_time = completion_time[i];
-            int turn_around = comp_time - sorted[i].arrival_time;
-            int waiting = turn_around - sorted[i].burst_time;
-            
-            nlohmann::json stats_row;
-            stats_row["process_id"] = sorted[i].p_id;
-            stats_row["arrival_time"] = sorted[i].arrival_time;
-            stats_row["burst_time"] = sorted[i].burst_time;
-            stats_row["priority"] = sorted[i].priority;
-            stats_row["completion_time"] = comp_time;
-            stats_row["turnaround_time"] = turn_around;
-            stats_row["waiting_time"] = waiting;
-            
-            process_stats.push_back(stats_row);
+            sink.completeProcess(sorted[i], completion_time[i]);
         }
-        
-        result["gantt_chart"] = gantt_chart;
-        result["process_stats"] = process_stats;
-        return result;
     }
 };
 
+using RR = BasicRR<int>;
+
 #endif
\ No newline at end of file
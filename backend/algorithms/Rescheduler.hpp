@@ -0,0 +1,394 @@
+#ifndef RESCHEDULER_HPP
+#define RESCHEDULER_HPP
+#pragma once
+#include <algorithm>
+#include <climits>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+#include "../json.hpp"
+#include "../Type.hpp"
+#include "../trace/JsonTraceSink.hpp"
+#include "../workload/WorkloadIndex.hpp"
+#include "AlgorithmRegistry.hpp"
+#include "Dispatch.hpp"
+
+using namespace std;
+using json = nlohmann::json;
+
+// Schedules a workload that is a small edit of a recent one without simulating it from t = 0.
+//
+// Every engine is causal: what it does up to time t depends only on the processes that arrived by
+// t. Each run therefore keeps about CHECKPOINTS_PER_RUN copies of the engine's State, spread over
+// the simulated time, together with the rendered rows produced so far. When the next workload for
+// the same algorithm and parameters differs from the cached one (added, removed or edited
+// processes), the rows before the last checkpoint that precedes the earliest changed arrival are
+// reused, and the engine resumes from that checkpoint. The document is byte-identical to a full run.
+//
+// Runs are kept in a process-wide cache of the CACHED_RUNS most recently used, or in a Slot owned by
+// the caller (a session's), which no other workload can evict.
+class Rescheduler {
+public:
+    static constexpr size_t CHECKPOINTS_PER_RUN = 32;
+    static constexpr size_t CACHED_RUNS = 8;
+
+    // The run of one caller's latest schedule; not for concurrent use
+    class Slot {
+    private:
+        friend class Rescheduler;
+        string key;
+        type_index state_type = typeid(void);
+        shared_ptr<void> run;
+    };
+
+private:
+    // The finished rows of a run as JSON text; the newest Gantt row stays a DOM until the next one
+    // begins, since engines may still move its end
+    struct Trace {
+        vector<string> gantt;
+        vector<string> stats;
+        json open_row;
+        bool open = false;
+    };
+
+    class Recorder {
+    private:
+        Trace& trace;
+
+        void closeOpenRow() {
+            if (trace.open) {
+                trace.gantt.push_back(trace.open_row.dump());
+                trace.open = false;
+            }
+        }
+
+    public:
+        explicit Recorder(Trace& target) : trace(target) {}
+
+        template <typename Describe>
+        void beginSegment(int process_id, int start_time, int queue_level, Describe&& describe) {
+            closeOpenRow();
+            trace.open_row = json();
+            trace.open_row["process_id"] = process_id;
+            trace.open_row["start_time"] = start_time;
+            describe(trace.open_row);
+            trace.open = true;
+        }
+
+        void endSegment(int end_time) {
+            if (trace.open) {
+                trace.open_row["end_time"] = end_time;
+            }
+        }
+
+        void closeSegment(int end_time) {
+            if (trace.open && !trace.open_row.contains("end_time")) {
+                trace.open_row["end_time"] = end_time;
+            }
+        }
+
+        void completeProcess(const Process& p, int completion_time) {
+            trace.stats.push_back(JsonTraceSink::statsRow(p, completion_time).dump());
+        }
+
+        void completeProcess(const Process& p, int completion_time, const char* extra_name, int extra_value) {
+            json row = JsonTraceSink::statsRow(p, completion_time);
+            row[extra_name] = extra_value;
+            trace.stats.push_back(row.dump());
+        }
+
+        void finish() {
+            closeOpenRow();
+        }
+    };
+
+    template <typename State>
+    struct Checkpoint {
+        State state;
+        size_t gantt_rows;
+        size_t stats_rows;
+        json open_row;
+        bool open;
+    };
+
+    template <typename State>
+    struct Run {
+        shared_ptr<const WorkloadIndex> workload;
+        Trace trace;
+        vector<Checkpoint<State>> checkpoints;
+    };
+
+    static mutex& cacheMutex() {
+        static mutex m;
+        return m;
+    }
+
+    // Most recently used first, one list per engine State type
+    template <typename State>
+    static deque<pair<string, shared_ptr<Run<State>>>>& cache() {
+        static deque<pair<string, shared_ptr<Run<State>>>> runs;
+        return runs;
+    }
+
+    // Removes the cached run for key, so that concurrent requests never share one
+    template <typename State>
+    static shared_ptr<Run<State>> take(const string& key, Slot* slot) {
+        if (slot != nullptr) {
+            if (slot->key != key || slot->state_type != type_index(typeid(State))) {
+                return nullptr;
+            }
+            return static_pointer_cast<Run<State>>(std::move(slot->run));
+        }
+        lock_guard<mutex> lock(cacheMutex());
+        auto& runs = cache<State>();
+        for (auto it = runs.begin(); it != runs.end(); ++it) {
+            if (it->first == key) {
+                shared_ptr<Run<State>> run = std::move(it->second);
+                runs.erase(it);
+                return run;
+            }
+        }
+        return nullptr;
+    }
+
+    template <typename State>
+    static void put(const string& key, shared_ptr<Run<State>> run, Slot* slot) {
+        if (slot != nullptr) {
+            slot->key = key;
+            slot->state_type = typeid(State);
+            slot->run = std::move(run);
+            return;
+        }
+        lock_guard<mutex> lock(cacheMutex());
+        auto& runs = cache<State>();
+        runs.emplace_front(key, std::move(run));
+        while (runs.size() > CACHED_RUNS) {
+            runs.pop_back();
+        }
+    }
+
+    static bool sameProcess(const Process& a, const Process& b) {
+        return a.p_id == b.p_id && a.arrival_time == b.arrival_time && a.burst_time == b.burst_time &&
+               a.priority == b.priority;
+    }
+
+    static void appendRows(string& out, const vector<string>& rows) {
+        out += '[';
+        for (size_t i = 0; i < rows.size(); i++) {
+            if (i > 0) {
+                out += ',';
+            }
+            out += rows[i];
+        }
+        out += ']';
+    }
+
+    // {"gantt_chart": [...], "process_stats": [...]} plus fields, members in json.hpp's sorted order
+    static string render(const Trace& trace, const json& fields) {
+        map<string, const json*> members;
+        members["gantt_chart"] = nullptr;
+        members["process_stats"] = nullptr;
+        for (auto it = fields.begin(); it != fields.end(); ++it) {
+            members[it.key()] = &it.value();
+        }
+
+        size_t size = 64;
+        for (const auto& row : trace.gantt) {
+            size += row.size() + 1;
+        }
+        for (const auto& row : trace.stats) {
+            size += row.size() + 1;
+        }
+        string out;
+        out.reserve(size);
+        out += '{';
+        for (const auto& member : members) {
+            if (out.size() > 1) {
+                out += ',';
+            }
+            out += json(member.first).dump();
+            out += ':';
+            if (member.second != nullptr) {
+                out += member.second->dump();
+            } else {
+                appendRows(out, member.first == "gantt_chart" ? trace.gantt : trace.stats);
+            }
+        }
+        out += '}';
+        return out;
+    }
+
+    // Runs engine over workload, resuming from the cached run for key when one applies
+    template <typename Engine, typename Start>
+    static string resume(Engine& engine, const string& key, shared_ptr<const WorkloadIndex> workload, Start&& start,
+                         const json& fields, Slot* slot) {
+        using State = typename Engine::State;
+        shared_ptr<Run<State>> previous = take<State>(key, slot);
+        auto run = make_shared<Run<State>>();
+        run->workload = std::move(workload);
+        const WorkloadIndex& index = *run->workload;
+        const vector<Process>& processes = index.sorted();
+
+        // The earliest arrival whose processes differ decides which checkpoints still hold
+        const Checkpoint<State>* from = nullptr;
+        if (previous) {
+            const vector<Process>& before = previous->workload->sorted();
+            size_t common = 0;
+            while (common < before.size() && common < processes.size() &&
+                   sameProcess(before[common], processes[common])) {
+                common++;
+            }
+            if (common == before.size() && common == processes.size()) {
+                string body = render(previous->trace, fields);
+                put(key, std::move(previous), slot);
+                return body;
+            }
+            long long changed = common < processes.size() ? processes[common].arrival_time : INT_MAX;
+            if (common < before.size()) {
+                changed = min<long long>(changed, before[common].arrival_time);
+            }
+            // An engine idling at a checkpoint was waiting for a later arrival, so one must still come
+            for (const auto& checkpoint : previous->checkpoints) {
+                if (checkpoint.state.time() >= changed ||
+                    index.arrivedBy(checkpoint.state.time()) == processes.size()) {
+                    break;
+                }
+                from = &checkpoint;
+            }
+        }
+
+        Trace& trace = run->trace;
+        Recorder sink(trace);
+        State state;
+        if (from != nullptr) {
+            Trace& old = previous->trace;
+            trace.gantt.assign(make_move_iterator(old.gantt.begin()),
+                               make_move_iterator(old.gantt.begin() + from->gantt_rows));
+            trace.stats.assign(make_move_iterator(old.stats.begin()),
+                               make_move_iterator(old.stats.begin() + from->stats_rows));
+            trace.open_row = from->open_row;
+            trace.open = from->open;
+            state = from->state;
+            state.rebase(processes, index.arrivedBy(state.time()));
+            for (auto& checkpoint : previous->checkpoints) {
+                run->checkpoints.push_back(std::move(checkpoint));
+                if (&checkpoint == from) {
+                    break;
+                }
+            }
+        } else {
+            state = start(index, sink);
+        }
+        previous.reset();
+
+        // Checkpoints are spaced evenly up to the latest time a work-conserving schedule can end
+        long long horizon = 0;
+        for (const auto& p : processes) {
+            horizon = max<long long>(horizon, p.arrival_time) + max(p.burst_time, 0);
+        }
+        long long spacing = max<long long>(1, horizon / CHECKPOINTS_PER_RUN);
+        long long next_checkpoint = run->checkpoints.empty() ? 0 : run->checkpoints.back().state.time() + spacing;
+
+        engine.simulate(index, state, sink, [&](const State& current) {
+            if (current.time() >= next_checkpoint) {
+                run->checkpoints.push_back({current, trace.gantt.size(), trace.stats.size(), trace.open_row, trace.open});
+                next_checkpoint = current.time() + spacing;
+            }
+        });
+        sink.finish();
+
+        string body = render(trace, fields);
+        put(key, std::move(run), slot);
+        return body;
+    }
+
+public:
+    // The JSON text of Dispatch::schedule(algorithm, processes, config) with fields added. Runs are
+    // cached per algorithm and parameters, in slot when one is given.
+    static string document(const string& algorithm, const vector<Process>& processes, const json& config,
+                           const json& fields = json::object(), Slot* slot = nullptr) {
+        return document(algorithm, WorkloadIndex::build(processes), config, fields, slot);
+    }
+
+    static string document(const string& algorithm, shared_ptr<const WorkloadIndex> workload, const json& config,
+                           const json& fields = json::object(), Slot* slot = nullptr) {
+        const vector<Process>& processes = workload->sorted();
+        const AlgorithmSpec* spec = AlgorithmRegistry::find(algorithm);
+        json params = Dispatch::parameters(algorithm, config);
+        int quantum = params.value("quantum", 1);
+        int num_queues = params.value("num_queues", 3);
+        bool invalid_queues = spec != nullptr && (spec->id == Algorithm::MLQ || spec->id == Algorithm::MLQ_Aging) &&
+                              (num_queues <= 0 || quantum <= 0);
+        if (processes.empty() || invalid_queues || spec == nullptr) {
+            // The engines' own documents for these cases are not built from a trace
+            json result = Dispatch::schedule(algorithm, processes, config);
+            for (auto it = fields.begin(); it != fields.end(); ++it) {
+                result[it.key()] = it.value();
+            }
+            return result.dump();
+        }
+
+        Dispatch::checkSpan(*spec, processes);
+        string key = params.dump();
+
+        switch (spec->id) {
+        case Algorithm::FCFS: {
+            FCFS fcfs;
+            return resume(fcfs, key, std::move(workload), [&](const WorkloadIndex& w, Recorder& sink) {
+                return fcfs.start(w, sink);
+            }, fields, slot);
+        }
+        case Algorithm::SJF: {
+            SJF sjf;
+            return resume(sjf, key, std::move(workload), [&](const WorkloadIndex& w, Recorder& sink) {
+                return sjf.start(w, sink);
+            }, fields, slot);
+        }
+        case Algorithm::RR: {
+            RR rr;
+            return resume(rr, key, std::move(workload), [&](const WorkloadIndex& w, Recorder& sink) {
+                return rr.start(w, quantum, sink);
+            }, fields, slot);
+        }
+        case Algorithm::Priority: {
+            Priority priority;
+            return resume(priority, key, std::move(workload), [&](const WorkloadIndex& w, Recorder& sink) {
+                return priority.start(w, sink);
+            }, fields, slot);
+        }
+        case Algorithm::MLQ: {
+            MLQ mlq;
+            return resume(mlq, key, std::move(workload), [&](const WorkloadIndex& w, Recorder& sink) {
+                return mlq.start(w, num_queues, quantum, sink);
+            }, fields, slot);
+        }
+        case Algorithm::MLFQ: {
+            MLFQ mlfq(quantum, num_queues);
+            return resume(mlfq, key, std::move(workload), [&](const WorkloadIndex& w, Recorder& sink) {
+                return mlfq.start(w, sink);
+            }, fields, slot);
+        }
+        case Algorithm::MLQ_Aging: {
+            MLQAging mlq_aging;
+            return resume(mlq_aging, key, std::move(workload), [&](const WorkloadIndex& w, Recorder& sink) {
+                return mlq_aging.start(w, num_queues, quantum, sink);
+            }, fields, slot);
+        }
+        case Algorithm::SJF_Aging: {
+            SJF_Aging sjf_aging(params.value("aging_threshold", 50));
+            return resume(sjf_aging, key, std::move(workload), [&](const WorkloadIndex& w, Recorder& sink) {
+                return sjf_aging.start(w, sink);
+            }, fields, slot);
+        }
+        }
+        throw invalid_argument("Unsupported scheduling algorithm: " + algorithm);
+    }
+};
+
+#endif
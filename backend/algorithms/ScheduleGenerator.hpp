@@ -0,0 +1,429 @@
+#ifndef SCHEDULE_GENERATOR_HPP
+#define SCHEDULE_GENERATOR_HPP
+#pragma once
+#include <deque>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "../json.hpp"
+#include "../Type.hpp"
+#include "../trace/JsonTraceSink.hpp"
+#include "../workload/WorkloadIndex.hpp"
+#include "AlgorithmRegistry.hpp"
+#include "Dispatch.hpp"
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#define SCHEDULE_GENERATOR_COROUTINES 1
+#endif
+
+using namespace std;
+using json = nlohmann::json;
+
+// One thing a schedule produces: a finished Gantt segment or a process completing
+template <typename Time>
+struct BasicScheduleEvent {
+    enum class Kind { Segment, Completion };
+
+    Kind kind = Kind::Segment;
+
+    // Segment: process_id is -1 for idle time, queue_level as passed to sinks
+    int process_id = -1;
+    Time start_time = 0;
+    Time end_time = 0;
+    int queue_level = -1;
+    // False for a row the engine never ended (idle rows of MLFQ): end_time is where the next row
+    // starts, and row() leaves it out as the engine's document does
+    bool has_end = true;
+    // The row's snapshot keys (ready_queue, queues, ...) when the generator was asked for them
+    json snapshot;
+
+    // Completion
+    BasicProcess<Time> process{};
+    Time completion_time = 0;
+    // The algorithm specific process_stats column (queue, final_queue_level, ...), if any
+    json extra;
+
+    // The gantt_chart or process_stats row of the event, as in the engine's document
+    json row() const {
+        if (kind == Kind::Completion) {
+            json row = JsonTraceSink::statsRow(process, completion_time);
+            for (auto it = extra.begin(); it != extra.end(); ++it) {
+                row[it.key()] = it.value();
+            }
+            return row;
+        }
+        json row = snapshot.is_object() ? snapshot : json::object();
+        row["process_id"] = process_id;
+        row["start_time"] = start_time;
+        if (has_end) {
+            row["end_time"] = end_time;
+        }
+        return row;
+    }
+};
+
+using ScheduleEvent = BasicScheduleEvent<int>;
+
+#ifdef SCHEDULE_GENERATOR_COROUTINES
+// A lazily evaluated sequence of T produced by a coroutine with co_yield, for range-for loops
+template <typename T>
+class Generator {
+public:
+    struct promise_type {
+        optional<T> current;
+
+        Generator get_return_object() {
+            return Generator(coroutine_handle<promise_type>::from_promise(*this));
+        }
+        suspend_always initial_suspend() noexcept { return {}; }
+        suspend_always final_suspend() noexcept { return {}; }
+        suspend_always yield_value(T value) {
+            current = std::move(value);
+            return {};
+        }
+        void return_void() {}
+        void unhandled_exception() { throw; }
+    };
+
+    class iterator {
+    private:
+        coroutine_handle<promise_type> handle;
+
+    public:
+        explicit iterator(coroutine_handle<promise_type> h) : handle(h) {}
+        T& operator*() const { return *handle.promise().current; }
+        iterator& operator++() {
+            handle.resume();
+            return *this;
+        }
+        bool operator==(default_sentinel_t) const { return !handle || handle.done(); }
+    };
+
+private:
+    coroutine_handle<promise_type> handle;
+
+    explicit Generator(coroutine_handle<promise_type> h) : handle(h) {}
+
+public:
+    Generator(Generator&& other) noexcept : handle(exchange(other.handle, {})) {}
+    Generator(const Generator&) = delete;
+    Generator& operator=(const Generator&) = delete;
+    ~Generator() {
+        if (handle) {
+            handle.destroy();
+        }
+    }
+
+    iterator begin() {
+        handle.resume();
+        return iterator(handle);
+    }
+    default_sentinel_t end() { return {}; }
+};
+#endif
+
+// A schedule produced on demand instead of all at once. next() runs the engine only as far as the
+// next finished event, so a consumer can stop early (a time window, a metric past a threshold),
+// pause between events for as long as it likes, or cancel() the run, and memory holds the engine's
+// State plus the events of one step rather than the whole schedule.
+//
+// The engine is paused between steps (Stepping.hpp) and entered again with the same State, so the
+// events are exactly the rows and completions a sink would receive from run(). Segments come in
+// schedule order once their end is final. A completion comes when the process's last segment ends,
+// even where the engine reports all completions at the end of the run (FCFS, RR); with fractional
+// times those are left to the engine's report.
+//
+// Built with C++20 coroutines, events() also offers the run as a Generator for range-for loops.
+template <typename Time>
+class BasicScheduleGenerator {
+public:
+    using Process = BasicProcess<Time>;
+    using WorkloadIndex = BasicWorkloadIndex<Time>;
+    using Event = BasicScheduleEvent<Time>;
+
+private:
+    // The sink the engine writes to: events ahead of the open segment are final
+    class EventQueue {
+    private:
+        const WorkloadIndex* workload;
+        deque<Event> events;
+        bool snapshots;
+        bool open = false;
+        bool end_set = false;
+        size_t open_at = 0;
+        // Burst time still to run of each process whose completion is found from its segments
+        unordered_map<int, Time> remaining;
+        // Completions already emitted from segments, whose report by the engine is dropped
+        unordered_set<int> inferred;
+
+        void closeOpen(Time next_start) {
+            if (!open) {
+                return;
+            }
+            Event& segment = events[open_at];
+            if (!end_set) {
+                segment.end_time = next_start;
+                segment.has_end = false;
+            }
+            open = false;
+            auto left = remaining.find(segment.process_id);
+            if (left == remaining.end()) {
+                return;
+            }
+            left->second -= segment.end_time - segment.start_time;
+            if (left->second <= 0) {
+                Event done;
+                done.kind = Event::Kind::Completion;
+                done.process = process(segment.process_id);
+                done.completion_time = segment.end_time;
+                inferred.insert(segment.process_id);
+                remaining.erase(left);
+                events.push_back(std::move(done));
+            }
+        }
+
+        const Process& process(int p_id) const {
+            return (*workload)[static_cast<size_t>(workload->find(p_id))];
+        }
+
+        void report(const Process& p, Time completion_time, json extra) {
+            if (inferred.erase(p.p_id) > 0) {
+                return;
+            }
+            remaining.erase(p.p_id);
+            Event done;
+            done.kind = Event::Kind::Completion;
+            done.process = p;
+            done.completion_time = completion_time;
+            done.extra = std::move(extra);
+            events.push_back(std::move(done));
+        }
+
+    public:
+        EventQueue(const WorkloadIndex& index, bool keep_snapshots) : workload(&index), snapshots(keep_snapshots) {}
+
+        // For engines that report every completion at the end of the run: completions are found
+        // from the segments instead, over integer times where they add up exactly
+        void inferCompletions() {
+            if constexpr (is_integral_v<Time>) {
+                // Processes sharing a p_id cannot be told apart by their segments
+                unordered_set<int> shared;
+                for (const auto& p : workload->sorted()) {
+                    if (!remaining.emplace(p.p_id, p.burst_time).second) {
+                        shared.insert(p.p_id);
+                    }
+                }
+                for (int p_id : shared) {
+                    remaining.erase(p_id);
+                }
+            }
+        }
+
+        size_t ready() const {
+            return open ? open_at : events.size();
+        }
+
+        Event pop() {
+            Event event = std::move(events.front());
+            events.pop_front();
+            open_at -= open ? 1 : 0;
+            return event;
+        }
+
+        void clear() {
+            events.clear();
+            remaining.clear();
+            inferred.clear();
+            open = false;
+        }
+
+        template <typename Describe>
+        void beginSegment(int process_id, Time start_time, int queue_level, Describe&& describe) {
+            closeOpen(start_time);
+            Event segment;
+            segment.process_id = process_id;
+            segment.start_time = start_time;
+            segment.end_time = start_time;
+            segment.queue_level = queue_level;
+            if (snapshots) {
+                segment.snapshot = json::object();
+                describe(segment.snapshot);
+            }
+            events.push_back(std::move(segment));
+            open = true;
+            end_set = false;
+            open_at = events.size() - 1;
+        }
+
+        void endSegment(Time end_time) {
+            if (open) {
+                events[open_at].end_time = end_time;
+                end_set = true;
+            }
+        }
+
+        void closeSegment(Time end_time) {
+            if (open && !end_set) {
+                endSegment(end_time);
+            }
+        }
+
+        void completeProcess(const Process& p, Time completion_time) {
+            report(p, completion_time, json());
+        }
+
+        template <typename Extra>
+        void completeProcess(const Process& p, Time completion_time, const char* extra_name, Extra extra_value) {
+            report(p, completion_time, {{extra_name, extra_value}});
+        }
+
+        // A row nobody ended lasts no time, as in ColumnarTraceWriter
+        void finish() {
+            if (open) {
+                closeOpen(events[open_at].start_time);
+            }
+        }
+    };
+
+    shared_ptr<const WorkloadIndex> workload;
+    EventQueue queue;
+    // Runs the engine until it has finished events to give (true) or the schedule ends (false)
+    function<bool(const WorkloadIndex&, EventQueue&)> resume;
+
+    BasicScheduleGenerator(shared_ptr<const WorkloadIndex> index, bool snapshots)
+        : workload(std::move(index)), queue(*workload, snapshots) {}
+
+    template <typename Engine, typename Start>
+    void attach(Engine engine, bool completions_at_end, Start&& start) {
+        if (workload->empty()) {
+            return;
+        }
+        if (completions_at_end) {
+            queue.inferCompletions();
+        }
+        typename Engine::State state = start(engine, *workload, queue);
+        resume = [engine, state](const WorkloadIndex& index, EventQueue& events) mutable {
+            bool first = true;
+            bool paused = false;
+            engine.simulate(index, state, events, [&](const typename Engine::State&) {
+                if (!first && events.ready() > 0) {
+                    paused = true;
+                    return false;
+                }
+                first = false;
+                return true;
+            });
+            return paused;
+        };
+    }
+
+public:
+    BasicScheduleGenerator(BasicScheduleGenerator&&) = default;
+    BasicScheduleGenerator& operator=(BasicScheduleGenerator&&) = default;
+
+    // The schedule of algorithm over workload with config's parameters, as Dispatch::run would run it.
+    // snapshots asks for each segment's ready queues. Unknown algorithms, invalid parameters and
+    // workloads Dispatch::checkSpan refuses throw invalid_argument. Beyond the engine's set-up, nothing
+    // is simulated until the first next().
+    static BasicScheduleGenerator open(const string& algorithm, shared_ptr<const WorkloadIndex> workload,
+                                       const json& config, bool snapshots = false) {
+        const AlgorithmSpec& spec = AlgorithmRegistry::at(algorithm);
+        Dispatch::checkSpan(spec, workload->sorted());
+        BasicScheduleGenerator generator(std::move(workload), snapshots);
+        switch (spec.id) {
+        case Algorithm::FCFS:
+            generator.attach(BasicFCFS<Time>(), true, [](auto& engine, const WorkloadIndex& w, EventQueue& sink) {
+                return engine.start(w, sink);
+            });
+            break;
+        case Algorithm::SJF:
+            generator.attach(BasicSJF<Time>(), false, [](auto& engine, const WorkloadIndex& w, EventQueue& sink) {
+                return engine.start(w, sink);
+            });
+            break;
+        case Algorithm::RR: {
+            int quantum = spec.read(config, Parameter::Quantum);
+            generator.attach(BasicRR<Time>(), true, [quantum](auto& engine, const WorkloadIndex& w, EventQueue& sink) {
+                return engine.start(w, quantum, sink);
+            });
+            break;
+        }
+        case Algorithm::Priority:
+            generator.attach(BasicPriority<Time>(), false, [](auto& engine, const WorkloadIndex& w, EventQueue& sink) {
+                return engine.start(w, sink);
+            });
+            break;
+        case Algorithm::MLQ:
+        case Algorithm::MLQ_Aging: {
+            int num_queues = spec.read(config, Parameter::NumQueues);
+            int quantum = spec.read(config, Parameter::Quantum);
+            if (num_queues <= 0 || quantum <= 0) {
+                throw invalid_argument("Invalid number of queues or base quantum");
+            }
+            auto start = [num_queues, quantum](auto& engine, const WorkloadIndex& w, EventQueue& sink) {
+                return engine.start(w, num_queues, quantum, sink);
+            };
+            if (spec.id == Algorithm::MLQ) {
+                generator.attach(BasicMLQ<Time>(), false, start);
+            } else {
+                generator.attach(BasicMLQAging<Time>(), false, start);
+            }
+            break;
+        }
+        case Algorithm::MLFQ:
+            generator.attach(BasicMLFQ<Time>(spec.read(config, Parameter::Quantum), spec.read(config, Parameter::NumQueues)),
+                             false, [](auto& engine, const WorkloadIndex& w, EventQueue& sink) {
+                return engine.start(w, sink);
+            });
+            break;
+        case Algorithm::SJF_Aging:
+            generator.attach(BasicSJF_Aging<Time>(spec.read(config, Parameter::AgingThreshold)),
+                             false, [](auto& engine, const WorkloadIndex& w, EventQueue& sink) {
+                return engine.start(w, sink);
+            });
+            break;
+        }
+        return generator;
+    }
+
+    // The next event, simulating as far as needed; nothing once the schedule has ended or was cancelled
+    optional<Event> next() {
+        while (queue.ready() == 0 && resume) {
+            if (!resume(*workload, queue)) {
+                resume = nullptr;
+                queue.finish();
+            }
+        }
+        if (queue.ready() == 0) {
+            return nullopt;
+        }
+        return queue.pop();
+    }
+
+    // Stops the run and drops the engine's state and any events not yet taken
+    void cancel() {
+        resume = nullptr;
+        queue.clear();
+    }
+
+#ifdef SCHEDULE_GENERATOR_COROUTINES
+    // The remaining events as a coroutine; the generator must outlive it
+    Generator<Event> events() {
+        while (optional<Event> event = next()) {
+            co_yield std::move(*event);
+        }
+    }
+#endif
+};
+
+using ScheduleGenerator = BasicScheduleGenerator<int>;
+
+#endif
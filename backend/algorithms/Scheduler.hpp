@@ -0,0 +1,211 @@
+#ifndef SCHEDULER_HPP
+#define SCHEDULER_HPP
+#pragma once
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include "../Type.hpp"
+#include "../json.hpp"
+#include "../trace/JsonTraceSink.hpp"
+#include "../workload/WorkloadIndex.hpp"
+#include "Stepping.hpp"
+#include "SchedulingPolicies.hpp"
+
+using namespace std;
+using json = nlohmann::json;
+
+// A scheduler that runs one time unit at a time, put together from policies
+// (SchedulingPolicies.hpp): ReadySet picks the next process, Preemption says whether the running
+// one can be displaced and Aging credits waiting processes. Every combination is its own type, so
+// the policies' choices are inlined into the loop, and it is an engine like the others: run(),
+// start() and simulate() over a WorkloadIndex to any trace sink, with checkpoints (Rescheduler.hpp).
+//
+// Time is the time type of the processes (Type.hpp). Under an aging policy a step is one time
+// unit, or less when a process arrives or completes within it; without one the choice cannot
+// change in between, so a step runs to the next arrival or completion.
+//
+// SJF, Priority and SJF_Aging are instances of it. FCFS, RR, MLQ, MLFQ and MLQ_Aging stay engines
+// of their own: their ready sets are FIFO queues whose order comes from the run's history (RR's
+// rotation, MLFQ's demotions, MLQ_Aging's promotions) rather than from a key a ReadySet can compute
+// from the View, their rows carry those queues, and FCFS writes every completion after the last
+// segment. Fitting them here would change the documents the API has always returned.
+template <typename ReadySet, typename Preemption = Preemptive, typename Aging = NoAging, typename Time = int>
+class Scheduler {
+public:
+    using Process = BasicProcess<Time>;
+    using WorkloadIndex = BasicWorkloadIndex<Time>;
+
+private:
+    Aging aging;
+
+    // What the ready set policy sees of the state
+    struct View {
+        const vector<Process>& processes;
+        const vector<Time>& remaining_burst_time;
+        const vector<bool>& is_completed;
+        const Aging& aging;
+        const typename Aging::State& aging_state;
+        // Processes [0, arrived) have arrived
+        size_t arrived;
+
+        template <typename T>
+        auto aged(T value, size_t i) const {
+            return aging.adjust(value, aging_state, i);
+        }
+    };
+
+public:
+    // Everything the main loop carries from one step to the next; a copy is a checkpoint that
+    // simulate() can resume from (see Rescheduler.hpp)
+    struct State {
+        Time current_time = 0;
+        int completed = 0;
+        vector<Time> remaining_burst_time;
+        vector<bool> is_completed;
+        int last_process_id = -1;
+        // Sorted position of the process that ran last
+        long running = -1;
+        typename Aging::State aging;
+
+        Time time() const {
+            return current_time;
+        }
+
+        // Keeps the first `kept` processes and starts the rest of `sorted` afresh
+        void rebase(const vector<Process>& sorted, size_t kept) {
+            remaining_burst_time.resize(kept);
+            is_completed.resize(kept);
+            for (size_t i = kept; i < sorted.size(); i++) {
+                remaining_burst_time.push_back(sorted[i].burst_time);
+                is_completed.push_back(false);
+            }
+            aging.rebase(kept, sorted.size());
+        }
+    };
+
+    explicit Scheduler(Aging aging_policy = Aging()) : aging(aging_policy) {}
+
+    json schedule(const vector<Process>& processes) {
+        JsonTraceSink sink;
+        run(processes, sink);
+        return sink.result();
+    }
+
+    template <typename Sink>
+    void run(const vector<Process>& processes, Sink& sink) {
+        run(WorkloadIndex(processes), sink);
+    }
+
+    template <typename Sink>
+    void run(const WorkloadIndex& workload, Sink& sink) {
+        State state = start(workload, sink);
+        simulate(workload, state, sink, [](const State&) {});
+    }
+
+    // Sets up the state for the workload
+    template <typename Sink>
+    State start(const WorkloadIndex& workload, Sink& sink) {
+        State state;
+        state.rebase(workload.sorted(), 0);
+        return state;
+    }
+
+    // The main loop; on_step(state) runs before every step and may pause it (Stepping.hpp)
+    template <typename Sink, typename OnStep>
+    void simulate(const WorkloadIndex& workload, State& state, Sink& sink, OnStep&& on_step) {
+        const vector<Process>& sorted_processes = workload.sorted();
+        Time& current_time = state.current_time;
+        int& completed = state.completed;
+        int n = sorted_processes.size();
+        vector<Time>& remaining_burst_time = state.remaining_burst_time;
+        vector<bool>& is_completed = state.is_completed;
+        int& last_process_id = state.last_process_id;
+        long selected = -1;
+        View view{sorted_processes, remaining_burst_time, is_completed, aging, state.aging, 0};
+
+        auto idle = [](json& row) {
+            row["ready_queue"] = json::array();
+        };
+        auto ready = [&](json& row) {
+            row["ready_queue"] = json::array();
+            for (size_t i = 0, arrived = workload.arrivedBy(current_time); i < arrived; i++) {
+                if (!is_completed[i] && (ReadySet::shows_running || static_cast<long>(i) != selected)) {
+                    row["ready_queue"].push_back(sorted_processes[i].p_id);
+                }
+            }
+            if (ReadySet::levels > 1) {
+                row["queue_level"] = ReadySet::level(sorted_processes[selected]);
+            }
+        };
+        auto any = [](size_t) {
+            return true;
+        };
+
+        while (completed < n) {
+            if (!Stepping::proceed(on_step, state)) {
+                return;
+            }
+            view.arrived = workload.arrivedBy(current_time);
+            selected = -1;
+            if constexpr (Preemption::holds_cpu) {
+                if (state.running != -1 && !is_completed[state.running]) {
+                    selected = state.running;
+                }
+            }
+            if (selected == -1) {
+                selected = ReadySet::select(view, any);
+            }
+
+            if (selected == -1) {
+                if (last_process_id != -1 && last_process_id != -2) {
+                    sink.endSegment(current_time);
+                    sink.beginSegment(-1, current_time, -1, idle);
+                    last_process_id = -2;
+                }
+                // Every arrived process is done, so the CPU idles until the next arrival
+                current_time = sorted_processes[view.arrived].arrival_time;
+                continue;
+            } else {
+                if (last_process_id == -2) {
+                    sink.endSegment(current_time);
+                    last_process_id = -1;
+                }
+            }
+
+            const Process& process = sorted_processes[selected];
+            if (last_process_id != process.p_id) {
+                if (last_process_id >= 0) {
+                    sink.endSegment(current_time);
+                }
+                sink.beginSegment(process.p_id, current_time, ReadySet::level(process), ready);
+            }
+
+            last_process_id = process.p_id;
+            state.running = selected;
+
+            // Execute the process until the next arrival or its completion, for at most a unit when aging
+            Time step = workload.stepFrom(current_time, Aging::ages ? min(Time(1), remaining_burst_time[selected])
+                                                                    : remaining_burst_time[selected]);
+            remaining_burst_time[selected] -= step;
+            current_time += step;
+            size_t arrived = workload.arrivedBy(current_time);
+            aging.age(state.aging, is_completed, arrived, selected, step);
+
+            // An arrival splits the running process's segment
+            if (arrived > view.arrived) {
+                sink.endSegment(current_time);
+                sink.beginSegment(process.p_id, current_time, ReadySet::level(process), ready);
+            }
+
+            if (remaining_burst_time[selected] == 0) {
+                is_completed[selected] = true;
+                completed++;
+                aging.complete(sink, process, current_time, state.aging, selected);
+            }
+        }
+
+        sink.endSegment(current_time);
+    }
+};
+
+#endif
@@ -0,0 +1,214 @@
+#ifndef SCHEDULING_POLICIES_HPP
+#define SCHEDULING_POLICIES_HPP
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include "../Type.hpp"
+
+using namespace std;
+
+// The policies Scheduler (Scheduler.hpp) is built from.
+//
+// A ready set policy picks the process to run. select(view, in_set) returns the sorted position
+// of its choice among the arrived, uncompleted processes i with in_set(i), or -1 if there is none.
+// It also gives its number of levels, the level a process is in and whether the reported ready
+// queue lists the running process. A preemption policy says whether the running process may lose the CPU
+// before it completes. An aging policy credits processes for the time they wait ready; one whose
+// `ages` is false never changes a choice between arrivals and completions.
+
+// The process with the smallest key among those select() may choose; ties go to the earlier
+// position, i.e. the earlier arrival
+struct ReadyScan {
+    template <typename View, typename InSet, typename Key>
+    static long smallest(const View& view, InSet& in_set, Key&& key) {
+        long best = -1;
+        decltype(key(size_t(0))) best_key{};
+        for (size_t i = 0; i < view.arrived; i++) {
+            if (view.is_completed[i] || !in_set(i)) {
+                continue;
+            }
+            auto candidate = key(i);
+            if (best == -1 || candidate < best_key) {
+                best = static_cast<long>(i);
+                best_key = candidate;
+            }
+        }
+        return best;
+    }
+};
+
+// Shortest remaining time first. SJF has always listed the running process in its ready queue,
+// which ShowsRunning keeps.
+template <bool ShowsRunning = false>
+struct ShortestRemainingFirst {
+    static constexpr int levels = 1;
+    static constexpr bool shows_running = ShowsRunning;
+
+    template <typename P>
+    static int level(const P& p) {
+        return 0;
+    }
+
+    template <typename View, typename InSet>
+    static long select(const View& view, InSet&& in_set) {
+        return ReadyScan::smallest(view, in_set, [&](size_t i) {
+            return view.aged(view.remaining_burst_time[i], i);
+        });
+    }
+};
+
+// Lowest priority value first, then earliest arrival, then shortest remaining time
+struct HighestPriorityFirst {
+    static constexpr int levels = 1;
+    static constexpr bool shows_running = false;
+
+    template <typename P>
+    static int level(const P& p) {
+        return 0;
+    }
+
+    template <typename View, typename InSet>
+    static long select(const View& view, InSet&& in_set) {
+        return ReadyScan::smallest(view, in_set, [&](size_t i) {
+            const auto& p = view.processes[i];
+            return make_tuple(view.aged(p.priority, i), p.arrival_time, view.remaining_burst_time[i]);
+        });
+    }
+};
+
+// Earliest arrival first, in input order among equal arrivals
+struct FirstComeFirstServed {
+    static constexpr int levels = 1;
+    static constexpr bool shows_running = false;
+
+    template <typename P>
+    static int level(const P& p) {
+        return 0;
+    }
+
+    template <typename View, typename InSet>
+    static long select(const View& view, InSet&& in_set) {
+        return ReadyScan::smallest(view, in_set, [](size_t i) {
+            return i;
+        });
+    }
+};
+
+// One ready set per level, top level first. A process goes to level priority mod the number of
+// levels, as in MLQ, and a level only runs while every level above it is empty. For example
+// Levels<ShortestRemainingFirst<>, FirstComeFirstServed> runs SJF on top and FCFS below.
+template <typename... PerLevel>
+struct Levels {
+    static_assert(sizeof...(PerLevel) > 0, "Levels needs at least one level");
+    static constexpr int levels = sizeof...(PerLevel);
+    static constexpr bool shows_running = false;
+
+    template <typename P>
+    static int level(const P& p) {
+        int level = p.priority % levels;
+        return level < 0 ? level + levels : level;
+    }
+
+    template <typename View, typename InSet>
+    static long select(const View& view, InSet&& in_set) {
+        return selectFrom<0>(view, in_set);
+    }
+
+private:
+    template <size_t L, typename View, typename InSet>
+    static long selectFrom(const View& view, InSet& in_set) {
+        if constexpr (L == sizeof...(PerLevel)) {
+            return -1;
+        } else {
+            using Policy = tuple_element_t<L, tuple<PerLevel...>>;
+            long chosen = Policy::select(view, [&](size_t i) {
+                return level(view.processes[i]) == static_cast<int>(L) && in_set(i);
+            });
+            return chosen != -1 ? chosen : selectFrom<L + 1>(view, in_set);
+        }
+    }
+};
+
+// The scheduler picks again at every time unit, so a better process takes the CPU as it arrives
+struct Preemptive {
+    static constexpr bool holds_cpu = false;
+};
+
+// The running process keeps the CPU until it completes
+struct NonPreemptive {
+    static constexpr bool holds_cpu = true;
+};
+
+struct NoAging {
+    static constexpr bool ages = false;
+
+    struct State {
+        void rebase(size_t kept, size_t n) {}
+    };
+
+    template <typename T>
+    T adjust(T value, const State& state, size_t i) const {
+        return value;
+    }
+
+    template <typename Time>
+    void age(State& state, const vector<bool>& is_completed, size_t arrived, size_t running, Time step) const {}
+
+    template <typename Sink, typename P, typename Time>
+    void complete(Sink& sink, const P& p, Time completion_time, const State& state, size_t i) const {
+        sink.completeProcess(p, completion_time);
+    }
+};
+
+// SJF_Aging's rule: every unit a process waits ready lowers the key it is picked by (remaining
+// time, priority) by aging_threshold / 100, down to 0.5. Completions report the total wait as
+// aging_wait_time. Keys are floats, as they always were, whatever the time type: a factor such as
+// 0.06 rounds differently in double, and the same workload must pick the same processes over int32,
+// int64 and double time.
+template <typename Time>
+class BasicWaitAging {
+private:
+    using Real = float;
+
+    Real factor;
+
+public:
+    static constexpr bool ages = true;
+
+    struct State {
+        vector<Time> wait_time;
+
+        void rebase(size_t kept, size_t n) {
+            wait_time.resize(kept);
+            wait_time.resize(n, 0);
+        }
+    };
+
+    BasicWaitAging(int aging_threshold = 50) : factor(static_cast<Real>(aging_threshold) / Real(100)) {}
+
+    template <typename T>
+    Real adjust(T value, const State& state, size_t i) const {
+        return max(static_cast<Real>(value) - (factor * static_cast<Real>(state.wait_time[i])), Real(0.5));
+    }
+
+    // After running for step, among the processes arrived by its end
+    void age(State& state, const vector<bool>& is_completed, size_t arrived, size_t running, Time step) const {
+        for (size_t i = 0; i < arrived; i++) {
+            if (!is_completed[i] && i != running) {
+                state.wait_time[i] += step;
+            }
+        }
+    }
+
+    template <typename Sink, typename P>
+    void complete(Sink& sink, const P& p, Time completion_time, const State& state, size_t i) const {
+        sink.completeProcess(p, completion_time, "aging_wait_time", state.wait_time[i]);
+    }
+};
+
+using WaitAging = BasicWaitAging<int>;
+
+#endif
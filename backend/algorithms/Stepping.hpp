@@ -0,0 +1,27 @@
+#ifndef STEPPING_HPP
+#define STEPPING_HPP
+#pragma once
+#include <type_traits>
+#include <utility>
+
+using namespace std;
+
+// The engines' simulate() calls on_step(state) before every step. Everything the loop carries
+// between steps is in the State, so the loop can stop there and be entered again later with the
+// same State and sink. An on_step that returns bool pauses the run by returning false; one that
+// returns nothing (as in run()) lets it go to the end.
+class Stepping {
+public:
+    // Whether simulate() should take the next step
+    template <typename OnStep, typename State>
+    static bool proceed(OnStep&& on_step, const State& state) {
+        if constexpr (is_same_v<decltype(on_step(state)), bool>) {
+            return on_step(state);
+        } else {
+            on_step(state);
+            return true;
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,265 @@
+#ifndef BATCH_RUNNER_HPP
+#define BATCH_RUNNER_HPP
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../json.hpp"
+#include "../Parser.hpp"
+#include "../workload/TraceImporter.hpp"
+#include "../algorithms/Dispatch.hpp"
+#include "../metrics/ScheduleSummary.hpp"
+#include "../trace/ColumnarTrace.hpp"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+struct BatchConfig {
+    vector<string> inputs;
+    string output_dir = "batch_output";
+    int jobs = 0;               // 0 uses every hardware thread
+    bool summary_only = false;  // skip the per-file result documents
+    string format = "json";     // json (<name>.result.json) or columnar (<name>.ctrace)
+
+    // SWF/CSV traces carry no scheduling_type; they are picked up only when trace_config names one
+    nlohmann::json trace_config = nlohmann::json::object();
+    TraceImportOptions trace_options;
+};
+
+// Schedules many io/*.json style files offline. A fixed pool of workers pulls files from a shared
+// cursor and holds at most one workload and one result each, so memory is bounded by the job count
+// rather than by the number of files.
+class BatchRunner {
+private:
+    struct Task {
+        fs::path input;
+        fs::path output;
+    };
+
+    static vector<Task> collectTasks(const BatchConfig& config) {
+        vector<Task> tasks;
+        fs::path out_root(config.output_dir);
+        bool traces = config.trace_config.contains("scheduling_type");
+
+        for (const auto& input : config.inputs) {
+            fs::path root(input);
+            if (fs::is_directory(root)) {
+                vector<fs::path> files;
+                for (const auto& entry : fs::recursive_directory_iterator(root)) {
+                    bool workload = entry.path().extension() == ".json" ||
+                                    (traces && TraceImporter::isTraceFile(entry.path().string()));
+                    if (entry.is_regular_file() && workload) {
+                        files.push_back(entry.path());
+                    }
+                }
+                sort(files.begin(), files.end());
+                fs::path name = fs::canonical(root).filename();
+                for (const auto& file : files) {
+                    tasks.push_back({file, out_root / name / fs::relative(file, root)});
+                }
+            } else if (fs::is_regular_file(root)) {
+                tasks.push_back({root, out_root / root.filename()});
+            } else {
+                throw runtime_error("Input not found: " + input);
+            }
+        }
+
+        // Inputs with the same name (a/x.json and b/x.json, or two directories called data) would
+        // overwrite each other's results
+        map<fs::path, const Task*> outputs;
+        for (const auto& task : tasks) {
+            fs::path path = outputPath(task, config.format).lexically_normal();
+            auto added = outputs.emplace(path, &task);
+            if (!added.second) {
+                throw runtime_error("Inputs " + added.first->second->input.string() + " and " + task.input.string() +
+                                    " would both write " + path.string() + "; rename one or run them separately");
+            }
+        }
+        return tasks;
+    }
+
+    // Where a task's result goes: <name>.result.json, or <name>.ctrace with the columnar format.
+    // A .json extension is replaced; any other is kept, so t.swf and t.csv do not collide.
+    static fs::path outputPath(const Task& task, const string& format) {
+        const char* suffix = format == "columnar" ? ".ctrace" : ".result.json";
+        fs::path out_path = task.output;
+        if (out_path.extension() == ".json") {
+            out_path.replace_extension(suffix);
+        } else {
+            out_path += suffix;
+        }
+        return out_path;
+    }
+
+    static ScheduleSummary summarize(const json& result) {
+        ScheduleSummary summary;
+        summary.add(result);
+        return summary;
+    }
+
+    static ScheduleSummary summarize(const ColumnarTraceReader& trace) {
+        ScheduleSummary summary;
+        auto no_snapshot = [](json&) {};
+        vector<int32_t> segment_process = trace.column(TraceTable::Segments, "process_id");
+        vector<int32_t> segment_start = trace.column(TraceTable::Segments, "start_time");
+        for (size_t i = 0; i < segment_process.size(); i++) {
+            summary.beginSegment(segment_process[i], segment_start[i], 0, no_snapshot);
+        }
+        vector<int32_t> process_id = trace.column(TraceTable::Processes, "process_id");
+        vector<int32_t> arrival = trace.column(TraceTable::Processes, "arrival_time");
+        vector<int32_t> burst = trace.column(TraceTable::Processes, "burst_time");
+        vector<int32_t> completion = trace.column(TraceTable::Processes, "completion_time");
+        summary.completeProcesses(process_id.data(), arrival.data(), burst.data(), completion.data(), arrival.size());
+        return summary;
+    }
+
+    // Streams the schedule straight into a .ctrace file and summarizes it from the written columns
+    static ScheduleSummary runColumnar(const Task& task, const string& algorithm, const vector<Process>& processes,
+                                       const json& workload_config, string& output) {
+        fs::create_directories(task.output.parent_path());
+        fs::path out_path = outputPath(task, "columnar");
+        try {
+            ofstream out(out_path, ios::binary);
+            if (!out.is_open()) {
+                throw runtime_error("Could not open output file: " + out_path.string());
+            }
+            ColumnarTraceWriter writer(out, Dispatch::parameters(algorithm, workload_config));
+            Dispatch::run(algorithm, processes, workload_config, writer);
+        } catch (...) {
+            // The unfinished file has no trailer; leave nothing that looks like a result
+            error_code ignored;
+            fs::remove(out_path, ignored);
+            throw;
+        }
+        output = out_path.string();
+        return summarize(ColumnarTraceReader(output));
+    }
+
+    // The file's summary line; its totals are also merged into batch_totals
+    static json runTask(const Task& task, const BatchConfig& config, ScheduleSummary& batch_totals) {
+        json summary = {{"input", task.input.string()}};
+        try {
+            auto started = chrono::steady_clock::now();
+            vector<Process> processes;
+            json workload_config;
+            if (TraceImporter::isTraceFile(task.input.string())) {
+                if (!config.trace_config.contains("scheduling_type")) {
+                    throw runtime_error("Trace inputs need an algorithm (--algorithm)");
+                }
+                processes = TraceImporter::import(task.input.string(), config.trace_options);
+                workload_config = config.trace_config;
+            } else {
+                Parser parser(task.input.string());
+                processes = parser.takeProcesses();
+                workload_config = parser.getConfig();
+            }
+            if (!workload_config.contains("scheduling_type")) {
+                throw runtime_error("Missing scheduling_type field");
+            }
+            string algorithm = workload_config["scheduling_type"];
+            summary["scheduling_type"] = algorithm;
+
+            if (config.summary_only || Dispatch::metricsOnly(workload_config)) {
+                // Only the aggregates are kept, so the engine runs without building a document
+                ScheduleSummary totals;
+                Dispatch::run(algorithm, processes, workload_config, totals);
+                summary.update(totals.summary());
+                batch_totals.merge(totals);
+                summary["elapsed_ms"] = chrono::duration<double, milli>(chrono::steady_clock::now() - started).count();
+                summary["status"] = "success";
+                return summary;
+            }
+
+            if (config.format == "columnar") {
+                string output;
+                ScheduleSummary totals = runColumnar(task, algorithm, processes, workload_config, output);
+                summary.update(totals.summary());
+                summary["output"] = output;
+                batch_totals.merge(totals);
+                summary["elapsed_ms"] = chrono::duration<double, milli>(chrono::steady_clock::now() - started).count();
+                summary["status"] = "success";
+                return summary;
+            }
+
+            json result = Dispatch::schedule(algorithm, processes, workload_config);
+            if (result.contains("status") && result["status"] == "error") {
+                throw runtime_error(result.value("message", string("scheduler rejected the input")));
+            }
+            result["status"] = "success";
+            result["scheduling_algorithm"] = algorithm;
+
+            ScheduleSummary totals = summarize(result);
+            summary.update(totals.summary());
+            summary["elapsed_ms"] = chrono::duration<double, milli>(chrono::steady_clock::now() - started).count();
+
+            fs::create_directories(task.output.parent_path());
+            fs::path out_path = outputPath(task, "json");
+            ofstream out(out_path, ios::binary);
+            if (!out.is_open()) {
+                throw runtime_error("Could not open output file: " + out_path.string());
+            }
+            out << result;
+            summary["output"] = out_path.string();
+            batch_totals.merge(totals);
+            summary["status"] = "success";
+        } catch (const exception& e) {
+            summary["status"] = "error";
+            summary["message"] = e.what();
+        }
+        return summary;
+    }
+
+public:
+    // Returns one summary per input file, in input order. summary.jsonl holds the same lines and
+    // totals.json the summary of every successful file together, percentiles included.
+    static vector<json> run(BatchConfig config) {
+        if (config.format != "json" && config.format != "columnar") {
+            throw invalid_argument("Unknown output format: " + config.format);
+        }
+        vector<Task> tasks = collectTasks(config);
+        if (tasks.size() > 1) {
+            // Files already run in parallel; keep each trace import on its worker thread
+            config.trace_options.threads = 1;
+        }
+        fs::create_directories(config.output_dir);
+
+        int jobs = config.jobs > 0 ? config.jobs : max(1u, thread::hardware_concurrency());
+        jobs = static_cast<int>(min<size_t>(jobs, max<size_t>(tasks.size(), 1)));
+
+        vector<json> summaries(tasks.size());
+        vector<ScheduleSummary> worker_totals(jobs);
+        atomic<size_t> next_task(0);
+        vector<thread> workers;
+        for (int w = 0; w < jobs; w++) {
+            workers.emplace_back([&, w]() {
+                for (size_t i = next_task++; i < tasks.size(); i = next_task++) {
+                    summaries[i] = runTask(tasks[i], config, worker_totals[w]);
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        ScheduleSummary totals;
+        for (const auto& worker : worker_totals) {
+            totals.merge(worker);
+        }
+        ofstream totals_out(fs::path(config.output_dir) / "totals.json", ios::binary);
+        totals_out << totals.summary().dump(2) << "\n";
+
+        ofstream index(fs::path(config.output_dir) / "summary.jsonl", ios::binary);
+        for (const auto& summary : summaries) {
+            index << summary.dump() << "\n";
+        }
+        return summaries;
+    }
+};
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef BUFFER_TRACE_SINK_HPP
+#define BUFFER_TRACE_SINK_HPP
+#pragma once
+#include <cstdint>
+#include "cpusched.h"
+#include "../Type.hpp"
+
+using namespace std;
+
+// A trace sink (trace/JsonTraceSink.hpp) writing the rows of an int run into the buffers of a
+// cpusched_output, as plain structs. Like ColumnarTraceWriter it holds the newest segment back
+// until the next one begins, since engines may still move its end; a row nobody ended lasts until
+// the next row starts. Rows past a buffer's capacity are only counted.
+class BufferTraceSink {
+private:
+    cpusched_output& output;
+    cpusched_segment open_row = {0, 0, 0, 0};
+    bool open = false;
+    bool end_set = false;
+
+    void closeOpenSegment(int32_t next_start) {
+        if (!open) {
+            return;
+        }
+        if (!end_set) {
+            open_row.end_time = next_start;
+        }
+        if (output.segment_count < output.segment_capacity) {
+            output.segments[output.segment_count] = open_row;
+        }
+        output.segment_count++;
+        open = false;
+    }
+
+    void addProcess(const Process& p, int completion_time, int32_t extra) {
+        if (output.stat_count < output.stat_capacity) {
+            int turnaround_time = completion_time - p.arrival_time;
+            output.stats[output.stat_count] = {p.p_id, p.arrival_time, p.burst_time, p.priority, completion_time,
+                                               turnaround_time, turnaround_time - p.burst_time, extra};
+        }
+        output.stat_count++;
+    }
+
+public:
+    explicit BufferTraceSink(cpusched_output& out) : output(out) {
+        output.segment_count = 0;
+        output.stat_count = 0;
+        output.extra_name = nullptr;
+    }
+
+    template <typename Describe>
+    void beginSegment(int process_id, int start_time, int queue_level, Describe&&) {
+        closeOpenSegment(start_time);
+        open_row = {process_id, start_time, start_time, queue_level};
+        open = true;
+        end_set = false;
+    }
+
+    void endSegment(int end_time) {
+        if (open) {
+            open_row.end_time = end_time;
+            end_set = true;
+        }
+    }
+
+    void closeSegment(int end_time) {
+        if (open && !end_set) {
+            endSegment(end_time);
+        }
+    }
+
+    void completeProcess(const Process& p, int completion_time) {
+        addProcess(p, completion_time, 0);
+    }
+
+    void completeProcess(const Process& p, int completion_time, const char* extra_name, int extra_value) {
+        output.extra_name = extra_name;
+        addProcess(p, completion_time, extra_value);
+    }
+
+    void finish() {
+        closeOpenSegment(open_row.start_time);
+    }
+
+    // Whether some row did not fit
+    bool overflowed() const {
+        return output.segment_count > output.segment_capacity || output.stat_count > output.stat_capacity;
+    }
+};
+
+#endif
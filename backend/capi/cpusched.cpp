@@ -0,0 +1,205 @@
+// The C ABI of capi/cpusched.h over the engines. The whole library is this translation unit; see
+// "Embedding the schedulers" in the README for building it as a static or shared library.
+#include <climits>
+#include <cstdint>
+#include <exception>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include "cpusched.h"
+#include "BufferTraceSink.hpp"
+#include "../algorithms/AlgorithmRegistry.hpp"
+#include "../algorithms/Dispatch.hpp"
+#include "../algorithms/FCFS.hpp"
+#include "../algorithms/SJF.hpp"
+#include "../algorithms/RR.hpp"
+#include "../algorithms/Priority.hpp"
+#include "../algorithms/MLQ.hpp"
+#include "../algorithms/MLFQ.hpp"
+#include "../algorithms/MLQ_Aging.hpp"
+#include "../algorithms/SJF_Aging.hpp"
+#include "../workload/WorkloadIndex.hpp"
+
+using namespace std;
+
+namespace {
+
+// cpusched_algorithm numbers the algorithms as Algorithm and AlgorithmTable::SPECS do
+constexpr bool sameNumbering() {
+    for (size_t i = 0; i < AlgorithmTable::COUNT; i++) {
+        if (static_cast<size_t>(AlgorithmTable::SPECS[i].id) != i) {
+            return false;
+        }
+    }
+    return AlgorithmTable::COUNT == CPUSCHED_SJF_AGING + 1;
+}
+static_assert(sameNumbering(), "cpusched_algorithm is out of step with AlgorithmRegistry");
+
+thread_local string last_error;
+
+const AlgorithmSpec* specOf(cpusched_algorithm algorithm) {
+    int index = static_cast<int>(algorithm);
+    if (index < 0 || index >= static_cast<int>(AlgorithmTable::COUNT)) {
+        return nullptr;
+    }
+    return &AlgorithmTable::SPECS[index];
+}
+
+cpusched_status fail(cpusched_status status, const string& message) {
+    last_error = message;
+    return status;
+}
+
+int32_t& field(cpusched_config& config, Parameter parameter) {
+    switch (parameter) {
+    case Parameter::Quantum:
+        return config.quantum;
+    case Parameter::NumQueues:
+        return config.num_queues;
+    default:
+        return config.aging_threshold;
+    }
+}
+
+// The ranges the registry enforces on requests (ParameterSpec::check)
+void validate(const AlgorithmSpec& spec, cpusched_config config) {
+    for (size_t i = 0; i < spec.parameter_count; i++) {
+        spec.parameters[i].check(field(config, spec.parameters[i].id));
+    }
+}
+
+// The engines assume what the HTTP routes check: unique non-negative ids, arrivals from 0,
+// positive bursts and a schedule whose times fit in an int32. Priorities may be anything. The aging
+// engines refuse the workloads Dispatch::checkSpan does.
+void validate(const AlgorithmSpec& spec, const cpusched_process* processes, size_t count) {
+    if (count > UINT32_MAX) {
+        throw invalid_argument("At most " + to_string(UINT32_MAX) + " processes");
+    }
+    unordered_set<int32_t> ids;
+    ids.reserve(count);
+    int64_t last_arrival = 0;
+    int64_t total_burst = 0;
+    for (size_t i = 0; i < count; i++) {
+        const cpusched_process& p = processes[i];
+        string which = "Process " + to_string(i) + " (p_id " + to_string(p.p_id) + ")";
+        if (p.p_id < 0) {
+            throw invalid_argument(which + ": p_id must not be negative");
+        }
+        if (p.arrival_time < 0) {
+            throw invalid_argument(which + ": arrival_time must not be negative");
+        }
+        if (p.burst_time <= 0) {
+            throw invalid_argument(which + ": burst_time must be positive");
+        }
+        if (!ids.insert(p.p_id).second) {
+            throw invalid_argument(which + ": duplicate p_id");
+        }
+        last_arrival = max<int64_t>(last_arrival, p.arrival_time);
+        total_burst += p.burst_time;
+    }
+    if (last_arrival + total_burst > INT32_MAX) {
+        throw invalid_argument("The schedule would run past INT32_MAX");
+    }
+    Dispatch::checkSpan(spec, static_cast<double>(total_burst), count);
+}
+
+void schedule(const cpusched_config& config, const WorkloadIndex& workload, BufferTraceSink& sink) {
+    switch (static_cast<Algorithm>(config.algorithm)) {
+    case Algorithm::FCFS:
+        FCFS().run(workload, sink);
+        break;
+    case Algorithm::SJF:
+        SJF().run(workload, sink);
+        break;
+    case Algorithm::RR:
+        RR().run(workload, config.quantum, sink);
+        break;
+    case Algorithm::Priority:
+        Priority().run(workload, sink);
+        break;
+    case Algorithm::MLQ:
+        MLQ().run(workload, config.num_queues, config.quantum, sink);
+        break;
+    case Algorithm::MLFQ:
+        MLFQ(config.quantum, config.num_queues).run(workload, sink);
+        break;
+    case Algorithm::MLQ_Aging:
+        MLQAging().run(workload, config.num_queues, config.quantum, sink);
+        break;
+    case Algorithm::SJF_Aging:
+        SJF_Aging(config.aging_threshold).run(workload, sink);
+        break;
+    }
+    sink.finish();
+}
+
+}
+
+void cpusched_config_init(cpusched_config* config, cpusched_algorithm algorithm) {
+    if (config == nullptr) {
+        return;
+    }
+    *config = {algorithm, AlgorithmTable::QUANTUM_2.fallback, AlgorithmTable::NUM_QUEUES.fallback,
+               AlgorithmTable::AGING_THRESHOLD.fallback};
+    if (const AlgorithmSpec* spec = specOf(algorithm)) {
+        for (size_t i = 0; i < spec->parameter_count; i++) {
+            field(*config, spec->parameters[i].id) = spec->parameters[i].fallback;
+        }
+    }
+}
+
+const char* cpusched_algorithm_name(cpusched_algorithm algorithm) {
+    const AlgorithmSpec* spec = specOf(algorithm);
+    return spec != nullptr ? spec->name : nullptr;
+}
+
+cpusched_status cpusched_algorithm_from_name(const char* name, cpusched_algorithm* algorithm) {
+    const AlgorithmSpec* spec = name != nullptr ? AlgorithmRegistry::find(name) : nullptr;
+    if (spec == nullptr || algorithm == nullptr) {
+        return fail(CPUSCHED_INVALID_ARGUMENT, "Unsupported scheduling algorithm: " + string(name != nullptr ? name : "(null)"));
+    }
+    *algorithm = static_cast<cpusched_algorithm>(spec->id);
+    return CPUSCHED_OK;
+}
+
+cpusched_status cpusched_run(const cpusched_config* config, const cpusched_process* processes, size_t count,
+                             cpusched_output* output) {
+    if (config == nullptr || output == nullptr || (processes == nullptr && count > 0)) {
+        return fail(CPUSCHED_INVALID_ARGUMENT, "config, processes and output must not be null");
+    }
+    if ((output->segments == nullptr && output->segment_capacity > 0) ||
+        (output->stats == nullptr && output->stat_capacity > 0)) {
+        return fail(CPUSCHED_INVALID_ARGUMENT, "A null buffer must have capacity 0");
+    }
+    try {
+        const AlgorithmSpec* spec = specOf(config->algorithm);
+        if (spec == nullptr) {
+            throw invalid_argument("Unsupported scheduling algorithm: " + to_string(static_cast<int>(config->algorithm)));
+        }
+        validate(*spec, *config);
+        validate(*spec, processes, count);
+        BufferTraceSink sink(*output);
+        if (count > 0) {
+            schedule(*config, WorkloadIndex(processes, count), sink);
+        } else {
+            sink.finish();
+        }
+        if (sink.overflowed()) {
+            return fail(CPUSCHED_BUFFER_TOO_SMALL, "The schedule has " + to_string(output->segment_count) +
+                        " segments and " + to_string(output->stat_count) + " stats");
+        }
+        last_error.clear();
+        return CPUSCHED_OK;
+    } catch (const invalid_argument& e) {
+        return fail(CPUSCHED_INVALID_ARGUMENT, e.what());
+    } catch (const bad_alloc&) {
+        return fail(CPUSCHED_INTERNAL_ERROR, "Out of memory");
+    } catch (const exception& e) {
+        return fail(CPUSCHED_INTERNAL_ERROR, e.what());
+    }
+}
+
+const char* cpusched_last_error(void) {
+    return last_error.c_str();
+}
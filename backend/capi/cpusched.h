@@ -0,0 +1,118 @@
+#ifndef CPUSCHED_H
+#define CPUSCHED_H
+
+/*
+ * The scheduling algorithms as a library with a C ABI. There is no JSON or HTTP in it: the caller
+ * hands over an array of process records and buffers for the Gantt segments and per-process stats,
+ * and the engines write their rows straight into those buffers.
+ *
+ * Build it from backend/ as described in the README ("Embedding the schedulers"); link C callers
+ * with the C++ runtime (-lstdc++). Every function may be called from any thread; runs share nothing.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum cpusched_algorithm {
+    CPUSCHED_FCFS = 0,
+    CPUSCHED_SJF = 1,
+    CPUSCHED_RR = 2,
+    CPUSCHED_PRIORITY = 3,
+    CPUSCHED_MLQ = 4,
+    CPUSCHED_MLFQ = 5,
+    CPUSCHED_MLQ_AGING = 6,
+    CPUSCHED_SJF_AGING = 7
+} cpusched_algorithm;
+
+typedef enum cpusched_status {
+    CPUSCHED_OK = 0,
+    /* A bad algorithm or parameter, or a null pointer; see cpusched_last_error() */
+    CPUSCHED_INVALID_ARGUMENT = 1,
+    /* The schedule did not fit; the counts in the output say how many rows it has */
+    CPUSCHED_BUFFER_TOO_SMALL = 2,
+    CPUSCHED_INTERNAL_ERROR = 3
+} cpusched_status;
+
+typedef struct cpusched_process {
+    int32_t p_id;
+    int32_t arrival_time;
+    int32_t burst_time;
+    int32_t priority;
+} cpusched_process;
+
+/* A Gantt row; process_id and queue_level are -1 for idle time, queue_level 0 in single-queue algorithms */
+typedef struct cpusched_segment {
+    int32_t process_id;
+    int32_t start_time;
+    int32_t end_time;
+    int32_t queue_level;
+} cpusched_segment;
+
+/* A completed process. extra holds the value named by cpusched_output.extra_name, 0 if there is none. */
+typedef struct cpusched_stat {
+    int32_t process_id;
+    int32_t arrival_time;
+    int32_t burst_time;
+    int32_t priority;
+    int32_t completion_time;
+    int32_t turnaround_time;
+    int32_t waiting_time;
+    int32_t extra;
+} cpusched_stat;
+
+/* Parameters an algorithm does not take are ignored. cpusched_config_init() fills in the defaults. */
+typedef struct cpusched_config {
+    cpusched_algorithm algorithm;
+    int32_t quantum;
+    int32_t num_queues;
+    int32_t aging_threshold;
+} cpusched_config;
+
+/*
+ * Caller-owned buffers and, after a run, what was written to them. Either buffer may be null with
+ * capacity 0, e.g. to learn the counts first. Rows go in the order the HTTP routes return them.
+ */
+typedef struct cpusched_output {
+    cpusched_segment* segments;
+    size_t segment_capacity;
+    cpusched_stat* stats;
+    size_t stat_capacity;
+
+    /* Set by cpusched_run(). The counts are of the whole schedule, even past the capacities. */
+    size_t segment_count;
+    size_t stat_count;
+    /* "queue", "final_queue_level", "final_queue", "aging_wait_time" or null; a static string */
+    const char* extra_name;
+} cpusched_output;
+
+/* The defaults the HTTP routes use for algorithm's parameters */
+void cpusched_config_init(cpusched_config* config, cpusched_algorithm algorithm);
+
+/* The algorithm's name as in requests ("FCFS", "MLQ_Aging", ...), null for an unknown one */
+const char* cpusched_algorithm_name(cpusched_algorithm algorithm);
+
+/* The algorithm with that name; CPUSCHED_INVALID_ARGUMENT if there is none */
+cpusched_status cpusched_algorithm_from_name(const char* name, cpusched_algorithm* algorithm);
+
+/*
+ * Schedules count processes. p_ids must be unique and not negative, arrival times not negative,
+ * burst times positive, and the last arrival plus all bursts must fit in an int32; otherwise the
+ * run returns CPUSCHED_INVALID_ARGUMENT without touching the buffers. Any priority is accepted.
+ * Rows past a buffer's capacity are counted but not written, and the
+ * run returns CPUSCHED_BUFFER_TOO_SMALL; the rows that were written are the schedule's first ones.
+ */
+cpusched_status cpusched_run(const cpusched_config* config, const cpusched_process* processes, size_t count,
+                             cpusched_output* output);
+
+/* Why this thread's last call failed, or "" */
+const char* cpusched_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef BATCH_COMMAND_HPP
+#define BATCH_COMMAND_HPP
+#pragma once
+#include <iostream>
+#include <string>
+#include "CommandLine.hpp"
+#include "ImportCommand.hpp"
+#include "../batch/BatchRunner.hpp"
+
+using namespace std;
+
+// ./main batch [options] PATH...  -- schedules workload files offline, in parallel
+class BatchCommand {
+public:
+    static void usage(ostream& out) {
+        out << "Usage: main batch [options] FILE_OR_DIR...\n"
+            << "  Each *.json input is shaped like io/*.json and run with its scheduling_type.\n"
+            << "  --output DIR           output directory (default batch_output)\n"
+            << "  --jobs N               files processed concurrently (default: all cores)\n"
+            << "  --summary-only         write only summary.jsonl and totals.json, not per-file results\n"
+            << "  --format json|columnar per-file results as JSON or as columnar .ctrace files\n"
+            << "  --algorithm NAME       also schedule *.swf / *.csv traces with this algorithm;\n"
+            << "                         --quantum, --num-queues, --aging-threshold and the import\n"
+            << "                         options of 'main import' apply to them\n";
+    }
+
+    static int run(int argc, char* argv[]) {
+        try {
+            set<string> options = ImportCommand::traceOptions();
+            options.insert({"output", "jobs"});
+            CommandLine cli(argc, argv, {"help", "summary-only", "no-rebase"}, options);
+            if (cli.has("help") || cli.args().empty()) {
+                usage(cli.has("help") ? cout : cerr);
+                return cli.has("help") ? 0 : 1;
+            }
+
+            BatchConfig config;
+            config.inputs = cli.args();
+            config.output_dir = cli.get("output", config.output_dir);
+            config.jobs = static_cast<int>(cli.getInt("jobs", 0));
+            config.summary_only = cli.has("summary-only");
+            config.format = cli.get("format", config.format);
+            if (cli.has("algorithm")) {
+                config.trace_config = ImportCommand::headerFrom(cli);
+                config.trace_options = ImportCommand::optionsFrom(cli);
+            }
+
+            vector<json> summaries = BatchRunner::run(config);
+
+            size_t failed = 0;
+            for (const auto& summary : summaries) {
+                if (summary["status"] != "success") {
+                    failed++;
+                    cerr << summary["input"].get<string>() << ": " << summary.value("message", string("failed")) << "\n";
+                }
+            }
+            cout << "Scheduled " << summaries.size() - failed << " of " << summaries.size()
+                 << " files; summaries in " << config.output_dir << "/summary.jsonl and totals.json\n";
+            return failed == 0 ? 0 : 2;
+        } catch (const exception& e) {
+            cerr << "batch: " << e.what() << "\n";
+            return 1;
+        }
+    }
+};
+
+#endif
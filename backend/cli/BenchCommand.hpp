@@ -0,0 +1,180 @@
+#ifndef BENCH_COMMAND_HPP
+#define BENCH_COMMAND_HPP
+#pragma once
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "CommandLine.hpp"
+#include "../json.hpp"
+#include "../metrics/ScheduleSummary.hpp"
+#include "../metrics/StatsKernels.hpp"
+
+using namespace std;
+
+// ./main bench [options]  -- times the StatsKernels per instruction set against the scalar versions,
+// and ScheduleSummary fed a column at a time against one process at a time
+class BenchCommand {
+private:
+    struct Columns {
+        vector<int32_t> p_ids, arrival, burst, completion;
+    };
+
+    // Completed processes with up to 10000 units of waiting each
+    static Columns workload(size_t n, unsigned seed) {
+        mt19937 rng(seed);
+        uniform_int_distribution<int32_t> burst(1, 100);
+        uniform_int_distribution<int32_t> wait(0, 10000);
+        Columns columns;
+        for (size_t i = 0; i < n; i++) {
+            int32_t arrival = static_cast<int32_t>(i / 4);
+            columns.p_ids.push_back(static_cast<int32_t>(i + 1));
+            columns.arrival.push_back(arrival);
+            columns.burst.push_back(burst(rng));
+            columns.completion.push_back(arrival + columns.burst.back() + wait(rng));
+        }
+        return columns;
+    }
+
+    // Nanoseconds per process of the fastest of repeat runs of f
+    template <typename F>
+    static double time(size_t n, int repeat, F&& f) {
+        double best = 0;
+        for (int r = 0; r < repeat; r++) {
+            auto started = chrono::steady_clock::now();
+            f();
+            double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - started).count();
+            best = r == 0 ? ns : min(best, ns);
+        }
+        return best / max<size_t>(n, 1);
+    }
+
+    static void printTable(ostream& out, const nlohmann::json& report) {
+        out << report["processes"] << " processes, best of " << report["repeat"] << ", cpu runs "
+            << report["best_isa"].get<string>() << "\n\n"
+            << left << setw(20) << "kernel" << setw(10) << "isa" << right << setw(14) << "ns/process"
+            << setw(10) << "speedup" << "\n";
+        for (const auto& row : report["kernels"]) {
+            out << left << setw(20) << row["kernel"].get<string>() << setw(10) << row["isa"].get<string>() << right
+                << fixed << setprecision(3) << setw(14) << row["ns_per_process"].get<double>()
+                << setprecision(2) << setw(9) << row["speedup"].get<double>() << "x\n";
+        }
+        out << "\nresults match across instruction sets: " << (report["consistent"].get<bool>() ? "yes" : "NO") << "\n";
+    }
+
+public:
+    static void usage(ostream& out) {
+        out << "Usage: main bench [options]\n"
+            << "  --processes N   processes per run (default 4000000)\n"
+            << "  --repeat R      runs per measurement, the fastest is reported (default 5)\n"
+            << "  --seed S        workload seed (default 1)\n"
+            << "  --json          print the report as JSON\n";
+    }
+
+    static int run(int argc, char* argv[]) {
+        try {
+            CommandLine cli(argc, argv, {"help", "json"}, {"processes", "repeat", "seed"});
+            if (cli.has("help")) {
+                usage(cout);
+                return 0;
+            }
+            long long processes = cli.getInt("processes", 4000000);
+            int repeat = static_cast<int>(cli.getInt("repeat", 5));
+            if (processes <= 0 || repeat <= 0) {
+                throw invalid_argument("--processes and --repeat must be positive");
+            }
+            size_t n = static_cast<size_t>(processes);
+            Columns columns = workload(n, static_cast<unsigned>(cli.getInt("seed", 1)));
+
+            vector<KernelIsa> isas;
+            for (KernelIsa isa : {KernelIsa::Scalar, KernelIsa::AVX2, KernelIsa::AVX512}) {
+                if (StatsKernels::supported(isa)) {
+                    isas.push_back(isa);
+                }
+            }
+
+            nlohmann::json kernels = nlohmann::json::array();
+            bool consistent = true;
+            auto add = [&](const string& kernel, const string& isa, double ns, double baseline) {
+                kernels.push_back({{"kernel", kernel}, {"isa", isa}, {"ns_per_process", ns},
+                                   {"speedup", ns > 0 ? baseline / ns : 0.0}});
+            };
+
+            vector<int32_t> turnaround(n), waiting(n), expected_turnaround, expected_waiting;
+            vector<uint16_t> buckets(n), expected_buckets;
+            ColumnStats expected_stats;
+            double derive_base = 0, reduce_base = 0, buckets_base = 0;
+            for (KernelIsa isa : isas) {
+                double ns = time(n, repeat, [&] {
+                    StatsKernels::derive(columns.arrival.data(), columns.burst.data(), columns.completion.data(), n,
+                                         turnaround.data(), waiting.data(), isa);
+                });
+                derive_base = isa == KernelIsa::Scalar ? ns : derive_base;
+                add("derive", StatsKernels::name(isa), ns, derive_base);
+
+                ColumnStats stats;
+                ns = time(n, repeat, [&] { stats = StatsKernels::reduce(waiting.data(), n, isa); });
+                reduce_base = isa == KernelIsa::Scalar ? ns : reduce_base;
+                add("reduce", StatsKernels::name(isa), ns, reduce_base);
+
+                ns = time(n, repeat, [&] {
+                    StatsKernels::buckets(waiting.data(), n, 7, buckets.data(), isa);
+                });
+                buckets_base = isa == KernelIsa::Scalar ? ns : buckets_base;
+                add("histogram buckets", StatsKernels::name(isa), ns, buckets_base);
+
+                if (isa == KernelIsa::Scalar) {
+                    expected_turnaround = turnaround;
+                    expected_waiting = waiting;
+                    expected_buckets = buckets;
+                    expected_stats = stats;
+                } else {
+                    consistent = consistent && turnaround == expected_turnaround && waiting == expected_waiting &&
+                                 buckets == expected_buckets && stats.sum == expected_stats.sum &&
+                                 stats.min == expected_stats.min && stats.max == expected_stats.max;
+                }
+            }
+
+            // The whole summary, as BatchRunner builds it from a .ctrace file
+            nlohmann::json per_row, per_column;
+            double row_ns = time(n, repeat, [&] {
+                ScheduleSummary summary;
+                for (size_t i = 0; i < n; i++) {
+                    summary.completeProcess(Process{columns.p_ids[i], columns.arrival[i], columns.burst[i], 0},
+                                            columns.completion[i]);
+                }
+                per_row = summary.summary();
+            });
+            add("summary", "per row", row_ns, row_ns);
+            double column_ns = time(n, repeat, [&] {
+                ScheduleSummary summary;
+                summary.completeProcesses(columns.p_ids.data(), columns.arrival.data(), columns.burst.data(),
+                                          columns.completion.data(), n);
+                per_column = summary.summary();
+            });
+            add("summary", StatsKernels::name(StatsKernels::best()), column_ns, row_ns);
+            consistent = consistent && per_row == per_column;
+
+            nlohmann::json report = {
+                {"processes", n},
+                {"repeat", repeat},
+                {"best_isa", StatsKernels::name(StatsKernels::best())},
+                {"kernels", kernels},
+                {"consistent", consistent}
+            };
+            if (cli.has("json")) {
+                cout << report.dump(2) << "\n";
+            } else {
+                printTable(cout, report);
+            }
+            return consistent ? 0 : 1;
+        } catch (const exception& e) {
+            cerr << "bench: " << e.what() << "\n";
+            return 1;
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef COMMAND_LINE_HPP
+#define COMMAND_LINE_HPP
+#pragma once
+#include <charconv>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <system_error>
+#include "../Type.hpp"
+
+using namespace std;
+
+// Minimal "--key value" / "--flag" argument parser shared by the subcommands in main.cpp. Each
+// subcommand declares its options; any other is refused rather than ignored.
+class CommandLine {
+private:
+    map<string, string> options;
+    set<string> flags;
+    vector<string> positional;
+
+    // The whole of text as a T, or false
+    template <typename T>
+    static bool parse(const string& text, T& value) {
+        const char* end = text.data() + text.size();
+        auto [ptr, ec] = from_chars(text.data(), end, value);
+        return ec == errc() && ptr == end && !text.empty();
+    }
+
+public:
+    // flag_names lists the options that take no value, option_names those that take one
+    CommandLine(int argc, char* argv[], const set<string>& flag_names, const set<string>& option_names) {
+        for (int i = 1; i < argc; i++) {
+            string arg = argv[i];
+            if (arg.rfind("--", 0) != 0) {
+                positional.push_back(arg);
+                continue;
+            }
+
+            string key = arg.substr(2);
+            size_t eq = key.find('=');
+            string name = key.substr(0, eq);
+            if (flag_names.count(name) == 0 && option_names.count(name) == 0) {
+                throw runtime_error("Unknown option --" + name);
+            }
+            if (eq != string::npos) {
+                options[name] = key.substr(eq + 1);
+            } else if (flag_names.count(key)) {
+                flags.insert(key);
+            } else if (i + 1 < argc) {
+                options[key] = argv[++i];
+            } else {
+                throw runtime_error("Missing value for option --" + key);
+            }
+        }
+    }
+
+    bool has(const string& key) const {
+        return options.count(key) > 0 || flags.count(key) > 0;
+    }
+
+    string get(const string& key, const string& fallback) const {
+        auto it = options.find(key);
+        return it == options.end() ? fallback : it->second;
+    }
+
+    long long getInt(const string& key, long long fallback) const {
+        auto it = options.find(key);
+        if (it == options.end()) {
+            return fallback;
+        }
+        return toInt(it->second, "Option --" + key);
+    }
+
+    double getDouble(const string& key, double fallback) const {
+        auto it = options.find(key);
+        if (it == options.end()) {
+            return fallback;
+        }
+        double value;
+        if (!parse(it->second, value)) {
+            throw runtime_error("Option --" + key + " expects a number, got: " + it->second);
+        }
+        return value;
+    }
+
+    // text as an integer, all of it; what names it in the error
+    static long long toInt(const string& text, const string& what) {
+        long long value;
+        if (!parse(text, value)) {
+            throw runtime_error(what + " expects an integer, got: " + text);
+        }
+        return value;
+    }
+
+    const vector<string>& args() const {
+        return positional;
+    }
+};
+
+#endif
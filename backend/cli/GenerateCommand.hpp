@@ -0,0 +1,106 @@
+#ifndef GENERATE_COMMAND_HPP
+#define GENERATE_COMMAND_HPP
+#pragma once
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "CommandLine.hpp"
+#include "../json.hpp"
+#include "../workload/WorkloadGenerator.hpp"
+#include "../workload/WorkloadWriter.hpp"
+
+using namespace std;
+
+// ./main generate [options]  -- writes a seeded synthetic workload shaped like io/*.json
+class GenerateCommand {
+public:
+    static void usage(ostream& out) {
+        out << "Usage: main generate [options]\n"
+            << "  --seed N                 RNG seed (default 1)\n"
+            << "  --count N                number of processes (default 100)\n"
+            << "  --arrival KIND           poisson | uniform | fixed | bursty (default poisson)\n"
+            << "  --rate R                 mean arrivals per time unit (default 0.5)\n"
+            << "  --cluster-size N         bursty: mean jobs per cluster (default 8)\n"
+            << "  --cluster-speedup F      bursty: rate multiplier inside a cluster (default 10)\n"
+            << "  --burst KIND             fixed | uniform | exponential | lognormal | pareto | bimodal\n"
+            << "  --burst-mean M           mean burst time (default 8)\n"
+            << "  --burst-sigma S          lognormal shape (default 1)\n"
+            << "  --burst-alpha A          pareto shape (default 1.5)\n"
+            << "  --long-fraction F        bimodal: share of long jobs (default 0.1)\n"
+            << "  --long-mean M            bimodal: mean burst of long jobs (default 80)\n"
+            << "  --burst-min N --burst-max N   clamp range of burst times (default 1..1000)\n"
+            << "  --priority KIND          fixed | uniform | zipf (default uniform)\n"
+            << "  --priority-levels N      priorities drawn from [0, N) (default 5)\n"
+            << "  --zipf-s S               zipf exponent (default 1)\n"
+            << "  --correlation C          burst/priority correlation in [-1, 1] (default 0)\n"
+            << "  --algorithm NAME         scheduling_type written to the file (default FCFS)\n"
+            << "  --quantum N --num-queues N --aging-threshold N   optional algorithm parameters\n"
+            << "  --output FILE            output path (default stdout)\n";
+    }
+
+    static int run(int argc, char* argv[]) {
+        try {
+            CommandLine cli(argc, argv, {"help"},
+                            {"seed", "count", "arrival", "rate", "cluster-size", "cluster-speedup", "burst", "burst-mean",
+                             "burst-sigma", "burst-alpha", "long-fraction", "long-mean", "burst-min", "burst-max",
+                             "priority", "priority-levels", "zipf-s", "correlation", "algorithm", "quantum",
+                             "num-queues", "aging-threshold", "output"});
+            if (cli.has("help")) {
+                usage(cout);
+                return 0;
+            }
+
+            WorkloadConfig config;
+            config.seed = static_cast<uint64_t>(cli.getInt("seed", 1));
+            config.count = cli.getInt("count", config.count);
+            config.arrival = cli.get("arrival", config.arrival);
+            config.arrival_rate = cli.getDouble("rate", config.arrival_rate);
+            config.cluster_size = cli.getDouble("cluster-size", config.cluster_size);
+            config.cluster_speedup = cli.getDouble("cluster-speedup", config.cluster_speedup);
+            config.burst = cli.get("burst", config.burst);
+            config.burst_mean = cli.getDouble("burst-mean", config.burst_mean);
+            config.burst_sigma = cli.getDouble("burst-sigma", config.burst_sigma);
+            config.burst_alpha = cli.getDouble("burst-alpha", config.burst_alpha);
+            config.long_job_fraction = cli.getDouble("long-fraction", config.long_job_fraction);
+            config.long_job_mean = cli.getDouble("long-mean", config.long_job_mean);
+            config.burst_min = static_cast<int>(cli.getInt("burst-min", config.burst_min));
+            config.burst_max = static_cast<int>(cli.getInt("burst-max", config.burst_max));
+            config.priority = cli.get("priority", config.priority);
+            config.priority_levels = static_cast<int>(cli.getInt("priority-levels", config.priority_levels));
+            config.zipf_s = cli.getDouble("zipf-s", config.zipf_s);
+            config.correlation = cli.getDouble("correlation", config.correlation);
+
+            nlohmann::json header;
+            header["scheduling_type"] = cli.get("algorithm", "FCFS");
+            if (cli.has("quantum")) {
+                header["quantum"] = cli.getInt("quantum", 2);
+            }
+            if (cli.has("num-queues")) {
+                header["num_queues"] = cli.getInt("num-queues", 3);
+            }
+            if (cli.has("aging-threshold")) {
+                header["aging_threshold"] = cli.getInt("aging-threshold", 50);
+            }
+
+            WorkloadGenerator generator(config);
+            string output = cli.get("output", "-");
+            if (output == "-") {
+                WorkloadWriter::writeJson(cout, generator, header);
+                cout.flush();
+            } else {
+                ofstream file(output, ios::binary);
+                if (!file.is_open()) {
+                    throw runtime_error("Could not open output file: " + output);
+                }
+                WorkloadWriter::writeJson(file, generator, header);
+            }
+            return 0;
+        } catch (const exception& e) {
+            cerr << "generate: " << e.what() << "\n";
+            usage(cerr);
+            return 1;
+        }
+    }
+};
+
+#endif
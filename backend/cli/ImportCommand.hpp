@@ -0,0 +1,130 @@
+#ifndef IMPORT_COMMAND_HPP
+#define IMPORT_COMMAND_HPP
+#pragma once
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include "CommandLine.hpp"
+#include "../json.hpp"
+#include "../workload/TraceImporter.hpp"
+#include "../workload/WorkloadWriter.hpp"
+
+using namespace std;
+
+// ./main import [options] TRACE  -- converts an SWF log or cluster CSV export into an io/*.json workload
+class ImportCommand {
+public:
+    static void usage(ostream& out) {
+        out << "Usage: main import [options] TRACE\n"
+            << "  --format swf|csv          input format (default: by extension, .csv or swf)\n"
+            << "  --time-scale F            multiply trace times by F (default 1)\n"
+            << "  --no-rebase               keep absolute submit times instead of starting at 0\n"
+            << "  --priority-field NAME     swf: queue | partition | user | group | none (default queue)\n"
+            << "  --status LIST             swf: keep only these status codes, e.g. 1\n"
+            << "  --priorities LIST         keep only these priorities, e.g. 0,1\n"
+            << "  --from T --to T           keep jobs submitted in [from, to] (trace units)\n"
+            << "  --min-runtime T           keep jobs running longer than T (default 0)\n"
+            << "  --max-runtime T           keep jobs running at most T\n"
+            << "  --limit N                 keep the first N matching jobs\n"
+            << "  --threads N               parser threads (default: all cores)\n"
+            << "  --delimiter C             csv field delimiter (default ,)\n"
+            << "  --id-column --submit-column --runtime-column --priority-column NAME\n"
+            << "                            csv column names (default: common spellings)\n"
+            << "  --algorithm NAME          scheduling_type written to the file (default FCFS)\n"
+            << "  --quantum N --num-queues N --aging-threshold N   optional algorithm parameters\n"
+            << "  --output FILE             output path (default stdout)\n";
+    }
+
+    // The options optionsFrom and headerFrom read, which 'main batch' takes as well
+    static set<string> traceOptions() {
+        return {"format", "time-scale", "priority-field", "status", "priorities", "from", "to", "min-runtime",
+                "max-runtime", "limit", "threads", "delimiter", "id-column", "submit-column", "runtime-column",
+                "priority-column", "algorithm", "quantum", "num-queues", "aging-threshold"};
+    }
+
+    static vector<long long> parseList(const CommandLine& cli, const string& key) {
+        vector<long long> values;
+        stringstream stream(cli.get(key, ""));
+        string item;
+        while (getline(stream, item, ',')) {
+            if (!item.empty()) {
+                values.push_back(CommandLine::toInt(item, "Option --" + key));
+            }
+        }
+        return values;
+    }
+
+    static TraceImportOptions optionsFrom(const CommandLine& cli) {
+        TraceImportOptions options;
+        options.format = cli.get("format", "");
+        options.time_scale = cli.getDouble("time-scale", options.time_scale);
+        options.rebase = !cli.has("no-rebase");
+        options.priority_field = cli.get("priority-field", options.priority_field);
+        options.statuses = parseList(cli, "status");
+        options.priorities = parseList(cli, "priorities");
+        options.submit_from = cli.getDouble("from", options.submit_from);
+        options.submit_to = cli.getDouble("to", options.submit_to);
+        options.min_runtime = cli.getDouble("min-runtime", options.min_runtime);
+        options.max_runtime = cli.getDouble("max-runtime", options.max_runtime);
+        options.limit = cli.getInt("limit", 0);
+        options.threads = static_cast<int>(cli.getInt("threads", 0));
+        string delimiter = cli.get("delimiter", ",");
+        options.delimiter = delimiter == "\\t" ? '\t' : delimiter[0];
+        options.id_column = cli.get("id-column", "");
+        options.submit_column = cli.get("submit-column", "");
+        options.runtime_column = cli.get("runtime-column", "");
+        options.priority_column = cli.get("priority-column", "");
+        return options;
+    }
+
+    static nlohmann::json headerFrom(const CommandLine& cli) {
+        nlohmann::json header;
+        header["scheduling_type"] = cli.get("algorithm", "FCFS");
+        if (cli.has("quantum")) {
+            header["quantum"] = cli.getInt("quantum", 2);
+        }
+        if (cli.has("num-queues")) {
+            header["num_queues"] = cli.getInt("num-queues", 3);
+        }
+        if (cli.has("aging-threshold")) {
+            header["aging_threshold"] = cli.getInt("aging-threshold", 50);
+        }
+        return header;
+    }
+
+    static int run(int argc, char* argv[]) {
+        try {
+            set<string> options = traceOptions();
+            options.insert("output");
+            CommandLine cli(argc, argv, {"help", "no-rebase"}, options);
+            if (cli.has("help") || cli.args().size() != 1) {
+                usage(cli.has("help") ? cout : cerr);
+                return cli.has("help") ? 0 : 1;
+            }
+
+            vector<Process> processes = TraceImporter::import(cli.args()[0], optionsFrom(cli));
+            nlohmann::json header = headerFrom(cli);
+
+            string output = cli.get("output", "-");
+            if (output == "-") {
+                WorkloadWriter::writeJson(cout, processes, header);
+                cout.flush();
+            } else {
+                ofstream file(output, ios::binary);
+                if (!file.is_open()) {
+                    throw runtime_error("Could not open output file: " + output);
+                }
+                WorkloadWriter::writeJson(file, processes, header);
+                cerr << "Imported " << processes.size() << " jobs into " << output << "\n";
+            }
+            return 0;
+        } catch (const exception& e) {
+            cerr << "import: " << e.what() << "\n";
+            return 1;
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef INSPECT_COMMAND_HPP
+#define INSPECT_COMMAND_HPP
+#pragma once
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "CommandLine.hpp"
+#include "../trace/ColumnarTrace.hpp"
+
+using namespace std;
+
+// ./main inspect [options] FILE.ctrace  -- describes a columnar schedule file or exports a table as CSV
+class InspectCommand {
+private:
+    static const char* encodingName(ChunkEncoding encoding) {
+        switch (encoding) {
+            case ChunkEncoding::Dictionary8: return "dict8";
+            case ChunkEncoding::Dictionary16: return "dict16";
+            default: return "plain";
+        }
+    }
+
+    static vector<vector<int32_t>> load(const ColumnarTraceReader& trace, TraceTable table) {
+        vector<vector<int32_t>> columns;
+        for (const auto& name : trace.columns(table)) {
+            columns.push_back(trace.column(table, name));
+        }
+        return columns;
+    }
+
+    static void printCsv(ostream& out, const ColumnarTraceReader& trace, TraceTable table) {
+        const auto& names = trace.columns(table);
+        vector<vector<int32_t>> columns = load(trace, table);
+        for (size_t c = 0; c < names.size(); c++) {
+            out << (c ? "," : "") << names[c];
+        }
+        out << "\n";
+        for (uint64_t r = 0; r < trace.rows(table); r++) {
+            for (size_t c = 0; c < columns.size(); c++) {
+                out << (c ? "," : "") << columns[c][r];
+            }
+            out << "\n";
+        }
+    }
+
+    static void printTable(ostream& out, const ColumnarTraceReader& trace, TraceTable table, uint64_t limit) {
+        const auto& names = trace.columns(table);
+        vector<vector<int32_t>> columns = load(trace, table);
+        for (const auto& name : names) {
+            out << setw(16) << name;
+        }
+        out << "\n";
+        for (uint64_t r = 0; r < min<uint64_t>(limit, trace.rows(table)); r++) {
+            for (const auto& column : columns) {
+                out << setw(16) << column[r];
+            }
+            out << "\n";
+        }
+    }
+
+public:
+    static void usage(ostream& out) {
+        out << "Usage: main inspect [options] FILE.ctrace\n"
+            << "  --rows N                  rows of each table to print (default 10)\n"
+            << "  --csv segments|processes  write the whole table as CSV instead\n";
+    }
+
+    static int run(int argc, char* argv[]) {
+        try {
+            CommandLine cli(argc, argv, {"help"}, {"csv", "rows"});
+            if (cli.has("help") || cli.args().size() != 1) {
+                usage(cli.has("help") ? cout : cerr);
+                return cli.has("help") ? 0 : 1;
+            }
+
+            ColumnarTraceReader trace(cli.args()[0]);
+            if (cli.has("csv")) {
+                string table = cli.get("csv", "");
+                if (table != "segments" && table != "processes") {
+                    throw invalid_argument("--csv takes segments or processes");
+                }
+                printCsv(cout, trace, table == "segments" ? TraceTable::Segments : TraceTable::Processes);
+                return 0;
+            }
+
+            cout << "metadata: " << trace.metadata().dump() << "\n"
+                 << "segments: " << trace.rows(TraceTable::Segments) << " rows\n"
+                 << "processes: " << trace.rows(TraceTable::Processes) << " rows\n\n";
+
+            for (const auto& chunk : trace.chunkList()) {
+                cout << (chunk.table == TraceTable::Segments ? "segments." : "processes.")
+                     << trace.columns(chunk.table)[chunk.column] << " @" << chunk.offset << ": " << chunk.rows
+                     << " rows, " << encodingName(chunk.encoding) << ", " << chunk.length << " bytes\n";
+            }
+
+            uint64_t limit = static_cast<uint64_t>(cli.getInt("rows", 10));
+            cout << "\n";
+            printTable(cout, trace, TraceTable::Segments, limit);
+            cout << "\n";
+            printTable(cout, trace, TraceTable::Processes, limit);
+            return 0;
+        } catch (const exception& e) {
+            cerr << "inspect: " << e.what() << "\n";
+            return 1;
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,121 @@
+#ifndef LOAD_TEST_COMMAND_HPP
+#define LOAD_TEST_COMMAND_HPP
+#pragma once
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "CommandLine.hpp"
+#include "../APIHandler/APIHandler.hpp"
+#include "../loadtest/LoadGenerator.hpp"
+
+using namespace std;
+
+// ./main loadtest [options]  -- closed-loop HTTP load against a running (or in-process) server
+class LoadTestCommand {
+public:
+    static void usage(ostream& out) {
+        out << "Usage: main loadtest [options]\n"
+            << "  --host H               server address (default 127.0.0.1)\n"
+            << "  --port P               server port (default 18080)\n"
+            << "  --connections N        keep-alive connections (default 16)\n"
+            << "  --threads N            client io threads (default 1)\n"
+            << "  --rate R               target requests/s over all connections; 0 = unthrottled (default 0)\n"
+            << "  --duration S           measured seconds (default 10)\n"
+            << "  --warmup S             seconds excluded from the statistics (default 2)\n"
+            << "  --seed N               seed for request bodies and the mix (default 1)\n"
+            << "  --mix FILE             JSON array of {name, method, path, weight, processes, body}\n"
+            << "  --scale F              multiply every workload size in the mix (default 1)\n"
+            << "  --spawn-server         start the API server in this process on --port first\n"
+            << "  --json                 print the report as JSON\n";
+    }
+
+    static void printTable(ostream& out, const nlohmann::json& report) {
+        char line[256];
+        snprintf(line, sizeof(line), "%-12s %10s %8s %7s %9s %10s %10s %10s %10s %10s\n",
+                 "request", "completed", "non-2xx", "errors", "abandoned", "p50(us)", "p99(us)", "p999(us)", "max(us)", "svc p99");
+        out << line;
+
+        auto row = [&](const string& name, const nlohmann::json& r) {
+            snprintf(line, sizeof(line), "%-12s %10llu %8llu %7llu %9llu %10llu %10llu %10llu %10llu %10llu\n",
+                     name.c_str(),
+                     r["completed"].get<unsigned long long>(),
+                     r["non_2xx"].get<unsigned long long>(),
+                     r["errors"].get<unsigned long long>(),
+                     r["abandoned"].get<unsigned long long>(),
+                     r["latency_us"]["p50"].get<unsigned long long>(),
+                     r["latency_us"]["p99"].get<unsigned long long>(),
+                     r["latency_us"]["p999"].get<unsigned long long>(),
+                     r["latency_us"]["max"].get<unsigned long long>(),
+                     r["service_time_us"]["p99"].get<unsigned long long>());
+            out << line;
+        };
+
+        for (const auto& r : report["requests"]) {
+            row(r["name"].get<string>(), r);
+        }
+        row("total", report);
+        out << "throughput: " << report["throughput_rps"].get<double>() << " req/s over "
+            << report["duration_seconds"].get<double>() << " s\n";
+    }
+
+    static int run(int argc, char* argv[]) {
+        try {
+            CommandLine cli(argc, argv, {"help", "spawn-server", "json"},
+                            {"host", "port", "connections", "threads", "rate", "duration", "warmup", "seed", "scale", "mix"});
+            if (cli.has("help")) {
+                usage(cout);
+                return 0;
+            }
+
+            LoadConfig config;
+            config.host = cli.get("host", config.host);
+            config.port = static_cast<int>(cli.getInt("port", config.port));
+            config.connections = static_cast<int>(cli.getInt("connections", config.connections));
+            config.threads = static_cast<int>(cli.getInt("threads", config.threads));
+            config.rate = cli.getDouble("rate", config.rate);
+            config.duration_seconds = cli.getDouble("duration", config.duration_seconds);
+            config.warmup_seconds = cli.getDouble("warmup", config.warmup_seconds);
+            config.seed = static_cast<uint64_t>(cli.getInt("seed", 1));
+
+            double scale = cli.getDouble("scale", 1.0);
+            if (cli.has("mix")) {
+                ifstream file(cli.get("mix", ""));
+                if (!file.is_open()) {
+                    throw runtime_error("Could not open mix file: " + cli.get("mix", ""));
+                }
+                config.mix = LoadGenerator::mixFromJson(nlohmann::json::parse(file), config.host, config.seed, scale);
+            } else {
+                config.mix = LoadGenerator::defaultMix(config.host, config.seed, scale);
+            }
+
+            unique_ptr<APIHandler> server;
+            future<void> server_thread;
+            if (cli.has("spawn-server")) {
+                crow::logger::setLogLevel(crow::LogLevel::Warning);
+                server = make_unique<APIHandler>();
+                server_thread = server->runAsync(config.port);
+            }
+
+            vector<LoadStats> results = LoadGenerator::run(config);
+            nlohmann::json report = LoadGenerator::report(config, results);
+
+            if (server) {
+                server->stop();
+                server_thread.wait();
+            }
+
+            if (cli.has("json")) {
+                cout << report.dump(2) << "\n";
+            } else {
+                printTable(cout, report);
+            }
+            return 0;
+        } catch (const exception& e) {
+            cerr << "loadtest: " << e.what() << "\n";
+            return 1;
+        }
+    }
+};
+
+#endif
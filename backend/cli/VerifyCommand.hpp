@@ -0,0 +1,200 @@
+#ifndef VERIFY_COMMAND_HPP
+#define VERIFY_COMMAND_HPP
+#pragma once
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "CommandLine.hpp"
+#include "../json.hpp"
+#include "../Type.hpp"
+#include "../algorithms/AlgorithmRegistry.hpp"
+#include "../algorithms/Dispatch.hpp"
+#include "../algorithms/Rescheduler.hpp"
+#include "../trace/JsonStreamSink.hpp"
+#include "../workload/WorkloadGenerator.hpp"
+
+using namespace std;
+
+// ./main verify [options]  -- schedules seeded workloads with every algorithm and checks that the
+// faster paths give the document of a full Dispatch::schedule run, byte for byte:
+//   resume    Rescheduler resuming a retained run after each of a series of edits
+//   chunked   JsonStreamSink's chunks, as ?stream=1 sends them
+//   int64     the same workload simulated with 64-bit times
+//   double    and with double times, compared by value (MLFQ's idle rows merged for both, as over
+//             these types one idle row lasts until the next arrival; see MLFQ.hpp)
+// Quanta, queue counts and aging thresholds vary from case to case.
+class VerifyCommand {
+private:
+    struct Check {
+        string name;
+        string algorithm;
+        size_t cases = 0;
+        size_t failures = 0;
+        string first_failure;
+    };
+
+    static vector<Process> workload(unsigned seed, long long count) {
+        WorkloadConfig config;
+        config.seed = seed;
+        config.count = count;
+        config.burst_max = 50;
+        return WorkloadGenerator(config).generateAll();
+    }
+
+    // The edits of one case, applied in turn: a burst changed two thirds in, a process added three
+    // quarters in, and one removed five sixths in
+    static vector<vector<Process>> edits(vector<Process> processes) {
+        vector<vector<Process>> versions;
+        size_t n = processes.size();
+        processes[n * 2 / 3].burst_time += 3;
+        versions.push_back(processes);
+        Process added = processes[n * 3 / 4];
+        added.p_id = processes.back().p_id + 1;
+        added.burst_time = 5;
+        processes.push_back(added);
+        versions.push_back(processes);
+        processes.erase(processes.begin() + n * 5 / 6);
+        versions.push_back(processes);
+        return versions;
+    }
+
+    template <typename Time>
+    static string streamed(const string& algorithm, const vector<BasicProcess<Time>>& processes, const json& config,
+                           size_t chunk_bytes) {
+        string text;
+        JsonStreamSink sink([&](const string& chunk) {
+            text += chunk;
+            return true;
+        }, chunk_bytes);
+        Dispatch::run(algorithm, processes, config, sink);
+        return text;
+    }
+
+    // document with each run of consecutive idle rows reduced to its first row
+    static string mergeIdleRows(const string& document) {
+        json result = json::parse(document);
+        json merged = json::array();
+        bool idle = false;
+        for (auto& row : result["gantt_chart"]) {
+            bool row_idle = row["process_id"] == -1;
+            if (!(row_idle && idle)) {
+                merged.push_back(std::move(row));
+            }
+            idle = row_idle;
+        }
+        result["gantt_chart"] = std::move(merged);
+        return result.dump();
+    }
+
+    // Whether two documents hold the same values, so that 120 and 120.0 match
+    static bool sameValues(const string& document, const string& expected) {
+        return json::parse(document) == json::parse(expected);
+    }
+
+    static void record(Check& check, bool same, const string& detail) {
+        check.cases++;
+        if (!same && check.failures++ == 0) {
+            check.first_failure = detail;
+        }
+    }
+
+    static void printTable(ostream& out, const vector<Check>& checks) {
+        out << left << setw(10) << "check" << setw(12) << "algorithm" << right << setw(8) << "cases"
+            << setw(10) << "failures" << "\n";
+        for (const auto& check : checks) {
+            out << left << setw(10) << check.name << setw(12) << check.algorithm << right << setw(8) << check.cases
+                << setw(10) << check.failures << "\n";
+            if (check.failures > 0) {
+                out << "  first failure: " << check.first_failure << "\n";
+            }
+        }
+    }
+
+public:
+    static void usage(ostream& out) {
+        out << "Usage: main verify [options]\n"
+            << "  --cases N       seeded workloads per algorithm (default 20)\n"
+            << "  --processes N   processes per workload (default 300)\n"
+            << "  --seed S        seed of the first workload (default 1)\n"
+            << "  --json          print the results as JSON\n";
+    }
+
+    static int run(int argc, char* argv[]) {
+        try {
+            CommandLine cli(argc, argv, {"help", "json"}, {"cases", "processes", "seed"});
+            if (cli.has("help")) {
+                usage(cout);
+                return 0;
+            }
+            long long cases = cli.getInt("cases", 20);
+            long long count = cli.getInt("processes", 300);
+            if (cases <= 0 || count < 6) {
+                throw invalid_argument("--cases must be positive and --processes at least 6");
+            }
+            unsigned seed = static_cast<unsigned>(cli.getInt("seed", 1));
+
+            vector<Check> checks;
+            for (size_t a = 0; a < AlgorithmTable::COUNT; a++) {
+                string algorithm = AlgorithmTable::SPECS[a].name;
+                Check resume{"resume", algorithm, 0, 0, ""}, chunked{"chunked", algorithm, 0, 0, ""};
+                Check int64{"int64", algorithm, 0, 0, ""}, real{"double", algorithm, 0, 0, ""};
+                for (long long c = 0; c < cases; c++) {
+                    unsigned case_seed = seed + static_cast<unsigned>(c);
+                    json config = {{"scheduling_type", algorithm}, {"quantum", 1 + c % 4}, {"num_queues", 2 + c % 3},
+                                   {"aging_threshold", 3 + c * 7 % 98}};
+                    vector<Process> processes = workload(case_seed, count);
+                    string where = "seed " + to_string(case_seed);
+                    string full = Dispatch::schedule(algorithm, processes, config).dump();
+
+                    Rescheduler::Slot slot;
+                    record(resume, Rescheduler::document(algorithm, processes, config, json::object(), &slot) == full,
+                           where);
+                    vector<vector<Process>> versions = edits(processes);
+                    for (size_t v = 0; v < versions.size(); v++) {
+                        string edited = Dispatch::schedule(algorithm, versions[v], config).dump();
+                        record(resume, Rescheduler::document(algorithm, versions[v], config, json::object(), &slot) ==
+                                       edited, where + ", edit " + to_string(v + 1));
+                    }
+
+                    record(chunked, streamed(algorithm, processes, config, 64 + c * 37) == full, where);
+
+                    vector<BasicProcess<long long>> wide;
+                    vector<BasicProcess<double>> fractional;
+                    for (const auto& p : processes) {
+                        wide.push_back({p.p_id, p.arrival_time, p.burst_time, p.priority});
+                        fractional.push_back({p.p_id, static_cast<double>(p.arrival_time),
+                                              static_cast<double>(p.burst_time), p.priority});
+                    }
+                    string expected = AlgorithmTable::SPECS[a].id == Algorithm::MLFQ ? mergeIdleRows(full) : full;
+                    record(int64, streamed(algorithm, wide, config, 1 << 16) == expected, where);
+                    record(real, sameValues(streamed(algorithm, fractional, config, 1 << 16), expected), where);
+                }
+                checks.push_back(resume);
+                checks.push_back(chunked);
+                checks.push_back(int64);
+                checks.push_back(real);
+            }
+
+            size_t failures = 0;
+            json results = json::array();
+            for (const auto& check : checks) {
+                failures += check.failures;
+                results.push_back({{"check", check.name}, {"algorithm", check.algorithm}, {"cases", check.cases},
+                                   {"failures", check.failures}, {"first_failure", check.first_failure}});
+            }
+            if (cli.has("json")) {
+                cout << json({{"checks", results}, {"failures", failures}}).dump(2) << "\n";
+            } else {
+                printTable(cout, checks);
+                cout << "\n" << (failures == 0 ? "all paths match the full schedule" : "MISMATCH") << "\n";
+            }
+            return failures == 0 ? 0 : 1;
+        } catch (const exception& e) {
+            cerr << "verify: " << e.what() << "\n";
+            return 1;
+        }
+    }
+};
+
+#endif
@@ -12,8 +12,10 @@
 #include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <cstdio>
 #include <memory>
 #include <vector>
+#include <poll.h>
 
 #include "http_parser_merged.h"
 #include "common.h"
@@ -265,6 +267,10 @@ namespace crow
             {
                 do_write_static();
             }
+            else if (res.is_chunked_type())
+            {
+                do_write_chunked();
+            }
             else
             {
                 do_write_general();
@@ -357,7 +363,7 @@ namespace crow
                 buffers_.emplace_back(crlf.data(), crlf.size());
             }
 
-            if (!res.manual_length_header && !res.headers.count("content-length"))
+            if (!res.manual_length_header && !res.headers.count("content-length") && !res.is_chunked_type())
             {
                 content_length_ = std::to_string(res.body.size());
                 static std::string content_length_tag = "Content-Length: ";
@@ -420,6 +426,90 @@ namespace crow
             parser_.clear();
         }
 
+        /// Write the headers, then each chunk as the body writer produces it, then the last (empty) chunk.
+        /// If the writer fails part way the connection is closed without the last chunk, so the client
+        /// sees an incomplete body rather than a truncated one that looks whole.
+        /// The deadline timer cannot fire while this blocks the connection's thread, so every write is
+        /// bounded by the same timeout instead (write_within_timeout).
+        void do_write_chunked()
+        {
+            cancel_deadline_timer();
+            bool alive = adaptor_.is_open() && write_within_timeout(buffers_);
+
+            response::chunk_writer write_chunk = [this, &alive](const std::string& data) -> bool {
+                if (!alive || data.empty())
+                {
+                    return alive;
+                }
+                char size_line[20];
+                int size_length = snprintf(size_line, sizeof(size_line), "%zx\r\n", data.size());
+                std::vector<asio::const_buffer> buffers{asio::buffer(size_line, size_length), asio::buffer(data), asio::buffer(crlf)};
+                alive = write_within_timeout(buffers);
+                return alive;
+            };
+
+            try
+            {
+                res.body_writer(write_chunk);
+                if (alive)
+                {
+                    static const std::string last_chunk = "0\r\n\r\n";
+                    std::vector<asio::const_buffer> buffers{asio::buffer(last_chunk)};
+                    alive = write_within_timeout(buffers);
+                }
+                if (!alive)
+                {
+                    close_connection_ = true;
+                }
+            }
+            catch (const std::exception& e)
+            {
+                CROW_LOG_ERROR << this << " chunked body failed: " << e.what();
+                close_connection_ = true;
+            }
+
+            if (close_connection_)
+            {
+                adaptor_.shutdown_readwrite();
+                adaptor_.close();
+                CROW_LOG_DEBUG << this << " from write (chunked)";
+            }
+
+            res.end();
+            res.clear();
+            buffers_.clear();
+            parser_.clear();
+        }
+
+        /// Write buffers, giving up once the client has taken nothing for the deadline timer's timeout
+        bool write_within_timeout(std::vector<asio::const_buffer>& buffers)
+        {
+            auto timeout = task_timer_.get_tick_length() * task_timer_.get_default_timeout();
+            error_code ec;
+            adaptor_.raw_socket().native_non_blocking(true, ec);
+            for (auto buffer = buffers.begin(); !ec && buffer != buffers.end();)
+            {
+                if (buffer->size() == 0)
+                {
+                    ++buffer;
+                    continue;
+                }
+                pollfd writable{adaptor_.raw_socket().native_handle(), POLLOUT, 0};
+                if (::poll(&writable, 1, static_cast<int>(timeout.count())) <= 0)
+                {
+                    CROW_LOG_WARNING << this << " write timed out";
+                    return false;
+                }
+                size_t written = adaptor_.socket().write_some(asio::buffer(*buffer), ec);
+                if (ec == asio::error::would_block || ec == asio::error::try_again)
+                {
+                    ec = {};
+                }
+                *buffer += written;
+            }
+            return !ec;
+        }
+
         void do_write_general()
         {
             if (res.body.length() < res_stream_threshold_)
@@ -4,6 +4,7 @@
 #include <ios>
 #include <fstream>
 #include <sstream>
+#include <functional>
 // S_ISREG is not defined for windows
 // This defines it like suggested in https://stackoverflow.com/a/62371749
 #if defined(_MSC_VER)
@@ -47,6 +48,11 @@ namespace crow
         bool skip_body = false;            ///< Whether this is a response to a HEAD request.
         bool manual_length_header = false; ///< Whether Crow should automatically add a "Content-Length" header.
 
+        /// Produces the body while the response is being sent (Transfer-Encoding: chunked).
+        /// Each call of the function it is given sends one chunk and returns false once the client is gone.
+        using chunk_writer = std::function<bool(const std::string&)>;
+        std::function<void(const chunk_writer&)> body_writer;
+
         /// Set the value of an existing header in the response.
         void set_header(std::string key, std::string value)
         {
@@ -170,6 +176,7 @@ namespace crow
             headers = std::move(r.headers);
             completed_ = r.completed_;
             file_info = std::move(r.file_info);
+            body_writer = std::move(r.body_writer);
             return *this;
         }
 
@@ -186,6 +193,7 @@ namespace crow
             headers.clear();
             completed_ = false;
             file_info = static_file_info{};
+            body_writer = nullptr;
         }
 
         /// Return a "Temporary Redirect" response.
@@ -273,6 +281,18 @@ namespace crow
             return file_info.path.size();
         }
 
+        /// Send the body written by `writer` in chunks instead of `body`, without a Content-Length.
+        void set_chunked_body(std::function<void(const chunk_writer&)> writer)
+        {
+            body_writer = std::move(writer);
+            set_header("Transfer-Encoding", "chunked");
+        }
+
+        bool is_chunked_type()
+        {
+            return static_cast<bool>(body_writer);
+        }
+
         /// This constains metadata (coming from the `stat` command) related to any static files associated with this response.
 
         ///
@@ -48,8 +48,9 @@ namespace crow // NOTE: Already documented in "crow/app.h"
              std::tuple<Middlewares...>* middlewares = nullptr,
              uint16_t concurrency = 1,
              uint8_t timeout = 5,
-             typename Adaptor::context* adaptor_ctx = nullptr):
-          acceptor_(io_context_,endpoint),
+             typename Adaptor::context* adaptor_ctx = nullptr,
+             bool reuse_port = false):
+          acceptor_(io_context_),
           signals_(io_context_),
           tick_timer_(io_context_),
           handler_(handler),
@@ -59,7 +60,25 @@ namespace crow // NOTE: Already documented in "crow/app.h"
           task_queue_length_pool_(concurrency_ - 1),
           middlewares_(middlewares),
           adaptor_ctx_(adaptor_ctx)
-        {}
+        {
+            // As acceptor_(io_context_, endpoint) would, plus SO_REUSEPORT when asked for, which
+            // has to be set before bind() so several servers can share the port
+            acceptor_.open(endpoint.protocol());
+            acceptor_.set_option(tcp::acceptor::reuse_address(true));
+#ifdef SO_REUSEPORT
+            if (reuse_port)
+            {
+                acceptor_.set_option(asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>(true));
+            }
+#else
+            if (reuse_port)
+            {
+                throw std::runtime_error("SO_REUSEPORT is not supported on this platform");
+            }
+#endif
+            acceptor_.bind(endpoint);
+            acceptor_.listen();
+        }
 
         void set_tick_function(std::chrono::milliseconds d, std::function<void()> f)
         {
@@ -0,0 +1,475 @@
+#ifndef LOAD_GENERATOR_HPP
+#define LOAD_GENERATOR_HPP
+#pragma once
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../asio.hpp"
+#include "../json.hpp"
+#include "../metrics/LogHistogram.hpp"
+#include "../workload/WorkloadGenerator.hpp"
+#include "../workload/WorkloadWriter.hpp"
+
+using namespace std;
+
+// One kind of request in the replayed mix; the HTTP text is rendered once up front
+struct LoadRequest {
+    string name;
+    string method = "POST";
+    string path = "/api/schedule";
+    double weight = 1.0;
+    string wire;
+};
+
+struct LoadConfig {
+    string host = "127.0.0.1";
+    int port = 18080;
+    int connections = 16;
+    int threads = 1;
+    double rate = 0.0;              // total requests per second; 0 sends as fast as responses return
+    double duration_seconds = 10.0;
+    double warmup_seconds = 2.0;
+    uint64_t seed = 1;
+    vector<LoadRequest> mix;
+};
+
+// Latency and outcome counters for one request kind. Latency is measured from the request's
+// intended send time, so a stalled server is charged for the requests it delayed
+// (coordinated-omission correction); service time is measured from the actual send. completed
+// counts the requests intended inside the window, however late they finished; in_window counts
+// the responses that arrived inside it and gives the throughput. Requests still unanswered when
+// the run gives up are abandoned, not completed.
+struct LoadStats {
+    LogHistogram latency_us;
+    LogHistogram service_us;
+    uint64_t completed = 0;
+    uint64_t in_window = 0;
+    uint64_t non_2xx = 0;
+    uint64_t errors = 0;
+    uint64_t abandoned = 0;
+
+    void merge(const LoadStats& other) {
+        latency_us.merge(other.latency_us);
+        service_us.merge(other.service_us);
+        completed += other.completed;
+        in_window += other.in_window;
+        non_2xx += other.non_2xx;
+        errors += other.errors;
+        abandoned += other.abandoned;
+    }
+};
+
+class LoadGenerator {
+public:
+    using Clock = chrono::steady_clock;
+
+private:
+    struct Window {
+        Clock::time_point measure_from;
+        Clock::time_point stop_at;
+    };
+
+    // A keep-alive connection that issues one request at a time on its own fixed schedule
+    class Connection : public enable_shared_from_this<Connection> {
+    private:
+        asio::ip::tcp::socket socket;
+        asio::steady_timer timer;
+        const asio::ip::tcp::resolver::results_type& endpoints;
+        const vector<LoadRequest>& mix;
+        discrete_distribution<size_t> pick;
+        mt19937_64 rng;
+        vector<LoadStats>& stats;
+        Window window;
+        Clock::duration interval;
+        Clock::time_point intended;
+        Clock::time_point sent;
+        size_t current = 0;
+        asio::streambuf response;
+        size_t header_length = 0;
+        size_t body_length = 0;
+        bool waiting = false;
+
+        void fail() {
+            waiting = false;
+            stats[current].errors++;
+            asio::error_code ignored;
+            socket.close(ignored);
+            connect();
+        }
+
+        void connect() {
+            auto self = shared_from_this();
+            response.consume(response.size());
+            asio::async_connect(socket, endpoints, [self](const asio::error_code& ec, const asio::ip::tcp::endpoint&) {
+                if (ec) {
+                    if (Clock::now() < self->window.stop_at) {
+                        self->timer.expires_after(chrono::milliseconds(100));
+                        self->timer.async_wait([self](const asio::error_code&) { self->connect(); });
+                    }
+                    return;
+                }
+                self->socket.set_option(asio::ip::tcp::no_delay(true));
+                self->schedule();
+            });
+        }
+
+        void schedule() {
+            if (interval == Clock::duration::zero()) {
+                intended = Clock::now();
+            }
+            if (intended >= window.stop_at) {
+                asio::error_code ignored;
+                socket.shutdown(asio::ip::tcp::socket::shutdown_both, ignored);
+                socket.close(ignored);
+                return;
+            }
+
+            auto self = shared_from_this();
+            if (intended > Clock::now()) {
+                timer.expires_at(intended);
+                timer.async_wait([self](const asio::error_code& ec) {
+                    if (!ec) {
+                        self->send();
+                    }
+                });
+            } else {
+                send();
+            }
+        }
+
+        void send() {
+            current = pick(rng);
+            sent = Clock::now();
+            waiting = true;
+            auto self = shared_from_this();
+            asio::async_write(socket, asio::buffer(mix[current].wire), [self](const asio::error_code& ec, size_t) {
+                if (ec) {
+                    self->fail();
+                    return;
+                }
+                self->readHeaders();
+            });
+        }
+
+        void readHeaders() {
+            auto self = shared_from_this();
+            asio::async_read_until(socket, response, "\r\n\r\n", [self](const asio::error_code& ec, size_t length) {
+                if (ec) {
+                    self->fail();
+                    return;
+                }
+                self->header_length = length;
+                self->body_length = 0;
+
+                string headers(asio::buffers_begin(self->response.data()),
+                               asio::buffers_begin(self->response.data()) + length);
+                int status = 0;
+                size_t space = headers.find(' ');
+                if (space != string::npos) {
+                    status = atoi(headers.c_str() + space + 1);
+                }
+                for (char& c : headers) {
+                    c = static_cast<char>(tolower(c));
+                }
+                if (status < 200 || status >= 300) {
+                    self->stats[self->current].non_2xx++;
+                }
+                size_t field = headers.find("\r\ntransfer-encoding:");
+                if (field != string::npos && headers.find("chunked", field) < headers.find("\r\n", field + 2)) {
+                    self->response.consume(length);
+                    self->header_length = 0;
+                    self->readChunkSize();
+                    return;
+                }
+                field = headers.find("\r\ncontent-length:");
+                if (field != string::npos) {
+                    self->body_length = stoull(headers.substr(field + 17));
+                }
+                self->readBody();
+            });
+        }
+
+        // A chunked body (the streaming routes): size lines and chunks until the zero-size chunk
+        void readChunkSize() {
+            auto self = shared_from_this();
+            asio::async_read_until(socket, response, "\r\n", [self](const asio::error_code& ec, size_t length) {
+                if (ec) {
+                    self->fail();
+                    return;
+                }
+                string line(asio::buffers_begin(self->response.data()),
+                            asio::buffers_begin(self->response.data()) + length);
+                self->response.consume(length);
+                size_t size = strtoull(line.c_str(), nullptr, 16);
+                if (size == 0) {
+                    self->readTrailers();
+                } else {
+                    self->readChunk(size + 2);
+                }
+            });
+        }
+
+        // length includes the CRLF after the chunk data
+        void readChunk(size_t length) {
+            if (response.size() >= length) {
+                response.consume(length);
+                readChunkSize();
+                return;
+            }
+            auto self = shared_from_this();
+            asio::async_read(socket, response, asio::transfer_exactly(length - response.size()),
+                [self, length](const asio::error_code& ec, size_t) {
+                    if (ec) {
+                        self->fail();
+                        return;
+                    }
+                    self->response.consume(length);
+                    self->readChunkSize();
+                });
+        }
+
+        void readTrailers() {
+            auto self = shared_from_this();
+            asio::async_read_until(socket, response, "\r\n", [self](const asio::error_code& ec, size_t length) {
+                if (ec) {
+                    self->fail();
+                    return;
+                }
+                self->response.consume(length);
+                if (length == 2) {
+                    self->complete();
+                } else {
+                    self->readTrailers();
+                }
+            });
+        }
+
+        void readBody() {
+            size_t buffered = response.size() - header_length;
+            if (buffered >= body_length) {
+                complete();
+                return;
+            }
+            auto self = shared_from_this();
+            asio::async_read(socket, response, asio::transfer_exactly(body_length - buffered),
+                [self](const asio::error_code& ec, size_t) {
+                    if (ec) {
+                        self->fail();
+                        return;
+                    }
+                    self->complete();
+                });
+        }
+
+        void complete() {
+            Clock::time_point done = Clock::now();
+            response.consume(header_length + body_length);
+            header_length = 0;
+            body_length = 0;
+            waiting = false;
+
+            if (done >= window.measure_from && done <= window.stop_at) {
+                stats[current].in_window++;
+            }
+            if (intended >= window.measure_from) {
+                LoadStats& s = stats[current];
+                s.completed++;
+                s.latency_us.record(chrono::duration_cast<chrono::microseconds>(done - intended).count());
+                s.service_us.record(chrono::duration_cast<chrono::microseconds>(done - sent).count());
+            }
+            intended += interval;
+            schedule();
+        }
+
+    public:
+        Connection(asio::io_context& io_context, const asio::ip::tcp::resolver::results_type& eps,
+                   const vector<LoadRequest>& requests, vector<LoadStats>& per_request, Window w,
+                   Clock::duration spacing, Clock::time_point first_send, uint64_t seed)
+            : socket(io_context), timer(io_context), endpoints(eps), mix(requests),
+              rng(seed), stats(per_request), window(w), interval(spacing), intended(first_send) {
+            vector<double> weights;
+            for (const auto& request : requests) {
+                weights.push_back(request.weight);
+            }
+            pick = discrete_distribution<size_t>(weights.begin(), weights.end());
+        }
+
+        void start() {
+            connect();
+        }
+
+        // Counts a request intended inside the window that is still unanswered; only once the
+        // connection's io_context has stopped
+        void abandon() {
+            if (waiting && intended >= window.measure_from) {
+                stats[current].abandoned++;
+            }
+        }
+    };
+
+public:
+    // Renders the HTTP request text for a mix entry; processes is the workload size to embed
+    static LoadRequest makeRequest(const string& name, const string& method, const string& path,
+                                   const nlohmann::json& fields, long long processes, double weight,
+                                   const string& host, uint64_t seed) {
+        LoadRequest request;
+        request.name = name;
+        request.method = method;
+        request.path = path;
+        request.weight = weight;
+
+        string body;
+        if (method == "POST") {
+            WorkloadConfig config;
+            config.seed = seed;
+            config.count = processes;
+            WorkloadGenerator generator(config);
+            ostringstream out;
+            WorkloadWriter::writeJson(out, generator, fields);
+            body = out.str();
+        }
+
+        request.wire = method + " " + path + " HTTP/1.1\r\nHost: " + host + "\r\n";
+        if (method == "POST") {
+            request.wire += "Content-Type: application/json\r\nContent-Length: " + to_string(body.size()) + "\r\n";
+        }
+        request.wire += "\r\n" + body;
+        return request;
+    }
+
+    // Mix used when none is supplied: every route, with the common algorithms weighted up
+    static vector<LoadRequest> defaultMix(const string& host, uint64_t seed, double scale) {
+        auto size = [scale](long long n) { return max(1LL, static_cast<long long>(n * scale)); };
+        return {
+            makeRequest("root", "GET", "/", nullptr, 0, 1, host, seed),
+            makeRequest("fcfs", "POST", "/api/schedule", {{"scheduling_type", "FCFS"}}, size(50), 3, host, seed),
+            makeRequest("sjf", "POST", "/api/schedule", {{"scheduling_type", "SJF"}}, size(50), 2, host, seed),
+            makeRequest("rr", "POST", "/api/schedule", {{"scheduling_type", "RR"}, {"quantum", 4}}, size(200), 2, host, seed),
+            makeRequest("priority", "POST", "/api/schedule", {{"scheduling_type", "Priority"}}, size(50), 2, host, seed),
+            makeRequest("mlq", "POST", "/api/mlq", {{"scheduling_type", "MLQ"}, {"num_of_queues", 3}, {"quantum", 2}}, size(100), 1, host, seed),
+            makeRequest("mlfq", "POST", "/api/mlfq", {{"scheduling_type", "MLFQ"}, {"num_queues", 3}, {"quantum", 2}}, size(100), 1, host, seed),
+            makeRequest("mlq-aging", "POST", "/api/mlq-aging", {{"scheduling_type", "MLQ_Aging"}, {"num_queues", 3}, {"quantum", 2}}, size(100), 1, host, seed),
+            makeRequest("sjf-aging", "POST", "/api/sjf-aging", {{"scheduling_type", "SJF_Aging"}, {"aging_threshold", 50}}, size(100), 1, host, seed)
+        };
+    }
+
+    // Mix file: [{"name", "method", "path", "weight", "processes", "body": {...}}, ...]
+    static vector<LoadRequest> mixFromJson(const nlohmann::json& entries, const string& host, uint64_t seed, double scale) {
+        vector<LoadRequest> mix;
+        for (const auto& entry : entries) {
+            long long processes = static_cast<long long>(entry.value("processes", 100) * scale);
+            mix.push_back(makeRequest(entry.value("name", entry.value("path", string("/"))),
+                                      entry.value("method", string("POST")),
+                                      entry.value("path", string("/api/schedule")),
+                                      entry.value("body", nlohmann::json::object()),
+                                      max(1LL, processes), entry.value("weight", 1.0), host, seed));
+        }
+        if (mix.empty()) {
+            throw runtime_error("Request mix is empty");
+        }
+        return mix;
+    }
+
+    // Runs the closed loop and returns statistics per mix entry, in mix order
+    static vector<LoadStats> run(const LoadConfig& config) {
+        if (config.connections <= 0 || config.threads <= 0 || config.mix.empty()) {
+            throw invalid_argument("Load test needs at least one connection, thread and request type");
+        }
+
+        asio::io_context resolve_io;
+        asio::ip::tcp::resolver resolver(resolve_io);
+        auto endpoints = resolver.resolve(config.host, to_string(config.port));
+
+        Clock::duration interval = Clock::duration::zero();
+        if (config.rate > 0) {
+            interval = chrono::duration_cast<Clock::duration>(chrono::duration<double>(config.connections / config.rate));
+        }
+
+        Clock::time_point start = Clock::now() + chrono::milliseconds(50);
+        Window window;
+        window.measure_from = start + chrono::duration_cast<Clock::duration>(chrono::duration<double>(config.warmup_seconds));
+        window.stop_at = window.measure_from + chrono::duration_cast<Clock::duration>(chrono::duration<double>(config.duration_seconds));
+
+        vector<unique_ptr<asio::io_context>> contexts;
+        vector<vector<LoadStats>> stats(config.threads, vector<LoadStats>(config.mix.size()));
+        for (int t = 0; t < config.threads; t++) {
+            contexts.push_back(make_unique<asio::io_context>(1));
+        }
+        // Released before the contexts their sockets belong to
+        vector<shared_ptr<Connection>> connections;
+
+        for (int c = 0; c < config.connections; c++) {
+            int t = c % config.threads;
+            // Stagger connections evenly across one interval so the offered load is smooth
+            Clock::time_point first = start + (interval / config.connections) * c;
+            auto connection = make_shared<Connection>(*contexts[t], endpoints, config.mix, stats[t], window,
+                                                      interval, first, config.seed * 1000003 + c);
+            connection->start();
+            connections.push_back(connection);
+        }
+
+        vector<thread> workers;
+        for (int t = 0; t < config.threads; t++) {
+            asio::io_context* io = contexts[t].get();
+            workers.emplace_back([io, &window]() {
+                // Requests still in flight well after the window closes are abandoned
+                io->run_until(window.stop_at + chrono::seconds(5));
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        for (const auto& connection : connections) {
+            connection->abandon();
+        }
+
+        vector<LoadStats> merged(config.mix.size());
+        for (const auto& thread_stats : stats) {
+            for (size_t i = 0; i < merged.size(); i++) {
+                merged[i].merge(thread_stats[i]);
+            }
+        }
+        return merged;
+    }
+
+    static nlohmann::json report(const LoadConfig& config, const vector<LoadStats>& results) {
+        LoadStats total;
+        nlohmann::json per_request = nlohmann::json::array();
+        for (size_t i = 0; i < results.size(); i++) {
+            total.merge(results[i]);
+            per_request.push_back({
+                {"name", config.mix[i].name},
+                {"path", config.mix[i].path},
+                {"completed", results[i].completed},
+                {"non_2xx", results[i].non_2xx},
+                {"errors", results[i].errors},
+                {"abandoned", results[i].abandoned},
+                {"latency_us", results[i].latency_us.summary()},
+                {"service_time_us", results[i].service_us.summary()}
+            });
+        }
+
+        return {
+            {"connections", config.connections},
+            {"threads", config.threads},
+            {"target_rate", config.rate},
+            {"duration_seconds", config.duration_seconds},
+            {"completed", total.completed},
+            {"completed_in_window", total.in_window},
+            {"throughput_rps", total.in_window / config.duration_seconds},
+            {"non_2xx", total.non_2xx},
+            {"errors", total.errors},
+            {"abandoned", total.abandoned},
+            {"latency_us", total.latency_us.summary()},
+            {"service_time_us", total.service_us.summary()},
+            {"requests", per_request}
+        };
+    }
+};
+
+#endif
@@ -1,11 +1,102 @@
 #include "APIHandler/APIHandler.hpp"
+#include "APIHandler/ShardedServer.hpp"
+#include "cli/GenerateCommand.hpp"
+#include "cli/LoadTestCommand.hpp"
+#include "cli/BatchCommand.hpp"
+#include "cli/ImportCommand.hpp"
+#include "cli/InspectCommand.hpp"
+#include "cli/BenchCommand.hpp"
+#include "cli/VerifyCommand.hpp"
+#include <string>
 
-int main()
+static void serverUsage(std::ostream& out) {
+    out << "Usage: main [options]\n"
+        << "  --port N             TCP port (default 18080)\n"
+        << "  --shards N           N single-threaded servers sharing the port, each pinned to a CPU\n"
+        << "                       (0: one per CPU; default: one server on a shared thread pool)\n"
+        << "  --unix-socket PATH   also serve the API on a Unix domain socket\n"
+        << "  --shm-ring-mb M      shared-memory ring per local connection, in MiB (default 64)\n"
+        << "  --shm-threshold B    smallest body sent through shared memory, in bytes (default 65536)\n"
+        << "  --unix-connections N local connections served at once (default 16)\n";
+}
+
+static int serve(int argc, char* argv[]) {
+    try {
+        CommandLine cli(argc, argv, {"help"},
+                        {"port", "shards", "unix-socket", "shm-ring-mb", "shm-threshold", "unix-connections"});
+        if (cli.has("help")) {
+            serverUsage(std::cout);
+            return 0;
+        }
+        long long port = cli.getInt("port", 18080);
+        long long ring_mb = cli.getInt("shm-ring-mb", 64);
+        long long threshold = cli.getInt("shm-threshold", 64 * 1024);
+        long long local_connections = cli.getInt("unix-connections", 16);
+        if (port <= 0 || port > 65535 || ring_mb <= 0 || threshold < 0) {
+            throw std::invalid_argument("--port must be 1-65535, --shm-ring-mb positive and --shm-threshold not negative");
+        }
+        if (local_connections <= 0 || local_connections > 4096) {
+            throw std::invalid_argument("--unix-connections must be 1-4096");
+        }
+        long long shards = cli.getInt("shards", -1);
+        if (cli.has("shards") && (shards < 0 || shards > 1024)) {
+            throw std::invalid_argument("--shards must be 0-1024");
+        }
+        LocalTransportOptions local;
+        local.socket_path = cli.get("unix-socket", "");
+        local.ring_bytes = static_cast<size_t>(ring_mb) << 20;
+        local.shm_threshold = static_cast<size_t>(threshold);
+        local.max_connections = static_cast<size_t>(local_connections);
+        if (shards >= 0) {
+            ShardedServer server(static_cast<size_t>(shards));
+            server.run(static_cast<int>(port), cli.has("unix-socket") ? &local : nullptr);
+        } else if (cli.has("unix-socket")) {
+            APIHandler api;
+            api.run(static_cast<int>(port), local);
+        } else {
+            APIHandler api;
+            api.run(static_cast<int>(port), true);
+        }
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "main: " << e.what() << "\n";
+        serverUsage(std::cerr);
+        return 1;
+    }
+}
+
+int main(int argc, char* argv[])
 {
+    // Offline subcommands; with no arguments the binary starts the server as before
+    if (argc > 1 && std::string(argv[1]) == "generate") {
+        return GenerateCommand::run(argc - 1, argv + 1);
+    }
+    if (argc > 1 && std::string(argv[1]) == "loadtest") {
+        return LoadTestCommand::run(argc - 1, argv + 1);
+    }
+    if (argc > 1 && std::string(argv[1]) == "batch") {
+        return BatchCommand::run(argc - 1, argv + 1);
+    }
+    if (argc > 1 && std::string(argv[1]) == "import") {
+        return ImportCommand::run(argc - 1, argv + 1);
+    }
+    if (argc > 1 && std::string(argv[1]) == "inspect") {
+        return InspectCommand::run(argc - 1, argv + 1);
+    }
+    if (argc > 1 && std::string(argv[1]) == "bench") {
+        return BenchCommand::run(argc - 1, argv + 1);
+    }
+    if (argc > 1 && std::string(argv[1]) == "verify") {
+        return VerifyCommand::run(argc - 1, argv + 1);
+    }
+
+    // Start the server; options (--port, --unix-socket ...) only when given
+    if (argc > 1 && std::string(argv[1]).rfind("--", 0) == 0) {
+        return serve(argc, argv);
+    }
     // Create API handler
     APIHandler api;
-    // Start the server
     api.run(18080, true);
-    
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,147 @@
+#ifndef LOG_HISTOGRAM_HPP
+#define LOG_HISTOGRAM_HPP
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <stdexcept>
+#include "../json.hpp"
+#include "StatsKernels.hpp"
+
+using namespace std;
+
+// Log-linear histogram of non-negative integers in the style of HdrHistogram.
+// Each power of two is split into 64 sub-buckets, so any reported quantile is within ~1.6% of the
+// true value, memory is a fixed ~30KB regardless of how many values are recorded, and two
+// histograms can be merged by adding their counts.
+class LogHistogram {
+private:
+    static constexpr int SUB_BUCKET_BITS = 7;
+    static constexpr uint64_t SUB_BUCKET_HALF = 1ULL << (SUB_BUCKET_BITS - 1);
+    static constexpr size_t NUM_BUCKETS = (64 - SUB_BUCKET_BITS + 2) * SUB_BUCKET_HALF;
+
+    vector<uint64_t> counts;
+    uint64_t total = 0;
+    uint64_t min_value = UINT64_MAX;
+    uint64_t max_value = 0;
+    long double sum = 0;
+
+    static int highestBit(uint64_t value) {
+        int bit = 0;
+        while (value >>= 1) {
+            bit++;
+        }
+        return bit;
+    }
+
+    static size_t indexOf(uint64_t value) {
+        if (value < (1ULL << SUB_BUCKET_BITS)) {
+            return static_cast<size_t>(value);
+        }
+        int shift = highestBit(value) - (SUB_BUCKET_BITS - 1);
+        return static_cast<size_t>(shift) * SUB_BUCKET_HALF + static_cast<size_t>(value >> shift);
+    }
+
+    // Largest value that maps to the given bucket
+    static uint64_t upperBoundOf(size_t index) {
+        if (index < (1ULL << SUB_BUCKET_BITS)) {
+            return index;
+        }
+        int shift = static_cast<int>(index / SUB_BUCKET_HALF) - 1;
+        uint64_t sub = index - static_cast<uint64_t>(shift) * SUB_BUCKET_HALF;
+        return ((sub + 1) << shift) - 1;
+    }
+
+public:
+    LogHistogram() : counts(NUM_BUCKETS, 0) {}
+
+    void record(uint64_t value, uint64_t count = 1) {
+        counts[indexOf(value)] += count;
+        total += count;
+        min_value = min(min_value, value);
+        max_value = max(max_value, value);
+        sum += static_cast<long double>(value) * count;
+    }
+
+    // record() for each of n values, with the buckets, sum, min and max found by StatsKernels.
+    // Negative values count as 0.
+    void recordAll(const int32_t* values, size_t n) {
+        ColumnStats stats = StatsKernels::reduce(values, n);
+        if (n == 0) {
+            return;
+        }
+        if (stats.min < 0) {
+            for (size_t i = 0; i < n; i++) {
+                record(static_cast<uint64_t>(max(values[i], 0)));
+            }
+            return;
+        }
+        uint16_t buckets[4096];
+        for (size_t first = 0; first < n; first += 4096) {
+            size_t rows = min<size_t>(4096, n - first);
+            StatsKernels::buckets(values + first, rows, SUB_BUCKET_BITS, buckets);
+            for (size_t i = 0; i < rows; i++) {
+                counts[buckets[i]]++;
+            }
+        }
+        total += n;
+        min_value = min<uint64_t>(min_value, stats.min);
+        max_value = max<uint64_t>(max_value, stats.max);
+        sum += stats.sum;
+    }
+
+    void merge(const LogHistogram& other) {
+        for (size_t i = 0; i < NUM_BUCKETS; i++) {
+            counts[i] += other.counts[i];
+        }
+        total += other.total;
+        min_value = min(min_value, other.min_value);
+        max_value = max(max_value, other.max_value);
+        sum += other.sum;
+    }
+
+    void reset() {
+        fill(counts.begin(), counts.end(), 0);
+        total = 0;
+        min_value = UINT64_MAX;
+        max_value = 0;
+        sum = 0;
+    }
+
+    // Value at quantile q in [0, 1]; 0 when the histogram is empty
+    uint64_t quantile(double q) const {
+        if (total == 0) {
+            return 0;
+        }
+        q = min(max(q, 0.0), 1.0);
+        uint64_t rank = max<uint64_t>(1, static_cast<uint64_t>(q * total + 0.5));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < NUM_BUCKETS; i++) {
+            seen += counts[i];
+            if (seen >= rank) {
+                return min(max(upperBoundOf(i), min_value), max_value);
+            }
+        }
+        return max_value;
+    }
+
+    uint64_t count() const { return total; }
+    uint64_t minimum() const { return total == 0 ? 0 : min_value; }
+    uint64_t maximum() const { return max_value; }
+    double mean() const { return total == 0 ? 0.0 : static_cast<double>(sum / total); }
+
+    nlohmann::json summary() const {
+        return {
+            {"count", total},
+            {"min", minimum()},
+            {"mean", mean()},
+            {"p50", quantile(0.50)},
+            {"p90", quantile(0.90)},
+            {"p99", quantile(0.99)},
+            {"p999", quantile(0.999)},
+            {"max", max_value}
+        };
+    }
+};
+
+#endif
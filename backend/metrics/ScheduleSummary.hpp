@@ -0,0 +1,235 @@
+#ifndef SCHEDULE_SUMMARY_HPP
+#define SCHEDULE_SUMMARY_HPP
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "../json.hpp"
+#include "../Type.hpp"
+#include "LogHistogram.hpp"
+#include "StatsKernels.hpp"
+
+using namespace std;
+
+// Aggregate metrics of a schedule, accumulated as it is produced. It is a trace sink of its own
+// (see trace/JsonTraceSink.hpp), so it can run alone when only the summary is wanted or next to a
+// document sink through TeeTraceSink. Sums are kept in 64 bits.
+//
+// Response time is from arrival to a process's first Gantt row. A context switch is the CPU
+// passing from one process to a different one, with or without idle time between; a row split
+// that keeps the same process running is not one.
+//
+// Turnaround, waiting and response times also go into LogHistograms for their tails (p50 ... p99.9,
+// max), so memory stays fixed however many processes run, and summaries of many runs can be merged.
+//
+// Total is what times are summed in: ScheduleSummary sums int and 64-bit times as long long,
+// FractionalScheduleSummary sums fractional ones as double. The histograms hold times rounded to
+// whole units.
+template <typename Total>
+class BasicScheduleSummary {
+private:
+    Total turnaround_sum = 0;
+    Total waiting_sum = 0;
+    Total response_sum = 0;
+    Total burst_sum = 0;
+    Total first_arrival = numeric_limits<Total>::max();
+    Total makespan = 0;
+    // Runs added by merge()
+    Total merged_span = 0;
+    Total merged_makespan = 0;
+    size_t count = 0;
+    size_t segments = 0;
+    size_t context_switches = 0;
+
+    LogHistogram turnaround_times;
+    LogHistogram waiting_times;
+    LogHistogram response_times;
+
+    int last_process_id = -1;
+    // First start of the processes that have run but not completed
+    unordered_map<int, Total> first_run;
+    function<void(const nlohmann::json&)> on_finish;
+
+    // Negative times count as 0
+    static uint64_t histogramValue(Total time) {
+        if constexpr (is_floating_point_v<Total>) {
+            return time > 0 ? static_cast<uint64_t>(llround(time)) : 0;
+        } else {
+            return static_cast<uint64_t>(max<Total>(time, 0));
+        }
+    }
+
+public:
+    // on_finish, if set, receives summary() when the engine finishes
+    explicit BasicScheduleSummary(function<void(const nlohmann::json&)> finished = nullptr)
+        : on_finish(std::move(finished)) {}
+
+    template <typename Time, typename Describe>
+    void beginSegment(int process_id, Time start_time, int queue_level, Describe&& describe) {
+        segments++;
+        if (process_id < 0) {
+            return;
+        }
+        first_run.emplace(process_id, start_time);
+        if (last_process_id >= 0 && last_process_id != process_id) {
+            context_switches++;
+        }
+        last_process_id = process_id;
+    }
+
+    template <typename Time>
+    void endSegment(Time end_time) {}
+
+    template <typename Time>
+    void closeSegment(Time end_time) {}
+
+    template <typename Time>
+    void completeProcess(const BasicProcess<Time>& p, Time completion_time) {
+        Total turnaround = static_cast<Total>(completion_time) - p.arrival_time;
+        Total response = turnaround;
+        auto first = first_run.find(p.p_id);
+        if (first != first_run.end()) {
+            response = first->second - p.arrival_time;
+            first_run.erase(first);
+        }
+        Total waiting = turnaround - p.burst_time;
+        turnaround_sum += turnaround;
+        waiting_sum += waiting;
+        response_sum += response;
+        turnaround_times.record(histogramValue(turnaround));
+        waiting_times.record(histogramValue(waiting));
+        response_times.record(histogramValue(response));
+        burst_sum += p.burst_time;
+        first_arrival = min<Total>(first_arrival, p.arrival_time);
+        makespan = max<Total>(makespan, completion_time);
+        count++;
+    }
+
+    template <typename Time, typename Extra>
+    void completeProcess(const BasicProcess<Time>& p, Time completion_time, const char* extra_name, Extra extra_value) {
+        completeProcess(p, completion_time);
+    }
+
+    // completeProcess() for n processes given as int32 columns, as read from a .ctrace file. The
+    // derived times, sums and histograms are computed a column at a time (StatsKernels.hpp).
+    void completeProcesses(const int32_t* p_ids, const int32_t* arrival_times, const int32_t* burst_times,
+                           const int32_t* completion_times, size_t n) {
+        static_assert(is_integral_v<Total>, "completeProcesses() takes int32 times");
+        if (n == 0) {
+            return;
+        }
+        vector<int32_t> turnaround(n), waiting(n), response(n);
+        StatsKernels::derive(arrival_times, burst_times, completion_times, n, turnaround.data(), waiting.data());
+        for (size_t i = 0; i < n; i++) {
+            response[i] = turnaround[i];
+            auto first = first_run.find(p_ids[i]);
+            if (first != first_run.end()) {
+                response[i] = static_cast<int32_t>(first->second - arrival_times[i]);
+                first_run.erase(first);
+            }
+        }
+        ColumnStats arrivals = StatsKernels::reduce(arrival_times, n);
+        ColumnStats completions = StatsKernels::reduce(completion_times, n);
+        turnaround_sum += StatsKernels::reduce(turnaround.data(), n).sum;
+        waiting_sum += StatsKernels::reduce(waiting.data(), n).sum;
+        response_sum += StatsKernels::reduce(response.data(), n).sum;
+        burst_sum += StatsKernels::reduce(burst_times, n).sum;
+        turnaround_times.recordAll(turnaround.data(), n);
+        waiting_times.recordAll(waiting.data(), n);
+        response_times.recordAll(response.data(), n);
+        first_arrival = min<Total>(first_arrival, arrivals.min);
+        makespan = max<Total>(makespan, completions.max);
+        count += n;
+    }
+
+    void finish() {
+        if (on_finish) {
+            on_finish(summary());
+        }
+    }
+
+    // Time from the first arrival to the makespan, summed over merged runs
+    Total span() const {
+        return (first_arrival == numeric_limits<Total>::max() ? 0 : makespan - first_arrival) + merged_span;
+    }
+
+    // Adds the totals of another run, as when summarizing a whole batch. The runs count as if back
+    // to back: utilization and throughput are over the sum of their spans, and no context switch
+    // is counted between them.
+    void merge(const BasicScheduleSummary& other) {
+        turnaround_sum += other.turnaround_sum;
+        waiting_sum += other.waiting_sum;
+        response_sum += other.response_sum;
+        burst_sum += other.burst_sum;
+        merged_span += other.span();
+        merged_makespan = max({merged_makespan, other.makespan, other.merged_makespan});
+        count += other.count;
+        segments += other.segments;
+        context_switches += other.context_switches;
+        turnaround_times.merge(other.turnaround_times);
+        waiting_times.merge(other.waiting_times);
+        response_times.merge(other.response_times);
+    }
+
+    // Replays a schedule document ({"gantt_chart": [...], "process_stats": [...]}) that was built elsewhere
+    void add(const nlohmann::json& result) {
+        auto no_snapshot = [](nlohmann::json&) {};
+        if (result.contains("gantt_chart")) {
+            for (const auto& row : result["gantt_chart"]) {
+                beginSegment(row["process_id"].get<int>(), row["start_time"].get<Total>(), 0, no_snapshot);
+            }
+        }
+        if (result.contains("process_stats")) {
+            for (const auto& row : result["process_stats"]) {
+                BasicProcess<Total> p;
+                p.p_id = row["process_id"];
+                p.arrival_time = row["arrival_time"];
+                p.burst_time = row["burst_time"];
+                p.priority = row.value("priority", 0);
+                completeProcess(p, row["completion_time"].get<Total>());
+            }
+        }
+    }
+
+    nlohmann::json summary() const {
+        nlohmann::json summary = {
+            {"processes", count},
+            {"makespan", max(makespan, merged_makespan)},
+            {"gantt_segments", segments},
+            {"context_switches", context_switches}
+        };
+        if (count > 0) {
+            Total span = this->span();
+            summary["total_turnaround_time"] = turnaround_sum;
+            summary["total_waiting_time"] = waiting_sum;
+            summary["total_response_time"] = response_sum;
+            summary["total_burst_time"] = burst_sum;
+            summary["avg_turnaround_time"] = static_cast<double>(turnaround_sum) / count;
+            summary["avg_waiting_time"] = static_cast<double>(waiting_sum) / count;
+            summary["avg_response_time"] = static_cast<double>(response_sum) / count;
+            summary["cpu_utilization"] = span > 0 ? static_cast<double>(burst_sum) / span : 1.0;
+            summary["throughput"] = span > 0 ? static_cast<double>(count) / span : 0.0;
+            summary["percentiles"] = {
+                {"turnaround_time", turnaround_times.summary()},
+                {"waiting_time", waiting_times.summary()},
+                {"response_time", response_times.summary()}
+            };
+        }
+        return summary;
+    }
+};
+
+using ScheduleSummary = BasicScheduleSummary<long long>;
+using FractionalScheduleSummary = BasicScheduleSummary<double>;
+
+// The summary for times of type Time
+template <typename Time>
+using ScheduleSummaryOf = conditional_t<is_floating_point_v<Time>, FractionalScheduleSummary, ScheduleSummary>;
+
+#endif
@@ -0,0 +1,275 @@
+#ifndef STATS_KERNELS_HPP
+#define STATS_KERNELS_HPP
+#pragma once
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define STATS_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+// The instruction sets StatsKernels has implementations for
+enum class KernelIsa { Scalar, AVX2, AVX512 };
+
+// Sum, minimum and maximum of a column; min and max are 0 when it is empty
+struct ColumnStats {
+    long long sum = 0;
+    int32_t min = 0;
+    int32_t max = 0;
+};
+
+// Per-process metrics over columns of int32 times (struct-of-arrays, as in a .ctrace file or a
+// ColumnarTraceWriter row group) instead of one process at a time:
+//
+//   derive   turnaround = completion - arrival and waiting = turnaround - burst
+//   reduce   sum (in 64 bits), minimum and maximum
+//   buckets  LogHistogram bucket of every value, negatives counting as 0
+//
+// Each has a scalar, an AVX2 and an AVX-512 version. The AVX ones are compiled with target
+// attributes rather than build flags, and best() picks the widest this CPU runs, so one binary
+// serves every machine. All versions give the same results.
+class StatsKernels {
+private:
+    static void deriveScalar(const int32_t* arrival, const int32_t* burst, const int32_t* completion, size_t n,
+                             int32_t* turnaround, int32_t* waiting) {
+        for (size_t i = 0; i < n; i++) {
+            turnaround[i] = completion[i] - arrival[i];
+            waiting[i] = turnaround[i] - burst[i];
+        }
+    }
+
+    static ColumnStats reduceScalar(const int32_t* values, size_t n, size_t from, ColumnStats stats) {
+        for (size_t i = from; i < n; i++) {
+            stats.sum += values[i];
+            stats.min = min(stats.min, values[i]);
+            stats.max = max(stats.max, values[i]);
+        }
+        return stats;
+    }
+
+    static int highestBit(uint32_t value) {
+        return value == 0 ? -1 : 31 - __builtin_clz(value);
+    }
+
+    // LogHistogram's bucket: below 2^sub_bucket_bits a value is its own bucket; above, each power
+    // of two is split into 2^(sub_bucket_bits - 1) buckets
+    static void bucketsScalar(const int32_t* values, size_t n, int sub_bucket_bits, uint16_t* out) {
+        for (size_t i = 0; i < n; i++) {
+            uint32_t value = static_cast<uint32_t>(max(values[i], 0));
+            int shift = max(highestBit(value) - (sub_bucket_bits - 1), 0);
+            out[i] = static_cast<uint16_t>((shift << (sub_bucket_bits - 1)) + (value >> shift));
+        }
+    }
+
+#ifdef STATS_KERNELS_X86
+    __attribute__((target("avx2")))
+    static void deriveAVX2(const int32_t* arrival, const int32_t* burst, const int32_t* completion, size_t n,
+                           int32_t* turnaround, int32_t* waiting) {
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(arrival + i));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(burst + i));
+            __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(completion + i));
+            __m256i t = _mm256_sub_epi32(c, a);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(turnaround + i), t);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(waiting + i), _mm256_sub_epi32(t, b));
+        }
+        deriveScalar(arrival + i, burst + i, completion + i, n - i, turnaround + i, waiting + i);
+    }
+
+    __attribute__((target("avx2")))
+    static ColumnStats reduceAVX2(const int32_t* values, size_t n) {
+        if (n < 8) {
+            return reduceScalar(values, n, 0, {0, INT_MAX, INT_MIN});
+        }
+        __m256i sum = _mm256_setzero_si256();
+        __m256i low = _mm256_set1_epi32(INT_MAX);
+        __m256i high = _mm256_set1_epi32(INT_MIN);
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+            sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+            sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+            low = _mm256_min_epi32(low, v);
+            high = _mm256_max_epi32(high, v);
+        }
+        alignas(32) long long sums[4];
+        alignas(32) int32_t lows[8];
+        alignas(32) int32_t highs[8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(sums), sum);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lows), low);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(highs), high);
+        ColumnStats stats{sums[0] + sums[1] + sums[2] + sums[3], *min_element(lows, lows + 8),
+                          *max_element(highs, highs + 8)};
+        return reduceScalar(values, n, i, stats);
+    }
+
+    // The highest bit comes from the exponent of the value converted to float, one too high where
+    // the conversion rounded up to the next power of two
+    __attribute__((target("avx2")))
+    static void bucketsAVX2(const int32_t* values, size_t n, int sub_bucket_bits, uint16_t* out) {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i bias = _mm256_set1_epi32(127 + sub_bucket_bits - 1);
+        const __m128i half_bits = _mm_cvtsi32_si128(sub_bucket_bits - 1);
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256i v = _mm256_max_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i)), zero);
+            __m256i exponent = _mm256_srli_epi32(_mm256_castps_si256(_mm256_cvtepi32_ps(v)), 23);
+            // exponent - 127 is the highest bit, less one where v >> it is 0
+            __m256i rounded_up = _mm256_cmpeq_epi32(_mm256_srlv_epi32(v, _mm256_sub_epi32(exponent,
+                                                    _mm256_set1_epi32(127))), zero);
+            exponent = _mm256_add_epi32(exponent, rounded_up);
+            __m256i shift = _mm256_max_epi32(_mm256_sub_epi32(exponent, bias), zero);
+            __m256i bucket = _mm256_add_epi32(_mm256_sll_epi32(shift, half_bits), _mm256_srlv_epi32(v, shift));
+            // Buckets fit in 16 bits; packing the two halves keeps them in order
+            __m128i packed = _mm_packus_epi32(_mm256_castsi256_si128(bucket), _mm256_extracti128_si256(bucket, 1));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), packed);
+        }
+        bucketsScalar(values + i, n - i, sub_bucket_bits, out + i);
+    }
+
+    __attribute__((target("avx512f")))
+    static void deriveAVX512(const int32_t* arrival, const int32_t* burst, const int32_t* completion, size_t n,
+                             int32_t* turnaround, int32_t* waiting) {
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            __m512i a = _mm512_loadu_si512(arrival + i);
+            __m512i b = _mm512_loadu_si512(burst + i);
+            __m512i c = _mm512_loadu_si512(completion + i);
+            __m512i t = _mm512_sub_epi32(c, a);
+            _mm512_storeu_si512(turnaround + i, t);
+            _mm512_storeu_si512(waiting + i, _mm512_sub_epi32(t, b));
+        }
+        deriveScalar(arrival + i, burst + i, completion + i, n - i, turnaround + i, waiting + i);
+    }
+
+    // The AVX-512 kernels use the zero-masked forms of the intrinsics with every lane set; they
+    // compute the same as the plain ones, which GCC 12 wrongly warns read an uninitialized vector
+    __attribute__((target("avx512f")))
+    static ColumnStats reduceAVX512(const int32_t* values, size_t n) {
+        if (n < 16) {
+            return reduceScalar(values, n, 0, {0, INT_MAX, INT_MIN});
+        }
+        const __mmask16 all = 0xffff;
+        __m512i sum = _mm512_setzero_si512();
+        __m512i low = _mm512_set1_epi32(INT_MAX);
+        __m512i high = _mm512_set1_epi32(INT_MIN);
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            __m512i v = _mm512_loadu_si512(values + i);
+            __m256i first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+            __m256i second = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i + 8));
+            sum = _mm512_add_epi64(sum, _mm512_maskz_cvtepi32_epi64(0xff, first));
+            sum = _mm512_add_epi64(sum, _mm512_maskz_cvtepi32_epi64(0xff, second));
+            low = _mm512_maskz_min_epi32(all, low, v);
+            high = _mm512_maskz_max_epi32(all, high, v);
+        }
+        alignas(64) long long sums[8];
+        alignas(64) int32_t lows[16];
+        alignas(64) int32_t highs[16];
+        _mm512_store_si512(sums, sum);
+        _mm512_store_si512(lows, low);
+        _mm512_store_si512(highs, high);
+        ColumnStats stats{0, *min_element(lows, lows + 16), *max_element(highs, highs + 16)};
+        for (long long partial : sums) {
+            stats.sum += partial;
+        }
+        return reduceScalar(values, n, i, stats);
+    }
+
+    __attribute__((target("avx512f,avx512cd")))
+    static void bucketsAVX512(const int32_t* values, size_t n, int sub_bucket_bits, uint16_t* out) {
+        const __mmask16 all = 0xffff;
+        const __m512i zero = _mm512_setzero_si512();
+        const __m512i top = _mm512_set1_epi32(31 - (sub_bucket_bits - 1));
+        const __m128i half_bits = _mm_cvtsi32_si128(sub_bucket_bits - 1);
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            __m512i v = _mm512_maskz_max_epi32(all, _mm512_loadu_si512(values + i), zero);
+            // highest bit - (sub_bucket_bits - 1), with lzcnt(0) = 32 giving a negative shift
+            __m512i shift = _mm512_maskz_max_epi32(all, _mm512_sub_epi32(top, _mm512_lzcnt_epi32(v)), zero);
+            __m512i bucket = _mm512_add_epi32(_mm512_maskz_sll_epi32(all, shift, half_bits),
+                                              _mm512_maskz_srlv_epi32(all, v, shift));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm512_maskz_cvtepi32_epi16(all, bucket));
+        }
+        bucketsScalar(values + i, n - i, sub_bucket_bits, out + i);
+    }
+#endif
+
+public:
+    static bool supported(KernelIsa isa) {
+#ifdef STATS_KERNELS_X86
+        switch (isa) {
+            case KernelIsa::AVX512: return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512cd");
+            case KernelIsa::AVX2: return __builtin_cpu_supports("avx2");
+            default: return true;
+        }
+#else
+        return isa == KernelIsa::Scalar;
+#endif
+    }
+
+    // The widest instruction set this CPU runs, found once
+    static KernelIsa best() {
+        static const KernelIsa isa = supported(KernelIsa::AVX512) ? KernelIsa::AVX512
+                                   : supported(KernelIsa::AVX2) ? KernelIsa::AVX2 : KernelIsa::Scalar;
+        return isa;
+    }
+
+    static const char* name(KernelIsa isa) {
+        switch (isa) {
+            case KernelIsa::AVX512: return "avx512";
+            case KernelIsa::AVX2: return "avx2";
+            default: return "scalar";
+        }
+    }
+
+    // isa must be supported()
+    static void derive(const int32_t* arrival, const int32_t* burst, const int32_t* completion, size_t n,
+                       int32_t* turnaround, int32_t* waiting, KernelIsa isa = best()) {
+#ifdef STATS_KERNELS_X86
+        if (isa == KernelIsa::AVX512) {
+            return deriveAVX512(arrival, burst, completion, n, turnaround, waiting);
+        }
+        if (isa == KernelIsa::AVX2) {
+            return deriveAVX2(arrival, burst, completion, n, turnaround, waiting);
+        }
+#endif
+        deriveScalar(arrival, burst, completion, n, turnaround, waiting);
+    }
+
+    static ColumnStats reduce(const int32_t* values, size_t n, KernelIsa isa = best()) {
+        if (n == 0) {
+            return {};
+        }
+#ifdef STATS_KERNELS_X86
+        if (isa == KernelIsa::AVX512) {
+            return reduceAVX512(values, n);
+        }
+        if (isa == KernelIsa::AVX2) {
+            return reduceAVX2(values, n);
+        }
+#endif
+        return reduceScalar(values, n, 0, {0, INT_MAX, INT_MIN});
+    }
+
+    // Buckets are below 2^16 for the sub_bucket_bits LogHistogram uses
+    static void buckets(const int32_t* values, size_t n, int sub_bucket_bits, uint16_t* out, KernelIsa isa = best()) {
+#ifdef STATS_KERNELS_X86
+        if (isa == KernelIsa::AVX512) {
+            return bucketsAVX512(values, n, sub_bucket_bits, out);
+        }
+        if (isa == KernelIsa::AVX2) {
+            return bucketsAVX2(values, n, sub_bucket_bits, out);
+        }
+#endif
+        bucketsScalar(values, n, sub_bucket_bits, out);
+    }
+};
+
+#endif
@@ -0,0 +1,121 @@
+#ifndef BATCHING_TRACE_SINK_HPP
+#define BATCHING_TRACE_SINK_HPP
+#pragma once
+#include <chrono>
+#include <functional>
+#include <utility>
+#include <vector>
+#include "../json.hpp"
+#include "../Type.hpp"
+#include "JsonTraceSink.hpp"
+
+using namespace std;
+
+// Sink that hands the schedule over in batches while the engine runs. A batch is emitted once it
+// holds batch_rows rows or max_delay has passed since the previous one, so the first rows leave
+// within milliseconds however long the run. Rows are the same objects JsonTraceSink would return.
+// emit may block (flow control) or throw to abandon the run; at most one batch is held here.
+class BatchingTraceSink {
+public:
+    using Emit = function<void(vector<nlohmann::json>& gantt_rows, vector<nlohmann::json>& stats_rows)>;
+
+private:
+    Emit emit;
+    size_t batch_rows;
+    chrono::steady_clock::duration max_delay;
+    chrono::steady_clock::time_point last_emit = chrono::steady_clock::now();
+
+    vector<nlohmann::json> gantt_rows;
+    vector<nlohmann::json> stats_rows;
+    size_t total_segments = 0;
+    size_t total_processes = 0;
+
+    // The newest Gantt row is held back until the next one begins, since engines may still move its end
+    nlohmann::json open_row;
+    bool open = false;
+
+    void flush() {
+        if (gantt_rows.empty() && stats_rows.empty()) {
+            return;
+        }
+        emit(gantt_rows, stats_rows);
+        gantt_rows.clear();
+        stats_rows.clear();
+        last_emit = chrono::steady_clock::now();
+    }
+
+    void rowAdded() {
+        if (gantt_rows.size() + stats_rows.size() >= batch_rows ||
+            chrono::steady_clock::now() - last_emit >= max_delay) {
+            flush();
+        }
+    }
+
+    void closeOpenRow() {
+        if (open) {
+            gantt_rows.push_back(std::move(open_row));
+            open = false;
+            total_segments++;
+            rowAdded();
+        }
+    }
+
+public:
+    BatchingTraceSink(Emit on_batch, size_t rows_per_batch, chrono::milliseconds delay)
+        : emit(std::move(on_batch)), batch_rows(rows_per_batch > 0 ? rows_per_batch : 1), max_delay(delay) {}
+
+    template <typename Time, typename Describe>
+    void beginSegment(int process_id, Time start_time, int queue_level, Describe&& describe) {
+        closeOpenRow();
+        open_row = nlohmann::json();
+        open_row["process_id"] = process_id;
+        open_row["start_time"] = start_time;
+        describe(open_row);
+        open = true;
+    }
+
+    template <typename Time>
+    void endSegment(Time end_time) {
+        if (open) {
+            open_row["end_time"] = end_time;
+        }
+    }
+
+    template <typename Time>
+    void closeSegment(Time end_time) {
+        if (open && !open_row.contains("end_time")) {
+            open_row["end_time"] = end_time;
+        }
+    }
+
+    template <typename Time>
+    void completeProcess(const BasicProcess<Time>& p, Time completion_time) {
+        stats_rows.push_back(JsonTraceSink::statsRow(p, completion_time));
+        total_processes++;
+        rowAdded();
+    }
+
+    template <typename Time, typename Extra>
+    void completeProcess(const BasicProcess<Time>& p, Time completion_time, const char* extra_name, Extra extra_value) {
+        nlohmann::json row = JsonTraceSink::statsRow(p, completion_time);
+        row[extra_name] = extra_value;
+        stats_rows.push_back(std::move(row));
+        total_processes++;
+        rowAdded();
+    }
+
+    void finish() {
+        closeOpenRow();
+        flush();
+    }
+
+    size_t segments() const {
+        return total_segments;
+    }
+
+    size_t processes() const {
+        return total_processes;
+    }
+};
+
+#endif
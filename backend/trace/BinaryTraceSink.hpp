@@ -0,0 +1,166 @@
+#ifndef BINARY_TRACE_SINK_HPP
+#define BINARY_TRACE_SINK_HPP
+#pragma once
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include <utility>
+#include "../json.hpp"
+#include "../Type.hpp"
+#include "JsonTraceSink.hpp"
+
+using namespace std;
+
+enum class BinaryFormat { CBOR, MessagePack };
+
+// Encodes the schedule document ({"gantt_chart": [...], "process_stats": [...], ...}) as CBOR or
+// MessagePack while the engine runs. Each row is encoded as soon as it is final and only the encoded
+// bytes are kept, so the whole-document DOM is never built. The output is byte-identical to
+// json::to_cbor / json::to_msgpack of the JsonTraceSink document.
+class BinaryTraceSink {
+private:
+    BinaryFormat format;
+    vector<uint8_t> gantt_bytes;
+    vector<uint8_t> stats_bytes;
+    size_t gantt_rows = 0;
+    size_t stats_rows = 0;
+
+    // The newest Gantt row stays a small DOM until the next row begins, since engines may still move its end
+    nlohmann::json open_row;
+    bool open = false;
+
+    void encode(const nlohmann::json& value, vector<uint8_t>& out) const {
+        if (format == BinaryFormat::CBOR) {
+            nlohmann::json::to_cbor(value, out);
+        } else {
+            nlohmann::json::to_msgpack(value, out);
+        }
+    }
+
+    static void putBigEndian(vector<uint8_t>& out, uint64_t value, int bytes) {
+        for (int i = bytes - 1; i >= 0; i--) {
+            out.push_back(static_cast<uint8_t>((value >> (8 * i)) & 0xff));
+        }
+    }
+
+    // Container header with the same width choices as json.hpp's binary writers
+    void putHeader(vector<uint8_t>& out, size_t size, bool is_map) const {
+        if (format == BinaryFormat::CBOR) {
+            uint8_t major = is_map ? 0xa0 : 0x80;
+            if (size <= 0x17) {
+                out.push_back(static_cast<uint8_t>(major + size));
+            } else if (size <= 0xff) {
+                out.push_back(major + 0x18);
+                putBigEndian(out, size, 1);
+            } else if (size <= 0xffff) {
+                out.push_back(major + 0x19);
+                putBigEndian(out, size, 2);
+            } else if (size <= 0xffffffffull) {
+                out.push_back(major + 0x1a);
+                putBigEndian(out, size, 4);
+            } else {
+                out.push_back(major + 0x1b);
+                putBigEndian(out, size, 8);
+            }
+        } else {
+            if (size <= 15) {
+                out.push_back(static_cast<uint8_t>((is_map ? 0x80 : 0x90) | size));
+            } else if (size <= 0xffff) {
+                out.push_back(is_map ? 0xde : 0xdc);
+                putBigEndian(out, size, 2);
+            } else {
+                out.push_back(is_map ? 0xdf : 0xdd);
+                putBigEndian(out, size, 4);
+            }
+        }
+    }
+
+    void flushOpenRow() {
+        if (open) {
+            encode(open_row, gantt_bytes);
+            gantt_rows++;
+            open = false;
+        }
+    }
+
+    void addStats(const nlohmann::json& row) {
+        encode(row, stats_bytes);
+        stats_rows++;
+    }
+
+public:
+    explicit BinaryTraceSink(BinaryFormat output_format) : format(output_format) {}
+
+    template <typename Time, typename Describe>
+    void beginSegment(int process_id, Time start_time, int queue_level, Describe&& describe) {
+        flushOpenRow();
+        open_row = nlohmann::json();
+        open_row["process_id"] = process_id;
+        open_row["start_time"] = start_time;
+        describe(open_row);
+        open = true;
+    }
+
+    template <typename Time>
+    void endSegment(Time end_time) {
+        if (open) {
+            open_row["end_time"] = end_time;
+        }
+    }
+
+    template <typename Time>
+    void closeSegment(Time end_time) {
+        if (open && !open_row.contains("end_time")) {
+            open_row["end_time"] = end_time;
+        }
+    }
+
+    template <typename Time>
+    void completeProcess(const BasicProcess<Time>& p, Time completion_time) {
+        addStats(JsonTraceSink::statsRow(p, completion_time));
+    }
+
+    template <typename Time, typename Extra>
+    void completeProcess(const BasicProcess<Time>& p, Time completion_time, const char* extra_name, Extra extra_value) {
+        nlohmann::json row = JsonTraceSink::statsRow(p, completion_time);
+        row[extra_name] = extra_value;
+        addStats(row);
+    }
+
+    void finish() {
+        flushOpenRow();
+    }
+
+    // The encoded document; fields are extra top-level members such as {"status": "success"}
+    string document(const nlohmann::json& fields = nlohmann::json::object()) {
+        finish();
+
+        // Members in json.hpp's (sorted) key order, the two arrays spliced in from their encoded rows
+        map<string, const nlohmann::json*> members;
+        members["gantt_chart"] = nullptr;
+        members["process_stats"] = nullptr;
+        for (auto it = fields.begin(); it != fields.end(); ++it) {
+            members[it.key()] = &it.value();
+        }
+
+        vector<uint8_t> out;
+        out.reserve(gantt_bytes.size() + stats_bytes.size() + 64);
+        putHeader(out, members.size(), true);
+        for (const auto& member : members) {
+            encode(nlohmann::json(member.first), out);
+            if (member.second != nullptr) {
+                encode(*member.second, out);
+            } else if (member.first == "gantt_chart") {
+                putHeader(out, gantt_rows, false);
+                out.insert(out.end(), gantt_bytes.begin(), gantt_bytes.end());
+            } else {
+                putHeader(out, stats_rows, false);
+                out.insert(out.end(), stats_bytes.begin(), stats_bytes.end());
+            }
+        }
+        return string(out.begin(), out.end());
+    }
+};
+
+#endif
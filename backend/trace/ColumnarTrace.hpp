@@ -0,0 +1,438 @@
+#ifndef COLUMNAR_TRACE_HPP
+#define COLUMNAR_TRACE_HPP
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "../json.hpp"
+#include "../Type.hpp"
+#include "../MappedFile.hpp"
+#include "../metrics/StatsKernels.hpp"
+
+using namespace std;
+
+// Columnar binary schedule file (.ctrace). All integers are little-endian.
+//
+//   "SCHEDCOL"                        8-byte magic
+//   column chunks                     one per column per row group, each on an 8-byte boundary
+//   column table   32 bytes each      u8 table, u8 column, u16 0, u32 0, char name[24]
+//   chunk table    32 bytes each      u8 table, u8 column, u8 encoding, u8 0, u32 rows,
+//                                     u32 dictionary_size, u32 0, u64 offset, u64 length
+//   metadata                          JSON text (algorithm, parameters), zero padded to 8 bytes
+//   trailer        48 bytes           u64 footer_offset, u64 segment_rows, u64 process_rows,
+//                                     u32 column_count, u32 chunk_count, u32 metadata_length,
+//                                     u32 version, "SCHEDCOL"
+//
+// Table 0 holds the Gantt segments (process_id, start_time, end_time, queue_level), table 1 the
+// per-process stats. A chunk is either a plain int32 array or a sorted int32 dictionary followed by
+// uint8 or uint16 codes, whichever is smallest. Readers map the file, read the trailer and index
+// straight into the chunks.
+enum class TraceTable : uint8_t { Segments = 0, Processes = 1 };
+
+enum class ChunkEncoding : uint8_t { Plain = 0, Dictionary8 = 1, Dictionary16 = 2 };
+
+struct TraceChunk {
+    TraceTable table;
+    uint8_t column;
+    ChunkEncoding encoding;
+    uint32_t rows;
+    uint32_t dictionary_size;
+    uint64_t offset;
+    uint64_t length;
+};
+
+class ColumnarTraceFormat {
+public:
+    static constexpr char MAGIC[9] = "SCHEDCOL";
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t ENTRY_SIZE = 32;
+    static constexpr size_t TRAILER_SIZE = 48;
+    static constexpr size_t NAME_SIZE = 24;
+
+    static void putLE(string& out, uint64_t value, int bytes) {
+        for (int i = 0; i < bytes; i++) {
+            out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+        }
+    }
+
+    static uint64_t getLE(const char* data, int bytes) {
+        uint64_t value = 0;
+        for (int i = 0; i < bytes; i++) {
+            value |= static_cast<uint64_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+        }
+        return value;
+    }
+
+    static void pad(string& out, size_t base) {
+        while ((base + out.size()) % 8 != 0) {
+            out.push_back('\0');
+        }
+    }
+};
+
+// Sink that streams the schedule into a .ctrace file. Rows are buffered per row group and each full
+// group is encoded and written immediately, so memory stays bounded however long the simulation.
+// Only finish(), called once the engine has returned, writes the footer and trailer; a run that
+// throws leaves a file without them, which ColumnarTraceReader rejects.
+class ColumnarTraceWriter {
+public:
+    static constexpr size_t ROW_GROUP_ROWS = 1 << 16;
+
+private:
+    ostream& out;
+    nlohmann::json metadata;
+    uint64_t offset = 0;
+
+    vector<string> segment_names = {"process_id", "start_time", "end_time", "queue_level"};
+    vector<string> process_names = {"process_id", "arrival_time", "burst_time", "priority",
+                                    "completion_time", "turnaround_time", "waiting_time"};
+    vector<vector<int32_t>> segment_columns = vector<vector<int32_t>>(4);
+    vector<vector<int32_t>> process_columns = vector<vector<int32_t>>(7);
+    vector<TraceChunk> chunks;
+    uint64_t segment_rows = 0;
+    uint64_t process_rows = 0;
+
+    // The newest segment stays open until the next one begins, since engines may still move its end
+    bool open = false;
+    bool end_set = false;
+    int32_t open_row[4] = {0, 0, 0, 0};
+    bool finished = false;
+
+    void write(const string& bytes) {
+        out.write(bytes.data(), static_cast<streamsize>(bytes.size()));
+        offset += bytes.size();
+    }
+
+    void writeChunk(TraceTable table, uint8_t column, vector<int32_t>& values) {
+        TraceChunk chunk{table, column, ChunkEncoding::Plain, static_cast<uint32_t>(values.size()), 0, offset, 0};
+
+        vector<int32_t> dictionary = values;
+        sort(dictionary.begin(), dictionary.end());
+        dictionary.erase(unique(dictionary.begin(), dictionary.end()), dictionary.end());
+        size_t plain_size = 4 * values.size();
+        size_t dict8_size = dictionary.size() <= 256 ? 4 * dictionary.size() + values.size() : SIZE_MAX;
+        size_t dict16_size = dictionary.size() <= 65536 ? 4 * dictionary.size() + 2 * values.size() : SIZE_MAX;
+
+        string bytes;
+        if (min(dict8_size, dict16_size) < plain_size) {
+            int code_bytes = dict8_size <= dict16_size ? 1 : 2;
+            chunk.encoding = code_bytes == 1 ? ChunkEncoding::Dictionary8 : ChunkEncoding::Dictionary16;
+            chunk.dictionary_size = static_cast<uint32_t>(dictionary.size());
+            bytes.reserve(4 * dictionary.size() + code_bytes * values.size() + 8);
+            for (int32_t value : dictionary) {
+                ColumnarTraceFormat::putLE(bytes, static_cast<uint32_t>(value), 4);
+            }
+            for (int32_t value : values) {
+                auto code = lower_bound(dictionary.begin(), dictionary.end(), value) - dictionary.begin();
+                ColumnarTraceFormat::putLE(bytes, static_cast<uint64_t>(code), code_bytes);
+            }
+        } else {
+            bytes.reserve(plain_size + 8);
+            for (int32_t value : values) {
+                ColumnarTraceFormat::putLE(bytes, static_cast<uint32_t>(value), 4);
+            }
+        }
+
+        chunk.length = bytes.size();
+        ColumnarTraceFormat::pad(bytes, offset);
+        write(bytes);
+        chunks.push_back(chunk);
+        values.clear();
+    }
+
+    void flushSegments() {
+        if (segment_columns[0].empty()) {
+            return;
+        }
+        for (size_t c = 0; c < segment_columns.size(); c++) {
+            writeChunk(TraceTable::Segments, static_cast<uint8_t>(c), segment_columns[c]);
+        }
+    }
+
+    void flushProcesses() {
+        if (process_columns[0].empty()) {
+            return;
+        }
+        // Turnaround and waiting times are derived for the whole row group at once
+        size_t rows = process_columns[0].size();
+        process_columns[5].resize(rows);
+        process_columns[6].resize(rows);
+        StatsKernels::derive(process_columns[1].data(), process_columns[2].data(), process_columns[4].data(), rows,
+                             process_columns[5].data(), process_columns[6].data());
+        for (size_t c = 0; c < process_columns.size(); c++) {
+            writeChunk(TraceTable::Processes, static_cast<uint8_t>(c), process_columns[c]);
+        }
+    }
+
+    void closeOpenSegment(int32_t next_start) {
+        if (!open) {
+            return;
+        }
+        // A row nobody ended (MLFQ idle ticks) lasts until the next row starts
+        if (!end_set) {
+            open_row[2] = next_start;
+        }
+        for (int c = 0; c < 4; c++) {
+            segment_columns[c].push_back(open_row[c]);
+        }
+        segment_rows++;
+        open = false;
+        if (segment_columns[0].size() >= ROW_GROUP_ROWS) {
+            flushSegments();
+        }
+    }
+
+    // Columns 5 and 6 are filled in by flushProcesses()
+    void addProcess(const Process& p, int completion_time) {
+        process_columns[0].push_back(p.p_id);
+        process_columns[1].push_back(p.arrival_time);
+        process_columns[2].push_back(p.burst_time);
+        process_columns[3].push_back(p.priority);
+        process_columns[4].push_back(completion_time);
+        process_rows++;
+    }
+
+    void flushProcessGroup() {
+        if (process_columns[0].size() >= ROW_GROUP_ROWS) {
+            flushProcesses();
+        }
+    }
+
+public:
+    // metadata is stored in the footer as-is (scheduling_algorithm, quantum, ...)
+    explicit ColumnarTraceWriter(ostream& output, nlohmann::json file_metadata = nlohmann::json::object())
+        : out(output), metadata(std::move(file_metadata)) {
+        write(string(ColumnarTraceFormat::MAGIC, 8));
+    }
+
+    template <typename Describe>
+    void beginSegment(int process_id, int start_time, int queue_level, Describe&&) {
+        closeOpenSegment(start_time);
+        open_row[0] = process_id;
+        open_row[1] = start_time;
+        open_row[2] = start_time;
+        open_row[3] = queue_level;
+        open = true;
+        end_set = false;
+    }
+
+    void endSegment(int end_time) {
+        if (open) {
+            open_row[2] = end_time;
+            end_set = true;
+        }
+    }
+
+    void closeSegment(int end_time) {
+        if (open && !end_set) {
+            endSegment(end_time);
+        }
+    }
+
+    void completeProcess(const Process& p, int completion_time) {
+        addProcess(p, completion_time);
+        if (process_columns.size() > 7) {
+            process_columns[7].push_back(0);
+        }
+        flushProcessGroup();
+    }
+
+    void completeProcess(const Process& p, int completion_time, const char* extra_name, int extra_value) {
+        if (process_names.size() == 7) {
+            if (process_rows > 0) {
+                throw logic_error("Trace stats column added after the first process");
+            }
+            process_names.push_back(extra_name);
+            process_columns.emplace_back();
+        }
+        addProcess(p, completion_time);
+        process_columns[7].push_back(extra_value);
+        flushProcessGroup();
+    }
+
+    void finish() {
+        if (finished) {
+            return;
+        }
+        finished = true;
+        if (open) {
+            closeOpenSegment(open_row[1]);
+        }
+        flushSegments();
+        flushProcesses();
+
+        uint64_t footer_offset = offset;
+        string footer;
+        auto putColumns = [&](TraceTable table, const vector<string>& names) {
+            for (size_t c = 0; c < names.size(); c++) {
+                ColumnarTraceFormat::putLE(footer, static_cast<uint8_t>(table), 1);
+                ColumnarTraceFormat::putLE(footer, c, 1);
+                ColumnarTraceFormat::putLE(footer, 0, 6);
+                string name = names[c].substr(0, ColumnarTraceFormat::NAME_SIZE);
+                name.resize(ColumnarTraceFormat::NAME_SIZE, '\0');
+                footer += name;
+            }
+        };
+        putColumns(TraceTable::Segments, segment_names);
+        putColumns(TraceTable::Processes, process_names);
+
+        for (const auto& chunk : chunks) {
+            ColumnarTraceFormat::putLE(footer, static_cast<uint8_t>(chunk.table), 1);
+            ColumnarTraceFormat::putLE(footer, chunk.column, 1);
+            ColumnarTraceFormat::putLE(footer, static_cast<uint8_t>(chunk.encoding), 1);
+            ColumnarTraceFormat::putLE(footer, 0, 1);
+            ColumnarTraceFormat::putLE(footer, chunk.rows, 4);
+            ColumnarTraceFormat::putLE(footer, chunk.dictionary_size, 4);
+            ColumnarTraceFormat::putLE(footer, 0, 4);
+            ColumnarTraceFormat::putLE(footer, chunk.offset, 8);
+            ColumnarTraceFormat::putLE(footer, chunk.length, 8);
+        }
+
+        string metadata_text = metadata.dump();
+        footer += metadata_text;
+        ColumnarTraceFormat::pad(footer, offset);
+
+        ColumnarTraceFormat::putLE(footer, footer_offset, 8);
+        ColumnarTraceFormat::putLE(footer, segment_rows, 8);
+        ColumnarTraceFormat::putLE(footer, process_rows, 8);
+        ColumnarTraceFormat::putLE(footer, segment_names.size() + process_names.size(), 4);
+        ColumnarTraceFormat::putLE(footer, chunks.size(), 4);
+        ColumnarTraceFormat::putLE(footer, metadata_text.size(), 4);
+        ColumnarTraceFormat::putLE(footer, ColumnarTraceFormat::VERSION, 4);
+        footer.append(ColumnarTraceFormat::MAGIC, 8);
+        write(footer);
+        out.flush();
+    }
+};
+
+// Reads a .ctrace file through a read-only mapping; columns are decoded on request
+class ColumnarTraceReader {
+private:
+    MappedFile file;
+    vector<string> segment_names;
+    vector<string> process_names;
+    vector<TraceChunk> chunks;
+    nlohmann::json metadata_json;
+    uint64_t segment_rows = 0;
+    uint64_t process_rows = 0;
+
+    [[noreturn]] void fail(const string& message) const {
+        throw runtime_error("Invalid columnar trace: " + message);
+    }
+
+    const vector<string>& namesOf(TraceTable table) const {
+        return table == TraceTable::Segments ? segment_names : process_names;
+    }
+
+public:
+    explicit ColumnarTraceReader(const string& path) : file(path) {
+        const char* data = file.data();
+        size_t size = file.size();
+        if (size < 8 + ColumnarTraceFormat::TRAILER_SIZE || memcmp(data, ColumnarTraceFormat::MAGIC, 8) != 0) {
+            fail("missing magic");
+        }
+        const char* trailer = data + size - ColumnarTraceFormat::TRAILER_SIZE;
+        if (memcmp(trailer + 40, ColumnarTraceFormat::MAGIC, 8) != 0) {
+            fail("missing trailer");
+        }
+        uint64_t footer_offset = ColumnarTraceFormat::getLE(trailer, 8);
+        segment_rows = ColumnarTraceFormat::getLE(trailer + 8, 8);
+        process_rows = ColumnarTraceFormat::getLE(trailer + 16, 8);
+        uint64_t column_count = ColumnarTraceFormat::getLE(trailer + 24, 4);
+        uint64_t chunk_count = ColumnarTraceFormat::getLE(trailer + 28, 4);
+        uint64_t metadata_length = ColumnarTraceFormat::getLE(trailer + 32, 4);
+        if (ColumnarTraceFormat::getLE(trailer + 36, 4) != ColumnarTraceFormat::VERSION) {
+            fail("unsupported version");
+        }
+
+        uint64_t tables_end = footer_offset + (column_count + chunk_count) * ColumnarTraceFormat::ENTRY_SIZE;
+        if (footer_offset < 8 || tables_end + metadata_length > size - ColumnarTraceFormat::TRAILER_SIZE) {
+            fail("footer out of range");
+        }
+
+        const char* entry = data + footer_offset;
+        for (uint64_t i = 0; i < column_count; i++, entry += ColumnarTraceFormat::ENTRY_SIZE) {
+            const char* name = entry + 8;
+            string column(name, strnlen(name, ColumnarTraceFormat::NAME_SIZE));
+            (entry[0] == 0 ? segment_names : process_names).push_back(column);
+        }
+        for (uint64_t i = 0; i < chunk_count; i++, entry += ColumnarTraceFormat::ENTRY_SIZE) {
+            TraceChunk chunk;
+            chunk.table = static_cast<TraceTable>(entry[0]);
+            chunk.column = static_cast<uint8_t>(entry[1]);
+            chunk.encoding = static_cast<ChunkEncoding>(entry[2]);
+            chunk.rows = static_cast<uint32_t>(ColumnarTraceFormat::getLE(entry + 4, 4));
+            chunk.dictionary_size = static_cast<uint32_t>(ColumnarTraceFormat::getLE(entry + 8, 4));
+            chunk.offset = ColumnarTraceFormat::getLE(entry + 16, 8);
+            chunk.length = ColumnarTraceFormat::getLE(entry + 24, 8);
+            if (chunk.offset + chunk.length > footer_offset || chunk.column >= namesOf(chunk.table).size()) {
+                fail("chunk out of range");
+            }
+            chunks.push_back(chunk);
+        }
+        metadata_json = nlohmann::json::parse(entry, entry + metadata_length);
+    }
+
+    uint64_t rows(TraceTable table) const {
+        return table == TraceTable::Segments ? segment_rows : process_rows;
+    }
+
+    const vector<string>& columns(TraceTable table) const {
+        return namesOf(table);
+    }
+
+    const vector<TraceChunk>& chunkList() const {
+        return chunks;
+    }
+
+    const nlohmann::json& metadata() const {
+        return metadata_json;
+    }
+
+    // Decodes every chunk of one column in row order
+    vector<int32_t> column(TraceTable table, const string& name) const {
+        const auto& names = namesOf(table);
+        auto it = find(names.begin(), names.end(), name);
+        if (it == names.end()) {
+            throw out_of_range("No column named " + name);
+        }
+        uint8_t index = static_cast<uint8_t>(it - names.begin());
+
+        vector<int32_t> values;
+        values.reserve(rows(table));
+        for (const auto& chunk : chunks) {
+            if (chunk.table != table || chunk.column != index) {
+                continue;
+            }
+            const char* data = file.data() + chunk.offset;
+            if (chunk.encoding == ChunkEncoding::Plain) {
+                if (chunk.length < 4ull * chunk.rows) {
+                    fail("truncated chunk");
+                }
+                for (uint32_t r = 0; r < chunk.rows; r++) {
+                    values.push_back(static_cast<int32_t>(ColumnarTraceFormat::getLE(data + 4 * r, 4)));
+                }
+            } else {
+                int code_bytes = chunk.encoding == ChunkEncoding::Dictionary8 ? 1 : 2;
+                if (chunk.length < 4ull * chunk.dictionary_size + uint64_t(code_bytes) * chunk.rows) {
+                    fail("truncated chunk");
+                }
+                const char* codes = data + 4 * chunk.dictionary_size;
+                for (uint32_t r = 0; r < chunk.rows; r++) {
+                    uint64_t code = ColumnarTraceFormat::getLE(codes + code_bytes * r, code_bytes);
+                    if (code >= chunk.dictionary_size) {
+                        fail("dictionary code out of range");
+                    }
+                    values.push_back(static_cast<int32_t>(ColumnarTraceFormat::getLE(data + 4 * code, 4)));
+                }
+            }
+        }
+        return values;
+    }
+};
+
+#endif
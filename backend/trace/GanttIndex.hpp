@@ -0,0 +1,303 @@
+#ifndef GANTT_INDEX_HPP
+#define GANTT_INDEX_HPP
+#pragma once
+#include <algorithm>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "../json.hpp"
+#include "../Type.hpp"
+#include "JsonTraceSink.hpp"
+
+using namespace std;
+using json = nlohmann::json;
+
+// Sink that keeps a schedule indexed by time, so that the Gantt rows overlapping a window can be read
+// back without the rest of the chart. Each row is split into its segment (process, start, end) and its
+// queue state (every other field: ready_queue, queues, queue_level, ...). The queue state is stored in
+// full every CHECKPOINT_SEGMENTS rows and otherwise as a patch against the row before, so memory grows
+// with how much the queues change rather than with their length times the number of rows. A window
+// query binary-searches the segments and replays at most CHECKPOINT_SEGMENTS patches to reach it.
+class GanttIndex {
+public:
+    static constexpr size_t CHECKPOINT_SEGMENTS = 64;
+
+    struct Segment {
+        int process_id;
+        int start_time;
+        // Rows without an end_time (idle rows of MLFQ) end where the next row starts
+        int end_time;
+        bool has_end;
+    };
+
+private:
+    vector<Segment> segments;
+    vector<json> states;
+    vector<string> stats;
+    json previous_state;
+
+    json open_row;
+    bool open = false;
+
+    static bool isIntArray(const json& value) {
+        if (!value.is_array()) {
+            return false;
+        }
+        for (const auto& item : value) {
+            if (!item.is_number_integer()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // to as from[d:] with its first p and last s entries kept and the middle replaced by m; d is
+    // 0 or where to's head sits in from, whichever leaves less to store (FIFO queues pop the front)
+    static json splice(const json& from, const json& to) {
+        vector<size_t> drops = {0};
+        if (!to.empty()) {
+            auto head = find(from.begin(), from.end(), to.front());
+            if (head != from.end() && head != from.begin()) {
+                drops.push_back(head - from.begin());
+            }
+        }
+
+        json best;
+        size_t best_middle = 0;
+        for (size_t d : drops) {
+            size_t kept = from.size() - d;
+            size_t p = 0;
+            while (p < kept && p < to.size() && from[d + p] == to[p]) {
+                p++;
+            }
+            size_t s = 0;
+            while (s < kept - p && s < to.size() - p && from[from.size() - 1 - s] == to[to.size() - 1 - s]) {
+                s++;
+            }
+            size_t middle = to.size() - p - s;
+            if (best.is_null() || middle < best_middle) {
+                best = {{"p", p}, {"s", s}, {"m", json(to.begin() + p, to.begin() + p + middle)}};
+                if (d > 0) {
+                    best["d"] = d;
+                }
+                best_middle = middle;
+            }
+        }
+        return best;
+    }
+
+    // The patch that turns from into to; null when they are equal
+    static json diff(const json& from, const json& to) {
+        if (from == to) {
+            return nullptr;
+        }
+        if (isIntArray(from) && isIntArray(to)) {
+            return splice(from, to);
+        }
+        if (from.is_object() && to.is_object()) {
+            json changed = json::object();
+            json removed = json::array();
+            for (auto it = to.begin(); it != to.end(); ++it) {
+                auto old = from.find(it.key());
+                json patch = old == from.end() ? json{{"v", it.value()}} : diff(*old, it.value());
+                if (!patch.is_null()) {
+                    changed[it.key()] = std::move(patch);
+                }
+            }
+            for (auto it = from.begin(); it != from.end(); ++it) {
+                if (!to.contains(it.key())) {
+                    removed.push_back(it.key());
+                }
+            }
+            json patch = {{"o", std::move(changed)}};
+            if (!removed.empty()) {
+                patch["x"] = std::move(removed);
+            }
+            return patch;
+        }
+        if (from.is_array() && to.is_array() && from.size() == to.size()) {
+            json items = json::array();
+            for (size_t i = 0; i < to.size(); i++) {
+                items.push_back(diff(from[i], to[i]));
+            }
+            return {{"a", std::move(items)}};
+        }
+        return {{"v", to}};
+    }
+
+    static void apply(json& value, const json& patch) {
+        if (patch.contains("v")) {
+            value = patch["v"];
+        } else if (patch.contains("o")) {
+            const json& changed = patch["o"];
+            for (auto it = changed.begin(); it != changed.end(); ++it) {
+                apply(value[it.key()], it.value());
+            }
+            for (const auto& key : patch.value("x", json::array())) {
+                value.erase(key.get<string>());
+            }
+        } else if (patch.contains("a")) {
+            const json& items = patch["a"];
+            for (size_t i = 0; i < items.size(); i++) {
+                if (!items[i].is_null()) {
+                    apply(value[i], items[i]);
+                }
+            }
+        } else {
+            size_t d = patch.value("d", size_t(0));
+            size_t p = patch["p"];
+            size_t s = patch["s"];
+            json result = json::array();
+            for (size_t i = d; i < d + p; i++) {
+                result.push_back(value[i]);
+            }
+            for (const auto& item : patch["m"]) {
+                result.push_back(item);
+            }
+            for (size_t i = value.size() - s; i < value.size(); i++) {
+                result.push_back(value[i]);
+            }
+            value = std::move(result);
+        }
+    }
+
+    void closeOpenRow() {
+        if (!open) {
+            return;
+        }
+        open = false;
+        Segment segment;
+        segment.process_id = open_row["process_id"];
+        segment.start_time = open_row["start_time"];
+        segment.has_end = open_row.contains("end_time");
+        segment.end_time = segment.has_end ? open_row["end_time"].get<int>() : segment.start_time;
+        if (!segments.empty() && !segments.back().has_end) {
+            segments.back().end_time = segment.start_time;
+        }
+        segments.push_back(segment);
+
+        open_row.erase("process_id");
+        open_row.erase("start_time");
+        open_row.erase("end_time");
+        if ((segments.size() - 1) % CHECKPOINT_SEGMENTS == 0) {
+            states.push_back(open_row);
+        } else {
+            states.push_back(diff(previous_state, open_row));
+        }
+        previous_state = std::move(open_row);
+    }
+
+    // The queue state of segment i, replayed from the checkpoint at or before it
+    json stateAt(size_t i) const {
+        size_t checkpoint = i - i % CHECKPOINT_SEGMENTS;
+        json state = states[checkpoint];
+        for (size_t j = checkpoint + 1; j <= i; j++) {
+            if (!states[j].is_null()) {
+                apply(state, states[j]);
+            }
+        }
+        return state;
+    }
+
+public:
+    template <typename Describe>
+    void beginSegment(int process_id, int start_time, int queue_level, Describe&& describe) {
+        closeOpenRow();
+        open_row = json();
+        open_row["process_id"] = process_id;
+        open_row["start_time"] = start_time;
+        describe(open_row);
+        open = true;
+    }
+
+    void endSegment(int end_time) {
+        if (open) {
+            open_row["end_time"] = end_time;
+        }
+    }
+
+    void closeSegment(int end_time) {
+        if (open && !open_row.contains("end_time")) {
+            open_row["end_time"] = end_time;
+        }
+    }
+
+    void completeProcess(const Process& p, int completion_time) {
+        stats.push_back(JsonTraceSink::statsRow(p, completion_time).dump());
+    }
+
+    void completeProcess(const Process& p, int completion_time, const char* extra_name, int extra_value) {
+        json row = JsonTraceSink::statsRow(p, completion_time);
+        row[extra_name] = extra_value;
+        stats.push_back(row.dump());
+    }
+
+    void finish() {
+        closeOpenRow();
+        previous_state = json();
+    }
+
+    size_t size() const {
+        return segments.size();
+    }
+
+    int startTime() const {
+        return segments.empty() ? 0 : segments.front().start_time;
+    }
+
+    int endTime() const {
+        return segments.empty() ? 0 : segments.back().end_time;
+    }
+
+    // The process_stats rows as JSON text, in completion order
+    const vector<string>& statsRows() const {
+        return stats;
+    }
+
+    const vector<Segment>& segmentList() const {
+        return segments;
+    }
+
+    // Indices [first, last) of the segments that overlap [from, to)
+    pair<size_t, size_t> overlapping(int from, int to) const {
+        auto first = partition_point(segments.begin(), segments.end(), [&](const Segment& segment) {
+            return segment.end_time <= from;
+        });
+        auto last = partition_point(first, segments.end(), [&](const Segment& segment) {
+            return segment.start_time < to;
+        });
+        return {static_cast<size_t>(first - segments.begin()), static_cast<size_t>(last - segments.begin())};
+    }
+
+    // The Gantt rows that overlap [from, to), as JsonTraceSink would have written them. The first one
+    // is the row running at from, so its queue fields are the queue state at that time.
+    json window(int from, int to) const {
+        json rows = json::array();
+        size_t begin, end;
+        tie(begin, end) = overlapping(from, to);
+        if (begin == end) {
+            return rows;
+        }
+        json state = stateAt(begin);
+        for (size_t i = begin; i < end; i++) {
+            if (i > begin && !states[i].is_null()) {
+                if (i % CHECKPOINT_SEGMENTS == 0) {
+                    state = states[i];
+                } else {
+                    apply(state, states[i]);
+                }
+            }
+            json row = state;
+            row["process_id"] = segments[i].process_id;
+            row["start_time"] = segments[i].start_time;
+            if (segments[i].has_end) {
+                row["end_time"] = segments[i].end_time;
+            }
+            rows.push_back(std::move(row));
+        }
+        return rows;
+    }
+};
+
+#endif
@@ -0,0 +1,355 @@
+#ifndef GANTT_LOD_HPP
+#define GANTT_LOD_HPP
+#pragma once
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "../json.hpp"
+#include "../Type.hpp"
+#include "GanttIndex.hpp"
+
+using namespace std;
+using json = nlohmann::json;
+
+// Level-of-detail views of a Gantt chart: [from, to) cut into equal buckets, each reduced to how long
+// every process ran in it. Time no process ran (idle rows, or outside the chart) counts as idle.
+// A bucket keeps its top_k processes; the rest of its busy time is summed as other.
+struct LodBucket {
+    double start_time;
+    double end_time;
+    // (process_id, busy time), longest first
+    vector<pair<int, double>> busy;
+    double other = 0;
+
+    // {"start_time", "end_time", "process_id", "idle", "busy": [[process_id, fraction], ...], "other"};
+    // process_id is the process that ran longest, or -1 when the bucket was mostly idle
+    json toJson() const {
+        double width = end_time - start_time;
+        double busy_time = other;
+        for (const auto& entry : busy) {
+            busy_time += entry.second;
+        }
+        double idle = max(0.0, width - busy_time);
+        int dominant = !busy.empty() && busy.front().second > idle ? busy.front().first : -1;
+
+        json shares = json::array();
+        for (const auto& entry : busy) {
+            shares.push_back({entry.first, fraction(entry.second, width)});
+        }
+        json bucket = {
+            {"start_time", start_time},
+            {"end_time", end_time},
+            {"process_id", dominant},
+            {"idle", fraction(idle, width)},
+            {"busy", std::move(shares)}
+        };
+        if (other > 0) {
+            bucket["other"] = fraction(other, width);
+        }
+        return bucket;
+    }
+
+    static double fraction(double part, double width) {
+        return width > 0 ? round(part / width * 1e4) / 1e4 : 0.0;
+    }
+};
+
+// Reduces segments to buckets in a single pass. Segments must arrive in order of start time, as
+// engines emit them, so only the buckets the latest segment reaches are still open.
+class LodAccumulator {
+private:
+    // Key of the busy time that reduced buckets (add(const LodBucket&)) had already summed as other
+    static constexpr int OTHER = -1;
+
+    double from;
+    double width;
+    size_t bucket_count;
+    size_t top_k;
+    vector<LodBucket> buckets;
+    // Busy time per process of buckets[buckets.size()] onwards
+    deque<unordered_map<int, double>> open;
+
+    double edge(size_t i) const {
+        return from + width * i;
+    }
+
+    void closeBucketsBefore(size_t index) {
+        while (buckets.size() < index && buckets.size() < bucket_count) {
+            size_t i = buckets.size();
+            LodBucket bucket;
+            bucket.start_time = edge(i);
+            bucket.end_time = edge(i + 1);
+            if (!open.empty()) {
+                reduce(open.front(), bucket);
+                open.pop_front();
+            }
+            buckets.push_back(std::move(bucket));
+        }
+    }
+
+    void reduce(unordered_map<int, double>& time_by_process, LodBucket& bucket) const {
+        auto carried = time_by_process.find(OTHER);
+        if (carried != time_by_process.end()) {
+            bucket.other = carried->second;
+            time_by_process.erase(carried);
+        }
+        bucket.busy.assign(time_by_process.begin(), time_by_process.end());
+        sort(bucket.busy.begin(), bucket.busy.end(), [](const pair<int, double>& a, const pair<int, double>& b) {
+            return a.second != b.second ? a.second > b.second : a.first < b.first;
+        });
+        for (size_t i = top_k; i < bucket.busy.size(); i++) {
+            bucket.other += bucket.busy[i].second;
+        }
+        if (bucket.busy.size() > top_k) {
+            bucket.busy.resize(top_k);
+        }
+    }
+
+    // Calls add(slot, overlap) for every bucket that [lo, hi) overlaps
+    template <typename Add>
+    void spread(double lo, double hi, Add&& add) {
+        lo = max(lo, from);
+        hi = min(hi, edge(bucket_count));
+        if (hi <= lo) {
+            return;
+        }
+        size_t first = min(static_cast<size_t>((lo - from) / width), bucket_count - 1);
+        size_t last = min(static_cast<size_t>((hi - from) / width), bucket_count - 1);
+        closeBucketsBefore(first);
+        for (size_t i = max(first, buckets.size()); i <= last; i++) {
+            double overlap = min(hi, edge(i + 1)) - max(lo, edge(i));
+            if (overlap > 0) {
+                size_t slot = i - buckets.size();
+                while (open.size() <= slot) {
+                    open.emplace_back();
+                }
+                add(open[slot], overlap);
+            }
+        }
+    }
+
+public:
+    LodAccumulator(double range_from, double range_to, size_t count, size_t top_processes)
+        : from(range_from), bucket_count(max<size_t>(count, 1)), top_k(top_processes) {
+        width = max(range_to - range_from, 1e-9) / bucket_count;
+        buckets.reserve(bucket_count);
+    }
+
+    void add(int process_id, double start_time, double end_time) {
+        if (process_id < 0) {
+            return;
+        }
+        spread(start_time, end_time, [&](unordered_map<int, double>& time_by_process, double overlap) {
+            time_by_process[process_id] += overlap;
+        });
+    }
+
+    // Adds a bucket that was itself reduced from a finer view, spreading its busy time evenly over
+    // its range; buckets must arrive in order of start time as well
+    void add(const LodBucket& bucket) {
+        double span = bucket.end_time - bucket.start_time;
+        if (span <= 0) {
+            return;
+        }
+        spread(bucket.start_time, bucket.end_time, [&](unordered_map<int, double>& time_by_process, double overlap) {
+            double share = overlap / span;
+            for (const auto& entry : bucket.busy) {
+                time_by_process[entry.first] += entry.second * share;
+            }
+            if (bucket.other > 0) {
+                time_by_process[OTHER] += bucket.other * share;
+            }
+        });
+    }
+
+    double bucketWidth() const {
+        return width;
+    }
+
+    // Whether [lo, hi) lies inside a single bucket, so add(const LodBucket&) over it is exact
+    bool withinOneBucket(double lo, double hi) const {
+        if (lo < from || hi > edge(bucket_count)) {
+            return false;
+        }
+        size_t i = min(static_cast<size_t>((lo - from) / width), bucket_count - 1);
+        return lo >= edge(i) && hi <= edge(i + 1);
+    }
+
+    vector<LodBucket> finish() {
+        closeBucketsBefore(bucket_count);
+        return std::move(buckets);
+    }
+};
+
+// Sink that reduces engine output straight to buckets without keeping the rows
+class LodTraceSink {
+private:
+    LodAccumulator accumulator;
+    int process_id = -1;
+    int start_time = 0;
+    int end_time = 0;
+    bool has_end = false;
+    bool open = false;
+
+    // A row without an end_time (idle rows of MLFQ) ends where the next one starts
+    void closeOpenRow(int next_start) {
+        if (open) {
+            accumulator.add(process_id, start_time, has_end ? end_time : next_start);
+            open = false;
+        }
+    }
+
+public:
+    LodTraceSink(double from, double to, size_t buckets, size_t top_k) : accumulator(from, to, buckets, top_k) {}
+
+    // When a work-conserving schedule of processes ends, the default right edge of a view
+    static int scheduleEnd(const vector<Process>& processes) {
+        vector<pair<int, int>> jobs;
+        jobs.reserve(processes.size());
+        for (const auto& p : processes) {
+            jobs.emplace_back(p.arrival_time, max(p.burst_time, 0));
+        }
+        sort(jobs.begin(), jobs.end());
+        long long end = 0;
+        for (const auto& job : jobs) {
+            end = max<long long>(end, job.first) + job.second;
+        }
+        return static_cast<int>(min<long long>(end, INT_MAX));
+    }
+
+    template <typename Describe>
+    void beginSegment(int pid, int start, int queue_level, Describe&& describe) {
+        closeOpenRow(start);
+        process_id = pid;
+        start_time = start;
+        has_end = false;
+        open = true;
+    }
+
+    void endSegment(int end) {
+        if (open) {
+            end_time = end;
+            has_end = true;
+        }
+    }
+
+    void closeSegment(int end) {
+        if (open && !has_end) {
+            endSegment(end);
+        }
+    }
+
+    void completeProcess(const Process& p, int completion_time) {}
+
+    void completeProcess(const Process& p, int completion_time, const char* extra_name, int extra_value) {}
+
+    void finish() {
+        closeOpenRow(start_time);
+    }
+
+    double bucketWidth() const {
+        return accumulator.bucketWidth();
+    }
+
+    vector<LodBucket> buckets() {
+        return accumulator.finish();
+    }
+};
+
+// Buckets of a retained chart at every power-of-two resolution, built in one pass over its segments.
+// A view is reduced from the coarsest level at least FINENESS times finer than the requested
+// buckets: level buckets inside one view bucket are added whole, and the few that straddle a view
+// bucket edge are replaced by their segments, so the view equals the exact one. When no level is
+// that fine, or the view holds few segments, it is reduced from the segments alone. Level buckets
+// keep every process that ran in them; a view's top_k is chosen only when the view is reduced.
+class LodPyramid {
+public:
+    static constexpr size_t MAX_LEVEL = 16;
+    static constexpr double FINENESS = 4;
+    static constexpr size_t EXACT_SEGMENTS_PER_BUCKET = 32;
+
+private:
+    const GanttIndex& index;
+    double from;
+    double to;
+    // levels[k] has 2^k buckets over [from, to)
+    vector<vector<LodBucket>> levels;
+
+public:
+    explicit LodPyramid(const GanttIndex& gantt) : index(gantt), from(gantt.startTime()), to(gantt.endTime()) {
+        size_t finest = 0;
+        while (finest < MAX_LEVEL && (size_t(1) << (finest + 1)) <= max<size_t>(index.size(), 1) &&
+               (to - from) / (size_t(1) << (finest + 1)) >= 1) {
+            finest++;
+        }
+        vector<LodAccumulator> accumulators;
+        for (size_t k = 0; k <= finest; k++) {
+            accumulators.emplace_back(from, to, size_t(1) << k, SIZE_MAX);
+        }
+        for (const auto& segment : index.segmentList()) {
+            for (auto& accumulator : accumulators) {
+                accumulator.add(segment.process_id, segment.start_time, segment.end_time);
+            }
+        }
+        for (auto& accumulator : accumulators) {
+            levels.push_back(accumulator.finish());
+        }
+    }
+
+    vector<LodBucket> query(double view_from, double view_to, size_t count, size_t top_k) const {
+        LodAccumulator accumulator(view_from, view_to, count, top_k);
+        double wanted = accumulator.bucketWidth() / FINENESS;
+
+        size_t first, last;
+        tie(first, last) = index.overlapping(static_cast<int>(floor(view_from)), static_cast<int>(ceil(view_to)));
+        const vector<LodBucket>* level = nullptr;
+        for (const auto& candidate : levels) {
+            if ((to - from) / candidate.size() <= wanted) {
+                level = &candidate;
+                break;
+            }
+        }
+
+        if (level == nullptr || last - first <= EXACT_SEGMENTS_PER_BUCKET * count) {
+            const auto& segments = index.segmentList();
+            for (size_t i = first; i < last; i++) {
+                accumulator.add(segments[i].process_id, segments[i].start_time, segments[i].end_time);
+            }
+        } else {
+            double width = (to - from) / level->size();
+            size_t begin = static_cast<size_t>(max(0.0, floor((view_from - from) / width)));
+            size_t end = min(level->size(), static_cast<size_t>(max(0.0, ceil((view_to - from) / width))));
+            for (size_t i = begin; i < end; i++) {
+                const LodBucket& bucket = (*level)[i];
+                if (accumulator.withinOneBucket(bucket.start_time, bucket.end_time)) {
+                    accumulator.add(bucket);
+                } else {
+                    addSegments(accumulator, bucket.start_time, bucket.end_time);
+                }
+            }
+        }
+        return accumulator.finish();
+    }
+
+private:
+    // The segments' time within [lo, hi)
+    void addSegments(LodAccumulator& accumulator, double lo, double hi) const {
+        size_t first, last;
+        tie(first, last) = index.overlapping(static_cast<int>(floor(lo)), static_cast<int>(ceil(hi)));
+        const auto& segments = index.segmentList();
+        for (size_t i = first; i < last; i++) {
+            double start = max<double>(lo, segments[i].start_time);
+            double end = min<double>(hi, segments[i].end_time);
+            if (start < end) {
+                accumulator.add(segments[i].process_id, start, end);
+            }
+        }
+    }
+};
+
+#endif
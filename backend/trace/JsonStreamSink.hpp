@@ -0,0 +1,165 @@
+#ifndef JSON_STREAM_SINK_HPP
+#define JSON_STREAM_SINK_HPP
+#pragma once
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include "../json.hpp"
+#include "../Type.hpp"
+#include "JsonTraceSink.hpp"
+
+using namespace std;
+
+// Writes the schedule document as JSON text while the engine runs, handing it over in pieces of about
+// chunk_bytes. The text is the same as JsonTraceSink's document dumped with the extra top-level fields
+// (keys in json.hpp's sorted order). Gantt rows go out as soon as they are final; process_stats rows
+// follow the whole gantt_chart, so they are kept as encoded text until finish(). write returns false
+// once the reader is gone, which abandons the run with a runtime_error.
+class JsonStreamSink {
+public:
+    using Write = function<bool(const string&)>;
+
+private:
+    Write write;
+    size_t chunk_bytes;
+    map<string, string> fields;
+    string chunk;
+    string stats;
+    size_t gantt_rows = 0;
+    bool sent = false;
+    bool finished = false;
+
+    // The newest Gantt row stays a small DOM until the next row begins, since engines may still move its end
+    nlohmann::json open_row;
+    bool open = false;
+
+    void flush() {
+        if (chunk.empty()) {
+            return;
+        }
+        if (!write(chunk)) {
+            throw runtime_error("client disconnected");
+        }
+        sent = true;
+        chunk.clear();
+    }
+
+    void flushOpenRow() {
+        if (open) {
+            if (gantt_rows++ > 0) {
+                chunk += ',';
+            }
+            chunk += open_row.dump();
+            open = false;
+            if (chunk.size() >= chunk_bytes) {
+                flush();
+            }
+        }
+    }
+
+    // Members whose keys sort in [from, to), each followed by a comma; to == "" runs to the end
+    void writeFields(const string& from, const string& to) {
+        for (auto it = fields.lower_bound(from); it != fields.end() && (to.empty() || it->first < to); ++it) {
+            chunk += nlohmann::json(it->first).dump();
+            chunk += ':';
+            chunk += it->second;
+            chunk += ',';
+        }
+    }
+
+    void addStats(const nlohmann::json& row) {
+        if (!stats.empty()) {
+            stats += ',';
+        }
+        stats += row.dump();
+    }
+
+public:
+    JsonStreamSink(Write writer, size_t chunk_size, const nlohmann::json& extra_fields = nlohmann::json::object())
+        : write(std::move(writer)), chunk_bytes(chunk_size > 0 ? chunk_size : 1) {
+        for (auto it = extra_fields.begin(); it != extra_fields.end(); ++it) {
+            fields[it.key()] = it.value().dump();
+        }
+        fields.erase("gantt_chart");
+        fields.erase("process_stats");
+        chunk.reserve(chunk_bytes + 256);
+        chunk += '{';
+        writeFields("", "gantt_chart");
+        chunk += "\"gantt_chart\":[";
+    }
+
+    template <typename Time, typename Describe>
+    void beginSegment(int process_id, Time start_time, int queue_level, Describe&& describe) {
+        flushOpenRow();
+        open_row = nlohmann::json();
+        open_row["process_id"] = process_id;
+        open_row["start_time"] = start_time;
+        describe(open_row);
+        open = true;
+    }
+
+    template <typename Time>
+    void endSegment(Time end_time) {
+        if (open) {
+            open_row["end_time"] = end_time;
+        }
+    }
+
+    template <typename Time>
+    void closeSegment(Time end_time) {
+        if (open && !open_row.contains("end_time")) {
+            open_row["end_time"] = end_time;
+        }
+    }
+
+    template <typename Time>
+    void completeProcess(const BasicProcess<Time>& p, Time completion_time) {
+        addStats(JsonTraceSink::statsRow(p, completion_time));
+    }
+
+    template <typename Time, typename Extra>
+    void completeProcess(const BasicProcess<Time>& p, Time completion_time, const char* extra_name, Extra extra_value) {
+        nlohmann::json row = JsonTraceSink::statsRow(p, completion_time);
+        row[extra_name] = extra_value;
+        addStats(row);
+    }
+
+    void finish() {
+        if (finished) {
+            return;
+        }
+        finished = true;
+        flushOpenRow();
+        chunk += "],";
+        writeFields("gantt_chart", "process_stats");
+        chunk += "\"process_stats\":[";
+        flush();
+        for (size_t start = 0; start < stats.size(); start += chunk_bytes) {
+            chunk.assign(stats, start, chunk_bytes);
+            flush();
+        }
+        string().swap(stats);
+        chunk += "],";
+        writeFields("process_stats", "");
+        chunk.back() = '}';
+        flush();
+    }
+
+    // Adds a top-level field once the run is under way (e.g. a summary known only at the end); only
+    // keys that sort after process_stats can still be written when finish() is called
+    void setField(const string& key, const nlohmann::json& value) {
+        if (key <= "process_stats" || finished) {
+            throw invalid_argument("field " + key + " can no longer be added to the document");
+        }
+        fields[key] = value.dump();
+    }
+
+    // Whether any of the document has been handed to write yet
+    bool started() const {
+        return sent;
+    }
+};
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef JSON_TRACE_SINK_HPP
+#define JSON_TRACE_SINK_HPP
+#pragma once
+#include <vector>
+#include <utility>
+#include "../json.hpp"
+#include "../Type.hpp"
+
+using namespace std;
+
+// The scheduling engines report their schedule to a sink instead of building JSON themselves.
+// Every sink provides:
+//
+//   beginSegment(process_id, start_time, queue_level, describe)
+//       Opens a Gantt row. queue_level is -1 for idle rows and 0 in single-queue algorithms.
+//       describe(nlohmann::json& row) adds the algorithm's snapshot keys (ready_queue, queues,
+//       queue_level, ...); sinks that do not keep snapshots never call it, so its cost is skipped.
+//   endSegment(end_time)      Sets the end of the newest row; a later call overwrites it.
+//   closeSegment(end_time)    Sets the end of the newest row only if nothing has set it yet.
+//   completeProcess(process, completion_time [, extra_name, extra_value])
+//       Adds a process_stats row; extra is the algorithm specific column (queue, final_queue_level...).
+//   finish()                  Called once after the engine returns.
+//
+// Times are the engine's time type (Type.hpp). The sinks here that build documents take any of them;
+// the ones that index or compress a run (GanttLod, GanttIndex, ColumnarTrace) are over int.
+//
+// JsonTraceSink produces exactly the documents the engines have always returned.
+class JsonTraceSink {
+private:
+    vector<nlohmann::json> gantt_chart;
+    vector<nlohmann::json> process_stats;
+
+public:
+    template <typename Time>
+    static nlohmann::json statsRow(const BasicProcess<Time>& p, Time completion_time) {
+        Time turnaround_time = completion_time - p.arrival_time;
+        Time waiting_time = turnaround_time - p.burst_time;
+        return {
+            {"process_id", p.p_id},
+            {"arrival_time", p.arrival_time},
+            {"burst_time", p.burst_time},
+            {"priority", p.priority},
+            {"completion_time", completion_time},
+            {"turnaround_time", turnaround_time},
+            {"waiting_time", waiting_time}
+        };
+    }
+
+    template <typename Time, typename Describe>
+    void beginSegment(int process_id, Time start_time, int queue_level, Describe&& describe) {
+        nlohmann::json row;
+        row["process_id"] = process_id;
+        row["start_time"] = start_time;
+        describe(row);
+        gantt_chart.push_back(std::move(row));
+    }
+
+    template <typename Time>
+    void endSegment(Time end_time) {
+        if (!gantt_chart.empty()) {
+            gantt_chart.back()["end_time"] = end_time;
+        }
+    }
+
+    template <typename Time>
+    void closeSegment(Time end_time) {
+        if (!gantt_chart.empty() && !gantt_chart.back().contains("end_time")) {
+            gantt_chart.back()["end_time"] = end_time;
+        }
+    }
+
+    template <typename Time>
+    void completeProcess(const BasicProcess<Time>& p, Time completion_time) {
+        process_stats.push_back(statsRow(p, completion_time));
+    }
+
+    template <typename Time, typename Extra>
+    void completeProcess(const BasicProcess<Time>& p, Time completion_time, const char* extra_name, Extra extra_value) {
+        nlohmann::json row = statsRow(p, completion_time);
+        row[extra_name] = extra_value;
+        process_stats.push_back(std::move(row));
+    }
+
+    void finish() {}
+
+    nlohmann::json result() {
+        nlohmann::json result;
+        result["gantt_chart"] = std::move(gantt_chart);
+        result["process_stats"] = std::move(process_stats);
+        return result;
+    }
+};
+
+#endif
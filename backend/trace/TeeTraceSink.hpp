@@ -0,0 +1,57 @@
+#ifndef TEE_TRACE_SINK_HPP
+#define TEE_TRACE_SINK_HPP
+#pragma once
+#include <utility>
+#include "../json.hpp"
+#include "../Type.hpp"
+
+using namespace std;
+
+// Reports one run to two sinks. The second finishes first, so it can hand its results (e.g. a
+// ScheduleSummary) to the first before that one writes out its document.
+template <typename First, typename Second>
+class TeeTraceSink {
+private:
+    First& first;
+    Second& second;
+
+public:
+    TeeTraceSink(First& a, Second& b) : first(a), second(b) {}
+
+    template <typename Time, typename Describe>
+    void beginSegment(int process_id, Time start_time, int queue_level, Describe&& describe) {
+        first.beginSegment(process_id, start_time, queue_level, describe);
+        second.beginSegment(process_id, start_time, queue_level, describe);
+    }
+
+    template <typename Time>
+    void endSegment(Time end_time) {
+        first.endSegment(end_time);
+        second.endSegment(end_time);
+    }
+
+    template <typename Time>
+    void closeSegment(Time end_time) {
+        first.closeSegment(end_time);
+        second.closeSegment(end_time);
+    }
+
+    template <typename Time>
+    void completeProcess(const BasicProcess<Time>& p, Time completion_time) {
+        first.completeProcess(p, completion_time);
+        second.completeProcess(p, completion_time);
+    }
+
+    template <typename Time, typename Extra>
+    void completeProcess(const BasicProcess<Time>& p, Time completion_time, const char* extra_name, Extra extra_value) {
+        first.completeProcess(p, completion_time, extra_name, extra_value);
+        second.completeProcess(p, completion_time, extra_name, extra_value);
+    }
+
+    void finish() {
+        second.finish();
+        first.finish();
+    }
+};
+
+#endif
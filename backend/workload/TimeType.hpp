@@ -0,0 +1,130 @@
+#ifndef TIME_TYPE_HPP
+#define TIME_TYPE_HPP
+#pragma once
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "../json.hpp"
+#include "../Type.hpp"
+
+using namespace std;
+
+// The time types a workload can be simulated in: every engine, the WorkloadIndex and the document
+// sinks are instantiated for each of them.
+enum class TimeType { Int32, Int64, Double };
+
+// The span of a workload's times, from which the narrowest time type that simulates it exactly is
+// chosen: int32 while every time up to the latest possible completion (the last arrival plus all the
+// bursts) fits in an int, int64 past that, and double once any time has a fractional part.
+class TimeRange {
+private:
+    double first_arrival = 0;
+    double last_arrival = 0;
+    double burst_sum = 0;
+    bool fractional = false;
+    bool empty = true;
+
+public:
+    void add(double arrival_time, double burst_time) {
+        first_arrival = empty ? arrival_time : min(first_arrival, arrival_time);
+        last_arrival = empty ? arrival_time : max(last_arrival, arrival_time);
+        burst_sum += max(burst_time, 0.0);
+        fractional = fractional || arrival_time != trunc(arrival_time) || burst_time != trunc(burst_time);
+        empty = false;
+    }
+
+    template <typename Time>
+    void add(const vector<BasicProcess<Time>>& processes) {
+        for (const auto& p : processes) {
+            add(static_cast<double>(p.arrival_time), static_cast<double>(p.burst_time));
+        }
+    }
+
+    // Processes as they appear in a request body
+    void add(const nlohmann::json& processes) {
+        for (const auto& p : processes) {
+            add(p.at("arrival_time").get<double>(), p.at("burst_time").get<double>());
+        }
+    }
+
+    // A time seen elsewhere (e.g. by ProcessStream) had a fractional part
+    void markFractional() {
+        fractional = true;
+    }
+
+    bool isFractional() const {
+        return fractional;
+    }
+
+    bool fitsInt32() const {
+        return first_arrival >= INT_MIN && last_arrival + burst_sum <= INT_MAX;
+    }
+
+    TimeType narrowest() const {
+        if (fractional) {
+            return TimeType::Double;
+        }
+        return fitsInt32() ? TimeType::Int32 : TimeType::Int64;
+    }
+};
+
+class TimeTypes {
+public:
+    static const char* name(TimeType type) {
+        switch (type) {
+            case TimeType::Int64: return "int64";
+            case TimeType::Double: return "double";
+            default: return "int32";
+        }
+    }
+
+    // The type "time_type" asks for ("int32", "int64" or "double"), or the narrowest for range when
+    // it is absent or "auto". Integer types truncate fractional times; a type too narrow for the
+    // workload throws invalid_argument.
+    static TimeType select(const nlohmann::json& config, const TimeRange& range) {
+        string name = config.value("time_type", string("auto"));
+        if (name == "auto") {
+            return range.narrowest();
+        }
+        if (name == "int64") {
+            return TimeType::Int64;
+        }
+        if (name == "double") {
+            return TimeType::Double;
+        }
+        if (name == "int32") {
+            if (!range.fitsInt32()) {
+                throw invalid_argument("time_type int32 cannot hold the workload's times; use int64 or double");
+            }
+            return TimeType::Int32;
+        }
+        throw invalid_argument("Unknown time_type: " + name + " (expected auto, int32, int64 or double)");
+    }
+
+    // Calls f with a zero of the C++ type for type, so that f can be a generic lambda over it:
+    // visit(type, [&](auto zero) { using Time = decltype(zero); ... })
+    template <typename F>
+    static decltype(auto) visit(TimeType type, F&& f) {
+        switch (type) {
+            case TimeType::Int64: return f(0LL);
+            case TimeType::Double: return f(0.0);
+            default: return f(0);
+        }
+    }
+
+    // Processes read in one time type, in another
+    template <typename To, typename From>
+    static vector<BasicProcess<To>> convert(const vector<BasicProcess<From>>& processes) {
+        vector<BasicProcess<To>> converted;
+        converted.reserve(processes.size());
+        for (const auto& p : processes) {
+            converted.push_back({p.p_id, static_cast<To>(p.arrival_time), static_cast<To>(p.burst_time), p.priority});
+        }
+        return converted;
+    }
+};
+
+#endif
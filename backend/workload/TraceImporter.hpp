@@ -0,0 +1,425 @@
+#ifndef TRACE_IMPORTER_HPP
+#define TRACE_IMPORTER_HPP
+#pragma once
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdexcept>
+#include "../MappedFile.hpp"
+#include "../Type.hpp"
+
+using namespace std;
+
+struct TraceImportOptions {
+    string format;                   // swf | csv; empty picks by file extension
+    double time_scale = 1.0;         // trace time units (seconds) -> simulation time units
+    bool rebase = true;              // shift arrivals so the earliest kept job arrives at 0
+    string priority_field = "queue"; // swf: queue | partition | user | group | none
+    vector<long long> statuses;      // swf: keep only these status codes (empty keeps all)
+    vector<long long> priorities;    // keep only jobs whose mapped priority is listed (empty keeps all)
+    double submit_from = -numeric_limits<double>::infinity();
+    double submit_to = numeric_limits<double>::infinity();
+    double min_runtime = 0.0;        // jobs must run strictly longer than this (drops -1 "unknown")
+    double max_runtime = numeric_limits<double>::infinity();
+    long long limit = 0;             // keep at most this many jobs, in file order (0 keeps all)
+    int threads = 0;                 // 0 uses every hardware thread
+
+    // csv: column names; empty picks a common spelling from the header
+    char delimiter = ',';
+    string id_column;
+    string submit_column;
+    string runtime_column;
+    string priority_column;
+};
+
+// Streaming importers for Standard Workload Format logs and cluster CSV exports.
+// The file is mapped once and split at line boundaries into one chunk per thread; each chunk is
+// parsed in a single pass and the chunks are concatenated in file order, so the output does not
+// depend on the thread count. Quoted CSV fields must not contain line breaks.
+class TraceImporter {
+private:
+    // A kept job before rebasing; arrival is already scaled but may not fit an int yet
+    struct Record {
+        long long id;
+        long long arrival;
+        int burst;
+        int priority;
+    };
+
+    struct CsvColumns {
+        int id = -1;
+        int submit = -1;
+        int runtime = -1;
+        int priority = -1;
+    };
+
+    [[noreturn]] static void fail(const MappedFile& file, const char* at, const string& message) {
+        throw runtime_error("Trace parse error at byte " + to_string(at - file.data()) + ": " + message);
+    }
+
+    // Plain decimal number ("-1", "42", "3.25", "1e3"); returns false if the token is not numeric
+    static bool parseNumber(const char* begin, const char* end, double& out) {
+        const char* p = begin;
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negative = *p == '-';
+            p++;
+        }
+        double value = 0;
+        bool digits = false;
+        while (p < end && isdigit(static_cast<unsigned char>(*p))) {
+            value = value * 10 + (*p++ - '0');
+            digits = true;
+        }
+        if (p < end && *p == '.') {
+            double scale = 0.1;
+            for (p++; p < end && isdigit(static_cast<unsigned char>(*p)); p++, scale /= 10) {
+                value += (*p - '0') * scale;
+                digits = true;
+            }
+        }
+        if (digits && p < end && (*p == 'e' || *p == 'E')) {
+            p++;
+            bool negative_exponent = p < end && *p == '-';
+            if (p < end && (*p == '-' || *p == '+')) {
+                p++;
+            }
+            int exponent = 0;
+            while (p < end && isdigit(static_cast<unsigned char>(*p))) {
+                exponent = exponent * 10 + (*p++ - '0');
+            }
+            value *= pow(10.0, negative_exponent ? -exponent : exponent);
+        }
+        out = negative ? -value : value;
+        return digits && p == end;
+    }
+
+    static bool keep(const TraceImportOptions& options, double submit, double runtime, long long priority) {
+        if (submit < options.submit_from || submit > options.submit_to) {
+            return false;
+        }
+        if (!(runtime > options.min_runtime) || runtime > options.max_runtime) {
+            return false;
+        }
+        if (!options.priorities.empty() &&
+            find(options.priorities.begin(), options.priorities.end(), priority) == options.priorities.end()) {
+            return false;
+        }
+        return true;
+    }
+
+    // Whether a trace id can be used as the p_id
+    static bool validId(long long id) {
+        return id >= 0 && id <= INT_MAX;
+    }
+
+    static Record makeRecord(const TraceImportOptions& options, long long id, double submit, double runtime, long long priority) {
+        double burst = max(1.0, round(runtime * options.time_scale));
+        if (burst > INT_MAX || priority > INT_MAX || priority < INT_MIN) {
+            throw overflow_error("Job " + to_string(id) + " does not fit the int fields of Process; lower --time-scale");
+        }
+        return {id, llround(floor(submit * options.time_scale)), static_cast<int>(burst), static_cast<int>(priority)};
+    }
+
+    // SWF: 18 whitespace separated fields per job, ';' starts a header comment
+    static void parseSwfChunk(const MappedFile& file, const char* p, const char* end,
+                              const TraceImportOptions& options, vector<Record>& out) {
+        int priority_index = options.priority_field == "queue" ? 14 :
+                             options.priority_field == "partition" ? 15 :
+                             options.priority_field == "user" ? 11 :
+                             options.priority_field == "group" ? 12 : -1;
+        double fields[18];
+
+        while (p < end) {
+            const char* line_end = static_cast<const char*>(memchr(p, '\n', static_cast<size_t>(end - p)));
+            if (line_end == nullptr) {
+                line_end = end;
+            }
+
+            int count = 0;
+            const char* q = p;
+            while (q < line_end && *q != ';') {
+                while (q < line_end && isspace(static_cast<unsigned char>(*q))) {
+                    q++;
+                }
+                if (q >= line_end || *q == ';') {
+                    break;
+                }
+                const char* token = q;
+                while (q < line_end && !isspace(static_cast<unsigned char>(*q))) {
+                    q++;
+                }
+                if (count < 18) {
+                    if (!parseNumber(token, q, fields[count])) {
+                        fail(file, token, "non-numeric SWF field");
+                    }
+                }
+                count++;
+            }
+
+            if (count > 0) {
+                if (count < 4) {
+                    fail(file, p, "SWF line has fewer than 4 fields");
+                }
+                long long status = count > 10 ? static_cast<long long>(fields[10]) : -1;
+                long long priority = priority_index >= 0 && priority_index < count ? static_cast<long long>(fields[priority_index]) : 0;
+                priority = max(priority, 0LL);
+
+                bool status_ok = options.statuses.empty() ||
+                                 find(options.statuses.begin(), options.statuses.end(), status) != options.statuses.end();
+                if (status_ok && keep(options, fields[1], fields[3], priority)) {
+                    out.push_back(makeRecord(options, static_cast<long long>(fields[0]), fields[1], fields[3], priority));
+                }
+            }
+            p = line_end + 1;
+        }
+    }
+
+    // Splits one CSV line into fields, stripping quotes; returns the number of fields
+    static size_t splitCsv(const char* p, const char* end, char delimiter, vector<pair<const char*, const char*>>& fields) {
+        fields.clear();
+        while (true) {
+            const char* start = p;
+            const char* stop;
+            if (p < end && *p == '"') {
+                start = ++p;
+                while (p < end && !(*p == '"' && (p + 1 >= end || p[1] != '"'))) {
+                    p += (*p == '"') ? 2 : 1;
+                }
+                stop = p;
+                while (p < end && *p != delimiter) {
+                    p++;
+                }
+            } else {
+                while (p < end && *p != delimiter) {
+                    p++;
+                }
+                stop = p;
+            }
+            while (start < stop && isspace(static_cast<unsigned char>(*start))) {
+                start++;
+            }
+            while (stop > start && isspace(static_cast<unsigned char>(stop[-1]))) {
+                stop--;
+            }
+            fields.emplace_back(start, stop);
+            if (p >= end) {
+                break;
+            }
+            p++;
+        }
+        return fields.size();
+    }
+
+    static CsvColumns csvColumns(const char* p, const char* end, const TraceImportOptions& options) {
+        vector<pair<const char*, const char*>> fields;
+        splitCsv(p, end, options.delimiter, fields);
+
+        vector<string> names;
+        for (const auto& field : fields) {
+            string name(field.first, field.second);
+            transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+            names.push_back(name);
+        }
+
+        auto find_column = [&](const string& chosen, const vector<string>& guesses) {
+            vector<string> candidates = chosen.empty() ? guesses : vector<string>{chosen};
+            for (const auto& candidate : candidates) {
+                string wanted = candidate;
+                transform(wanted.begin(), wanted.end(), wanted.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+                auto it = find(names.begin(), names.end(), wanted);
+                if (it != names.end()) {
+                    return static_cast<int>(it - names.begin());
+                }
+            }
+            if (!chosen.empty()) {
+                throw runtime_error("CSV column not found: " + chosen);
+            }
+            return -1;
+        };
+
+        CsvColumns columns;
+        columns.id = find_column(options.id_column, {"job_id", "jobid", "id", "job"});
+        columns.submit = find_column(options.submit_column, {"submit_time", "submit", "arrival_time", "arrival", "queued_time", "timestamp"});
+        columns.runtime = find_column(options.runtime_column, {"run_time", "runtime", "duration", "burst_time", "elapsed"});
+        columns.priority = find_column(options.priority_column, {"priority", "queue", "qos", "partition"});
+
+        if (columns.submit < 0 || columns.runtime < 0) {
+            throw runtime_error("CSV header needs a submit time and a run time column");
+        }
+        return columns;
+    }
+
+    static void parseCsvChunk(const MappedFile& file, const char* p, const char* end, const CsvColumns& columns,
+                              const TraceImportOptions& options, vector<Record>& out) {
+        vector<pair<const char*, const char*>> fields;
+        auto number = [&](int column, double fallback) {
+            if (column < 0 || static_cast<size_t>(column) >= fields.size() || fields[column].first == fields[column].second) {
+                return fallback;
+            }
+            double value;
+            if (!parseNumber(fields[column].first, fields[column].second, value)) {
+                fail(file, fields[column].first, "non-numeric CSV value");
+            }
+            return value;
+        };
+
+        while (p < end) {
+            const char* line_end = static_cast<const char*>(memchr(p, '\n', static_cast<size_t>(end - p)));
+            if (line_end == nullptr) {
+                line_end = end;
+            }
+            const char* content_end = (line_end > p && line_end[-1] == '\r') ? line_end - 1 : line_end;
+
+            if (content_end > p) {
+                splitCsv(p, content_end, options.delimiter, fields);
+                double submit = number(columns.submit, numeric_limits<double>::quiet_NaN());
+                double runtime = number(columns.runtime, -1);
+                long long priority = max(0LL, static_cast<long long>(number(columns.priority, 0)));
+                long long id = static_cast<long long>(number(columns.id, -1));
+
+                if (submit == submit && keep(options, submit, runtime, priority)) {
+                    out.push_back(makeRecord(options, id, submit, runtime, priority));
+                }
+            }
+            p = line_end + 1;
+        }
+    }
+
+    static string formatOf(const string& path, const TraceImportOptions& options) {
+        if (!options.format.empty()) {
+            return options.format;
+        }
+        string lower = path;
+        transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+        if (lower.size() >= 4 && lower.compare(lower.size() - 4, 4, ".csv") == 0) {
+            return "csv";
+        }
+        return "swf";
+    }
+
+public:
+    static bool isTraceFile(const string& path) {
+        string lower = path;
+        transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+        auto ends_with = [&](const string& suffix) {
+            return lower.size() >= suffix.size() && lower.compare(lower.size() - suffix.size(), suffix.size(), suffix) == 0;
+        };
+        return ends_with(".swf") || ends_with(".csv");
+    }
+
+    static vector<Process> import(const string& path, const TraceImportOptions& options = {}) {
+        string format = formatOf(path, options);
+        if (format != "swf" && format != "csv") {
+            throw invalid_argument("Unknown trace format: " + format);
+        }
+        if (!(options.time_scale > 0)) {
+            throw invalid_argument("time_scale must be positive");
+        }
+
+        MappedFile file(path);
+        const char* begin = file.data();
+        const char* end = begin + file.size();
+
+        CsvColumns columns;
+        if (format == "csv" && begin < end) {
+            const char* header_end = static_cast<const char*>(memchr(begin, '\n', file.size()));
+            header_end = header_end == nullptr ? end : header_end;
+            columns = csvColumns(begin, (header_end > begin && header_end[-1] == '\r') ? header_end - 1 : header_end, options);
+            begin = min(header_end + 1, end);
+        }
+
+        // Chunk boundaries are moved forward to the next line start
+        size_t threads = options.threads > 0 ? options.threads : max(1u, thread::hardware_concurrency());
+        size_t span = static_cast<size_t>(end - begin);
+        threads = max<size_t>(1, min(threads, span / (1 << 20) + 1));
+        vector<const char*> bounds = {begin};
+        for (size_t i = 1; i < threads; i++) {
+            const char* cut = begin + span * i / threads;
+            cut = max(cut, bounds.back());
+            const char* newline = static_cast<const char*>(memchr(cut, '\n', static_cast<size_t>(end - cut)));
+            bounds.push_back(newline == nullptr ? end : newline + 1);
+        }
+        bounds.push_back(end);
+
+        vector<vector<Record>> chunks(threads);
+        vector<string> errors(threads);
+        vector<thread> workers;
+        for (size_t i = 0; i < threads; i++) {
+            workers.emplace_back([&, i]() {
+                try {
+                    if (format == "swf") {
+                        parseSwfChunk(file, bounds[i], bounds[i + 1], options, chunks[i]);
+                    } else {
+                        parseCsvChunk(file, bounds[i], bounds[i + 1], columns, options, chunks[i]);
+                    }
+                } catch (const exception& e) {
+                    errors[i] = e.what();
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        for (const auto& error : errors) {
+            if (!error.empty()) {
+                throw runtime_error(error);
+            }
+        }
+
+        size_t total = 0;
+        for (const auto& chunk : chunks) {
+            total += chunk.size();
+        }
+        if (options.limit > 0) {
+            total = min(total, static_cast<size_t>(options.limit));
+        }
+
+        // Records whose id does not fit a p_id are numbered on from the largest id that does, so
+        // they cannot take the id of another record
+        long long origin = options.rebase ? LLONG_MAX : 0;
+        long long next_id = 0;
+        size_t seen = 0;
+        for (const auto& chunk : chunks) {
+            for (size_t i = 0; i < chunk.size() && seen < total; i++, seen++) {
+                if (options.rebase) {
+                    origin = min(origin, chunk[i].arrival);
+                }
+                if (validId(chunk[i].id)) {
+                    next_id = max(next_id, chunk[i].id + 1);
+                }
+            }
+        }
+
+        vector<Process> processes;
+        processes.reserve(total);
+        for (auto& chunk : chunks) {
+            for (size_t i = 0; i < chunk.size() && processes.size() < total; i++) {
+                const Record& r = chunk[i];
+                long long arrival = r.arrival - origin;
+                if (arrival < INT_MIN || arrival > INT_MAX) {
+                    throw overflow_error("Arrival time of job " + to_string(r.id) + " does not fit an int; lower --time-scale");
+                }
+                Process p;
+                if (!validId(r.id) && next_id > INT_MAX) {
+                    throw overflow_error("No p_id left for job " + to_string(r.id) + " above the trace's largest id");
+                }
+                p.p_id = static_cast<int>(validId(r.id) ? r.id : next_id++);
+                p.arrival_time = static_cast<int>(arrival);
+                p.burst_time = r.burst;
+                p.priority = r.priority;
+                processes.push_back(p);
+            }
+            vector<Record>().swap(chunk);
+        }
+        return processes;
+    }
+};
+
+#endif
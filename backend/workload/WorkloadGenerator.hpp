@@ -0,0 +1,272 @@
+#ifndef WORKLOAD_GENERATOR_HPP
+#define WORKLOAD_GENERATOR_HPP
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <climits>
+#include <random>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include "../json.hpp"
+#include "../Type.hpp"
+
+using namespace std;
+
+// Parameters of a synthetic workload. Every field has a default so a config can be partially specified.
+struct WorkloadConfig {
+    uint64_t seed = 1;
+    long long count = 100;
+    int first_pid = 1;
+    int start_time = 0;
+
+    // Arrival process: poisson | uniform | fixed | bursty
+    string arrival = "poisson";
+    double arrival_rate = 0.5;      // mean arrivals per time unit
+    double cluster_size = 8.0;      // bursty: mean number of jobs per cluster
+    double cluster_speedup = 10.0;  // bursty: arrival rate multiplier inside a cluster
+
+    // Burst time distribution: fixed | uniform | exponential | lognormal | pareto | bimodal
+    string burst = "exponential";
+    double burst_mean = 8.0;
+    double burst_sigma = 1.0;       // lognormal shape
+    double burst_alpha = 1.5;       // pareto shape, must be > 1
+    double long_job_fraction = 0.1; // bimodal: share of long jobs
+    double long_job_mean = 80.0;    // bimodal: mean burst of long jobs
+    int burst_min = 1;
+    int burst_max = 1000;
+
+    // Priority distribution over [0, priority_levels): fixed | uniform | zipf
+    string priority = "uniform";
+    int priority_levels = 5;
+    double zipf_s = 1.0;
+
+    // Rank correlation between burst time and priority number in [-1, 1] (Gaussian copula)
+    double correlation = 0.0;
+};
+
+// Deterministic, constant-memory generator of Process records.
+// Arrivals, bursts and priorities are drawn from independent streams derived from the seed,
+// so changing e.g. the burst distribution leaves the arrival times unchanged.
+class WorkloadGenerator {
+private:
+    WorkloadConfig config;
+    mt19937_64 arrival_rng;
+    mt19937_64 burst_rng;
+    mt19937_64 priority_rng;
+    long long produced = 0;
+    double clock = 0.0;
+    double long_job_share = 0.0;
+    vector<double> priority_cdf;
+
+    static uint64_t splitmix64(uint64_t& state) {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    // Uniform in [0, 1) built from the top 53 bits so results do not depend on the standard library
+    static double uniform(mt19937_64& rng) {
+        return static_cast<double>(rng() >> 11) * 0x1.0p-53;
+    }
+
+    static double standardNormal(mt19937_64& rng) {
+        const double pi = 3.14159265358979323846;
+        double u1 = 1.0 - uniform(rng);
+        double u2 = uniform(rng);
+        return sqrt(-2.0 * log(u1)) * cos(2.0 * pi * u2);
+    }
+
+    static double normalCdf(double z) {
+        return 0.5 * erfc(-z / sqrt(2.0));
+    }
+
+    double nextInterArrival() {
+        double u = uniform(arrival_rng);
+        double rate = config.arrival_rate;
+
+        if (config.arrival == "fixed") {
+            return 1.0 / rate;
+        } else if (config.arrival == "uniform") {
+            return 2.0 * u / rate;
+        } else if (config.arrival == "bursty") {
+            // A new cluster starts with probability 1/cluster_size, otherwise the job joins the current one
+            if (uniform(arrival_rng) * config.cluster_size >= 1.0) {
+                rate *= config.cluster_speedup;
+            }
+        }
+        return -log(1.0 - u) / rate;
+    }
+
+    // Inverse CDF of the burst distribution; z is the normal variate behind u
+    double burstQuantile(double u, double z) const {
+        const string& kind = config.burst;
+        if (kind == "fixed") {
+            return config.burst_mean;
+        } else if (kind == "uniform") {
+            return floor(config.burst_min + u * (config.burst_max - config.burst_min + 1));
+        } else if (kind == "lognormal") {
+            double mu = log(config.burst_mean) - config.burst_sigma * config.burst_sigma / 2.0;
+            return exp(mu + config.burst_sigma * z);
+        } else if (kind == "pareto") {
+            double scale = config.burst_mean * (config.burst_alpha - 1.0) / config.burst_alpha;
+            return scale / pow(1.0 - u, 1.0 / config.burst_alpha);
+        } else if (kind == "bimodal") {
+            // Lower quantiles map to short jobs, upper quantiles to long ones, so correlation is preserved
+            double short_share = 1.0 - long_job_share;
+            if (u < short_share) {
+                return -config.burst_mean * log(1.0 - u / short_share);
+            }
+            return -config.long_job_mean * log(1.0 - (u - short_share) / long_job_share);
+        }
+        return -config.burst_mean * log(1.0 - u);
+    }
+
+    int priorityQuantile(double u) const {
+        if (config.priority == "fixed") {
+            return 0;
+        }
+        if (config.priority == "zipf") {
+            for (int level = 0; level < config.priority_levels; level++) {
+                if (u < priority_cdf[level]) {
+                    return level;
+                }
+            }
+            return config.priority_levels - 1;
+        }
+        return min(static_cast<int>(u * config.priority_levels), config.priority_levels - 1);
+    }
+
+    void validate() const {
+        static const vector<string> arrivals = {"poisson", "uniform", "fixed", "bursty"};
+        static const vector<string> bursts = {"fixed", "uniform", "exponential", "lognormal", "pareto", "bimodal"};
+        static const vector<string> priorities = {"fixed", "uniform", "zipf"};
+
+        if (find(arrivals.begin(), arrivals.end(), config.arrival) == arrivals.end()) {
+            throw invalid_argument("Unknown arrival process: " + config.arrival);
+        }
+        if (find(bursts.begin(), bursts.end(), config.burst) == bursts.end()) {
+            throw invalid_argument("Unknown burst distribution: " + config.burst);
+        }
+        if (find(priorities.begin(), priorities.end(), config.priority) == priorities.end()) {
+            throw invalid_argument("Unknown priority distribution: " + config.priority);
+        }
+        if (config.count < 0 || config.first_pid < 0 ||
+            config.count > static_cast<long long>(INT_MAX) - config.first_pid + 1) {
+            throw invalid_argument("Process count does not fit the p_id range");
+        }
+        if (!(config.arrival_rate > 0.0) || !(config.burst_mean > 0.0) || !(config.cluster_speedup > 0.0) ||
+            config.cluster_size < 1.0) {
+            throw invalid_argument("arrival_rate, burst_mean and cluster_speedup must be positive, cluster_size at least 1");
+        }
+        if (config.burst_min < 1 || config.burst_max < config.burst_min) {
+            throw invalid_argument("Burst range must satisfy 1 <= burst_min <= burst_max");
+        }
+        if (config.burst == "pareto" && !(config.burst_alpha > 1.0)) {
+            throw invalid_argument("Pareto burst_alpha must be greater than 1");
+        }
+        if (config.priority_levels < 1) {
+            throw invalid_argument("priority_levels must be at least 1");
+        }
+        if (config.correlation < -1.0 || config.correlation > 1.0) {
+            throw invalid_argument("correlation must lie in [-1, 1]");
+        }
+    }
+
+public:
+    explicit WorkloadGenerator(const WorkloadConfig& cfg) : config(cfg) {
+        validate();
+
+        long_job_share = min(max(config.long_job_fraction, 1e-9), 1.0 - 1e-9);
+        if (config.priority == "zipf") {
+            double total = 0.0;
+            for (int level = 0; level < config.priority_levels; level++) {
+                total += 1.0 / pow(level + 1, config.zipf_s);
+                priority_cdf.push_back(total);
+            }
+            for (double& c : priority_cdf) {
+                c /= total;
+            }
+        }
+        reset();
+    }
+
+    // Rewind to the first process; the same sequence is produced again
+    void reset() {
+        uint64_t state = config.seed;
+        arrival_rng.seed(splitmix64(state));
+        burst_rng.seed(splitmix64(state));
+        priority_rng.seed(splitmix64(state));
+        produced = 0;
+        clock = config.start_time;
+    }
+
+    bool next(Process& p) {
+        if (produced >= config.count) {
+            return false;
+        }
+        if (produced > 0) {
+            clock += nextInterArrival();
+        }
+        if (clock >= static_cast<double>(INT_MAX)) {
+            throw overflow_error("Generated arrival time exceeds the int range of Process");
+        }
+
+        double z_burst = standardNormal(burst_rng);
+        double z_priority = config.correlation * z_burst +
+                            sqrt(1.0 - config.correlation * config.correlation) * standardNormal(priority_rng);
+
+        double burst = burstQuantile(normalCdf(z_burst), z_burst);
+        burst = min(max(round(burst), static_cast<double>(config.burst_min)), static_cast<double>(config.burst_max));
+
+        p.p_id = config.first_pid + static_cast<int>(produced);
+        p.arrival_time = static_cast<int>(clock);
+        p.burst_time = static_cast<int>(burst);
+        p.priority = priorityQuantile(normalCdf(z_priority));
+        produced++;
+        return true;
+    }
+
+    long long remaining() const {
+        return config.count - produced;
+    }
+
+    vector<Process> generateAll() {
+        vector<Process> processes;
+        processes.reserve(static_cast<size_t>(remaining()));
+        Process p;
+        while (next(p)) {
+            processes.push_back(p);
+        }
+        return processes;
+    }
+
+    static WorkloadConfig configFromJson(const nlohmann::json& j) {
+        WorkloadConfig c;
+        c.seed = j.value("seed", c.seed);
+        c.count = j.value("count", c.count);
+        c.first_pid = j.value("first_pid", c.first_pid);
+        c.start_time = j.value("start_time", c.start_time);
+        c.arrival = j.value("arrival", c.arrival);
+        c.arrival_rate = j.value("arrival_rate", c.arrival_rate);
+        c.cluster_size = j.value("cluster_size", c.cluster_size);
+        c.cluster_speedup = j.value("cluster_speedup", c.cluster_speedup);
+        c.burst = j.value("burst", c.burst);
+        c.burst_mean = j.value("burst_mean", c.burst_mean);
+        c.burst_sigma = j.value("burst_sigma", c.burst_sigma);
+        c.burst_alpha = j.value("burst_alpha", c.burst_alpha);
+        c.long_job_fraction = j.value("long_job_fraction", c.long_job_fraction);
+        c.long_job_mean = j.value("long_job_mean", c.long_job_mean);
+        c.burst_min = j.value("burst_min", c.burst_min);
+        c.burst_max = j.value("burst_max", c.burst_max);
+        c.priority = j.value("priority", c.priority);
+        c.priority_levels = j.value("priority_levels", c.priority_levels);
+        c.zipf_s = j.value("zipf_s", c.zipf_s);
+        c.correlation = j.value("correlation", c.correlation);
+        return c;
+    }
+};
+
+#endif
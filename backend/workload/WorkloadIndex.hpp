@@ -0,0 +1,157 @@
+#ifndef WORKLOAD_INDEX_HPP
+#define WORKLOAD_INDEX_HPP
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "../Type.hpp"
+
+using namespace std;
+
+// A workload sorted by arrival time once, to be shared by every engine that schedules it. Built
+// from the processes of a request, it is immutable and handed around as shared_ptr<const
+// WorkloadIndex>, so the same index serves every algorithm and parameter set it is run with.
+//
+// The sort is a stable LSD radix sort on arrival_time: processes that arrive together keep the
+// order they were given in. Besides the sorted processes, which the engines read row by row, the
+// index keeps the arrival times as their own column, searched for the processes that have arrived
+// by a time, and a p_id -> position table.
+//
+// Time is the processes' time type (Type.hpp); WorkloadIndex is the one over int.
+template <typename Time>
+class BasicWorkloadIndex {
+public:
+    using Process = BasicProcess<Time>;
+
+private:
+    // Unsigned radix keys ordered as the times are
+    using Key = conditional_t<sizeof(Time) <= 4, uint32_t, uint64_t>;
+
+    vector<Process> processes;
+    vector<Time> arrival_times;
+    // First sorted position of each p_id
+    unordered_map<int, size_t> positions;
+
+    static Key radixKey(Time time) {
+        constexpr Key sign = Key(1) << (sizeof(Key) * 8 - 1);
+        if constexpr (is_floating_point_v<Time>) {
+            // IEEE order: negative values reversed below the positive ones; -0 is 0
+            double value = time == 0 ? 0.0 : static_cast<double>(time);
+            Key bits;
+            memcpy(&bits, &value, sizeof(bits));
+            return (bits & sign) ? ~bits : bits | sign;
+        } else {
+            // Flipping the sign bit orders negative arrivals first as unsigned keys
+            return static_cast<Key>(time) ^ sign;
+        }
+    }
+
+    // Positions of input sorted by arrival time, ties in input order
+    template <typename Record>
+    static vector<uint32_t> radixOrder(const Record* input, size_t n) {
+        vector<Key> keys(n);
+        for (size_t i = 0; i < n; i++) {
+            keys[i] = radixKey(static_cast<Time>(input[i].arrival_time));
+        }
+        vector<uint32_t> order(n);
+        for (size_t i = 0; i < n; i++) {
+            order[i] = static_cast<uint32_t>(i);
+        }
+        vector<uint32_t> scratch(n);
+        for (int shift = 0; shift < static_cast<int>(sizeof(Key) * 8); shift += 8) {
+            size_t counts[257] = {0};
+            for (size_t i = 0; i < n; i++) {
+                counts[((keys[i] >> shift) & 0xff) + 1]++;
+            }
+            // A digit every key shares leaves the order as it is
+            if (n == 0 || counts[((keys[0] >> shift) & 0xff) + 1] == n) {
+                continue;
+            }
+            for (int d = 0; d < 256; d++) {
+                counts[d + 1] += counts[d];
+            }
+            for (size_t i = 0; i < n; i++) {
+                uint32_t position = order[i];
+                scratch[counts[(keys[position] >> shift) & 0xff]++] = position;
+            }
+            order.swap(scratch);
+        }
+        return order;
+    }
+
+public:
+    explicit BasicWorkloadIndex(const vector<Process>& input) : BasicWorkloadIndex(input.data(), input.size()) {}
+
+    // From n records of any struct with p_id, arrival_time, burst_time and priority fields (such
+    // as capi/cpusched.h's cpusched_process), read where they are without a vector<Process> first
+    template <typename Record>
+    BasicWorkloadIndex(const Record* input, size_t n) {
+        vector<uint32_t> order = radixOrder(input, n);
+        processes.reserve(n);
+        arrival_times.reserve(n);
+        positions.reserve(n);
+        for (size_t i = 0; i < n; i++) {
+            const Record& record = input[order[i]];
+            Process p{record.p_id, static_cast<Time>(record.arrival_time), static_cast<Time>(record.burst_time),
+                      record.priority};
+            processes.push_back(p);
+            arrival_times.push_back(p.arrival_time);
+            positions.emplace(p.p_id, i);
+        }
+    }
+
+    static shared_ptr<const BasicWorkloadIndex> build(const vector<Process>& input) {
+        return make_shared<const BasicWorkloadIndex>(input);
+    }
+
+    size_t size() const {
+        return processes.size();
+    }
+
+    bool empty() const {
+        return processes.empty();
+    }
+
+    // The processes in arrival order
+    const vector<Process>& sorted() const {
+        return processes;
+    }
+
+    const Process& operator[](size_t i) const {
+        return processes[i];
+    }
+
+    // Sorted position of the first process with p_id, or -1
+    long find(int p_id) const {
+        auto it = positions.find(p_id);
+        return it == positions.end() ? -1 : static_cast<long>(it->second);
+    }
+
+    // How many processes have arrived by time (arrival_time <= time)
+    size_t arrivedBy(Time time) const {
+        return upper_bound(arrival_times.begin(), arrival_times.end(), time) - arrival_times.begin();
+    }
+
+    // Sorted positions [first, last) of the processes arriving exactly at time
+    pair<size_t, size_t> arrivingAt(Time time) const {
+        auto range = equal_range(arrival_times.begin(), arrival_times.end(), time);
+        return {static_cast<size_t>(range.first - arrival_times.begin()),
+                static_cast<size_t>(range.second - arrival_times.begin())};
+    }
+
+    // limit, or the time from time to the next arrival if that is sooner. The engines that run a
+    // unit at a time step by this, so a fractional arrival is not stepped over.
+    Time stepFrom(Time time, Time limit) const {
+        size_t arrived = arrivedBy(time);
+        return arrived < arrival_times.size() ? min(limit, arrival_times[arrived] - time) : limit;
+    }
+};
+
+using WorkloadIndex = BasicWorkloadIndex<int>;
+
+#endif
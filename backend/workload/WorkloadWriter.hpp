@@ -0,0 +1,75 @@
+#ifndef WORKLOAD_WRITER_HPP
+#define WORKLOAD_WRITER_HPP
+#pragma once
+#include <charconv>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "../json.hpp"
+#include "../Type.hpp"
+
+using namespace std;
+
+// Writes io/*.json style workload documents without building a DOM
+class WorkloadWriter {
+public:
+    // Streams every process from source (anything with bool next(Process&)).
+    // header holds the top-level fields (scheduling_type, quantum, ...) written before "processes".
+    template <typename Source>
+    static void writeJson(ostream& out, Source& source, const nlohmann::json& header) {
+        string buffer = "{\n";
+        for (auto it = header.begin(); it != header.end(); ++it) {
+            buffer += "  " + nlohmann::json(it.key()).dump() + ": " + it.value().dump() + ",\n";
+        }
+        buffer += "  \"processes\": [";
+
+        char digits[16];
+        auto append = [&](int value) {
+            auto res = to_chars(digits, digits + sizeof(digits), value);
+            buffer.append(digits, res.ptr);
+        };
+
+        Process p;
+        bool first = true;
+        while (source.next(p)) {
+            buffer += first ? "\n    {\"p_id\": " : ",\n    {\"p_id\": ";
+            append(p.p_id);
+            buffer += ", \"arrival_time\": ";
+            append(p.arrival_time);
+            buffer += ", \"burst_time\": ";
+            append(p.burst_time);
+            buffer += ", \"priority\": ";
+            append(p.priority);
+            buffer += "}";
+            first = false;
+
+            if (buffer.size() >= (1 << 16)) {
+                out.write(buffer.data(), buffer.size());
+                buffer.clear();
+            }
+        }
+        buffer += first ? "]\n}\n" : "\n  ]\n}\n";
+        out.write(buffer.data(), buffer.size());
+    }
+
+    static void writeJson(ostream& out, const vector<Process>& processes, const nlohmann::json& header) {
+        struct {
+            const vector<Process>& items;
+            size_t index;
+            bool next(Process& p) {
+                if (index >= items.size()) {
+                    return false;
+                }
+                p = items[index++];
+                return true;
+            }
+        } source{processes, 0};
+        writeJson(out, source, header);
+    }
+
+    static void writeJson(ostream& out, vector<Process>& processes, const nlohmann::json& header) {
+        writeJson(out, static_cast<const vector<Process>&>(processes), header);
+    }
+};
+
+#endif